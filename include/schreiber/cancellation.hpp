@@ -0,0 +1,60 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_CANCELLATION_HPP
+#define SCHREIBER_CANCELLATION_HPP
+
+#include <atomic>
+#include <chrono>
+
+namespace driver {
+	/// Tells long-running work that it should stop early, either because its deadline has passed or
+	/// because someone asked it to. Checking the token is cheap enough to do between declarations.
+	class cancellation_token {
+	public:
+		using clock = std::chrono::steady_clock;
+
+		/// Creates a token that's only cancelled by ``cancel``.
+		cancellation_token() = default;
+
+		/// Creates a token that's cancelled once ``deadline`` passes.
+		explicit cancellation_token(clock::time_point const deadline) noexcept
+		: deadline_(deadline)
+		{}
+
+		cancellation_token(cancellation_token const&) = delete;
+		auto operator=(cancellation_token const&) -> cancellation_token& = delete;
+		~cancellation_token() = default;
+
+		/// Returns a token that's cancelled ``budget`` from now, or that has no deadline if
+		/// ``budget`` is zero.
+		[[nodiscard]] static auto after(std::chrono::milliseconds const budget) -> cancellation_token
+		{
+			return budget.count() > 0 ? cancellation_token(clock::now() + budget) : cancellation_token();
+		}
+
+		void cancel() noexcept
+		{
+			cancelled_.store(true, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] auto is_cancelled() const noexcept -> bool
+		{
+			if (cancelled_.load(std::memory_order_relaxed)) {
+				return true;
+			}
+
+			if (deadline_ != clock::time_point::max() and clock::now() >= deadline_) {
+				cancelled_.store(true, std::memory_order_relaxed);
+				return true;
+			}
+
+			return false;
+		}
+	private:
+		clock::time_point deadline_ = clock::time_point::max();
+		mutable std::atomic<bool> cancelled_ = false;
+	};
+} // namespace driver
+
+#endif // SCHREIBER_CANCELLATION_HPP
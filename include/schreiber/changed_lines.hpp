@@ -0,0 +1,49 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_CHANGED_LINES_HPP
+#define SCHREIBER_CHANGED_LINES_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace driver {
+	/// An inclusive range of one-based line numbers.
+	struct line_range {
+		unsigned first = 0;
+		unsigned last = 0;
+
+		friend auto operator==(line_range, line_range) -> bool = default;
+	};
+
+	/// The lines that a unified diff adds or changes, keyed by the absolute path of each file.
+	class changed_lines {
+	public:
+		/// Reads a unified diff, such as the output of ``git diff -U0``.
+		///
+		/// Only the new side of the diff is kept. Removed lines are recorded as the lines on either
+		/// side of where they were, so that deleting part of a comment still counts as changing it.
+		/// Deleted files are ignored, since there's nothing left in them to document.
+		///
+		/// \param root The directory that the diff's paths are relative to.
+		[[nodiscard]] static auto parse(std::string_view diff, std::string_view root)
+		  -> std::expected<changed_lines, std::string>;
+
+		/// Returns the changed lines in ``file``, sorted and with overlapping ranges merged.
+		[[nodiscard]] auto find(std::string_view file) const -> std::span<line_range const>;
+
+		/// Returns whether any line in ``lines`` was changed in ``file``.
+		[[nodiscard]] auto overlaps(std::string_view file, line_range lines) const -> bool;
+
+		/// Returns the absolute path of every file that was changed.
+		[[nodiscard]] auto files() const -> std::vector<std::string_view>;
+	private:
+		absl::flat_hash_map<std::string, std::vector<line_range>> ranges_;
+	};
+} // namespace driver
+
+#endif // SCHREIBER_CHANGED_LINES_HPP
@@ -0,0 +1,54 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_CROSS_REFERENCES_HPP
+#define SCHREIBER_CROSS_REFERENCES_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <cstddef>
+#include <schreiber/detached_info.hpp>
+#include <string_view>
+#include <vector>
+
+namespace info {
+	/// Returns the names in ``text`` that look like references to other entities, in the order they
+	/// appear. These are qualified names, such as ``std::vector``, and names that are followed by
+	/// ``()``, such as ``size()``. The ``()`` isn't part of the name. Other words are too likely to
+	/// be prose that happens to share a name with an entity.
+	[[nodiscard]] auto find_mentions(std::string_view text) -> std::vector<std::string_view>;
+
+	/// Maps the qualified name of every entity in a project to its USR, so that mentions can be
+	/// resolved with a hash lookup each rather than by asking Clang.
+	///
+	/// The table refers to the entities' strings rather than copying them, so they need to outlive
+	/// it. Once it's built, it can be read from any number of threads.
+	class symbol_table {
+	public:
+		/// Adds ``entity``. Overloads share a qualified name, and the first one added is the one that
+		/// the name resolves to.
+		void add(detached_entity const& entity);
+
+		/// Returns the USR of the entity named ``qualified_name``, or an empty string if there
+		/// isn't one.
+		[[nodiscard]] auto find(std::string_view qualified_name) const -> std::string_view;
+
+		/// Resolves ``name`` as it would be written in ``scope``: each enclosing namespace is tried
+		/// in turn, from the innermost out, unless ``name`` starts with ``::``.
+		///
+		/// \returns The entity's USR, or an empty string if ``name`` doesn't name an entity.
+		[[nodiscard]] auto resolve(std::string_view name, std::string_view scope) const
+		  -> std::string_view;
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+	private:
+		absl::flat_hash_map<std::string_view, std::string_view> usrs_;
+	};
+
+	/// Resolves the names mentioned in ``entity``'s descriptions relative to the namespace that
+	/// ``entity`` is declared in. Names that don't resolve, and mentions of ``entity`` itself, are
+	/// left out, and each name is only reported once.
+	[[nodiscard]] auto resolve_references(detached_entity const& entity, symbol_table const& symbols)
+	  -> std::vector<detached_reference>;
+} // namespace info
+
+#endif // SCHREIBER_CROSS_REFERENCES_HPP
@@ -0,0 +1,181 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_DETACHED_INFO_HPP
+#define SCHREIBER_DETACHED_INFO_HPP
+
+#include <clang/Basic/SourceLocation.h>
+#include <clang/Basic/SourceManager.h>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <schreiber/info.hpp>
+#include <schreiber/string_interner.hpp>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace info {
+	/// A source location that remains meaningful once its ``clang::SourceManager`` has been
+	/// destroyed.
+	struct detached_location {
+		std::string_view file;
+		unsigned line = 0;
+		unsigned column = 0;
+
+		friend auto operator==(detached_location const&, detached_location const&) -> bool = default;
+	};
+
+	/// A unit of documentation that doesn't refer to a declaration (e.g. a precondition).
+	struct detached_text {
+		std::string_view description;
+		detached_location location;
+
+		friend auto operator==(detached_text const&, detached_text const&) -> bool = default;
+	};
+
+	/// A documented function parameter or template parameter.
+	struct detached_parameter {
+		std::string_view name;
+		std::string_view type;
+		std::string_view description;
+		detached_location location;
+
+		friend auto operator==(detached_parameter const&, detached_parameter const&) -> bool = default;
+	};
+
+	/// A documented exception, from a ``\throws`` directive.
+	struct detached_exception {
+		/// The exception's type, as it's spelt in the documentation.
+		std::string_view type;
+
+		/// The USR of the type's declaration, or an empty string if it doesn't have one (e.g. ``int``).
+		std::string_view type_usr;
+		std::string_view description;
+		detached_location location;
+
+		friend auto operator==(detached_exception const&, detached_exception const&) -> bool = default;
+	};
+
+	/// A mention of another entity in an entity's documentation, such as ``std::vector``.
+	struct detached_reference {
+		/// The name as it's spelt in the documentation.
+		std::string_view name;
+
+		/// The USR of the entity that ``name`` resolved to.
+		std::string_view usr;
+
+		friend auto operator==(detached_reference const&, detached_reference const&) -> bool = default;
+	};
+
+	/// An ``entity_info`` with everything that depends on the AST resolved ahead of time. Detached
+	/// entities don't refer to any ``clang::Decl`` or ``clang::SourceLocation``, so they remain valid
+	/// after the ``clang::ASTUnit`` that they were extracted from has been destroyed.
+	struct detached_entity {
+		enum class entity_kind : std::uint8_t {
+			function,
+			function_template,
+			record,
+			class_template,
+		};
+
+		entity_kind kind = entity_kind::function;
+		std::string_view usr;
+		std::string_view name;
+		std::string_view qualified_name;
+
+		/// A function's type, or whether a record is a ``class``, ``struct``, or ``union``.
+		std::string_view type;
+		detached_location location;
+		detached_text documentation;
+		std::vector<interned_string> headers;
+		std::vector<interned_string> modules;
+
+		/// A template's parameters, in the order that they're declared. Each ``type`` is what
+		/// introduces its parameter, such as ``typename`` or ``std::size_t``.
+		std::vector<detached_parameter> template_parameters;
+		std::vector<detached_parameter> parameters;
+		std::optional<detached_text> returns;
+		std::vector<detached_text> preconditions;
+		std::vector<detached_text> postconditions;
+		std::vector<detached_exception> throws;
+		std::vector<detached_text> exits_via;
+
+		/// The entities mentioned in the descriptions above, in the order that they're first
+		/// mentioned. They're only known once the whole project has been extracted, so they're filled
+		/// in by ``resolve_references``.
+		std::vector<detached_reference> references;
+
+		/// The USR of the member function whose documentation this one inherits, or an empty string
+		/// if it has documentation of its own. The inherited documentation isn't copied: it's looked
+		/// up with ``entity_index::find_documentation`` when it's needed.
+		std::string_view inherits_from;
+
+		/// The ``entity_info::content_hash`` of the entity that this was detached from.
+		std::uint64_t content_hash = 0;
+	};
+
+	/// Owns the detached entities extracted from a single translation unit. The strings that they
+	/// refer to are stored in a ``string_interner``, which can be shared by many translation units.
+	class detached_translation_unit {
+	public:
+		explicit detached_translation_unit(
+		  std::string_view main_file,
+		  string_interner& interner = string_interner::global());
+
+		/// Resolves everything that ``entity`` refers to in the AST and stores the result.
+		///
+		/// \param entity The documentation to detach from the AST.
+		/// \param source_manager The source manager that owns ``entity``'s source locations.
+		/// \returns A reference to the detached entity, which is invalidated by the next call to
+		///          ``detach``.
+		auto detach(entity_info const& entity, clang::SourceManager const& source_manager)
+		  -> detached_entity const&;
+
+		/// Stores an entity that has already been detached (e.g. one that was read back from a
+		/// serialised run). Its strings must have been interned using ``intern``.
+		auto insert(detached_entity entity) -> detached_entity const&;
+
+		/// Returns the path of the translation unit's main file.
+		[[nodiscard]] auto main_file() const noexcept -> std::string_view;
+
+		/// Returns the entities that have been detached so far, in the order they were detached.
+		[[nodiscard]] auto entities() const noexcept -> std::span<detached_entity const>;
+		[[nodiscard]] auto entities() noexcept -> std::span<detached_entity>;
+
+		/// Removes the entities for which ``pred`` returns true, such as those declared in a file
+		/// that's changed since they were detached.
+		///
+		/// \returns The number of entities that were removed.
+		template<class Predicate>
+		auto erase_if(Predicate pred) -> std::size_t
+		{
+			return std::erase_if(entities_, std::move(pred));
+		}
+
+		/// Returns the interner that stores the translation unit's strings.
+		[[nodiscard]] auto interner() const noexcept -> string_interner&;
+
+		/// Returns a view of a copy of ``s`` that lives as long as the translation unit's interner.
+		[[nodiscard]] auto intern(std::string_view s) -> std::string_view;
+	private:
+		string_interner* interner_;
+		std::string_view main_file_;
+		std::vector<detached_entity> entities_;
+
+		[[nodiscard]] auto
+		resolve_location(clang::SourceLocation location, clang::SourceManager const& source_manager)
+		  -> detached_location;
+		[[nodiscard]] auto resolve_text(basic_info const& info, clang::SourceManager const& source_manager)
+		  -> detached_text;
+		[[nodiscard]] auto
+		resolve_parameter(decl_info const& info, clang::SourceManager const& source_manager)
+		  -> detached_parameter;
+		[[nodiscard]] auto resolve_exception(
+		  function_info::throws_info const& info,
+		  clang::SourceManager const& source_manager) -> detached_exception;
+	};
+} // namespace info
+
+#endif // SCHREIBER_DETACHED_INFO_HPP
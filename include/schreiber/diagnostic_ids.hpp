@@ -29,8 +29,13 @@ namespace diag {
 
 	// clang-format on
 
-	/// Adds all the Schreiber diagnostics to the diagnostics engine.
-	void add_diagnostics(clang::DiagnosticsEngine& engine);
+	/// Adds all the Schreiber diagnostics to the diagnostics engine. Adding them again has no
+	/// effect.
+	///
+	/// \returns ``false`` if ``engine`` gave them IDs other than the ones in ``diag::id``, which
+	/// happens when something else added a custom diagnostic first, such as another plugin. Reporting
+	/// a ``diag::id`` through ``engine`` would then print the wrong message.
+	[[nodiscard]] auto add_diagnostics(clang::DiagnosticsEngine& engine) -> bool;
 } // namespace diag
 
 #endif // SCHREIBER_DIAGNOSTIC_IDS_HPP
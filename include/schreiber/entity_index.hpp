@@ -0,0 +1,104 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_ENTITY_INDEX_HPP
+#define SCHREIBER_ENTITY_INDEX_HPP
+
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/import_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace info {
+	/// Indexes the entities of a whole project by qualified name, USR, namespace, source file,
+	/// header, and module.
+	///
+	/// Entities are added as translation units finish, and can be looked up from any number of
+	/// threads while that happens. Lookups only take a shared lock. The entities that they return
+	/// are never moved or modified, so they stay valid for as long as the index does.
+	class entity_index {
+	public:
+		/// Identifies an entity within an index. Ids are handed out in insertion order.
+		using entity_id = std::uint32_t;
+
+		/// \param interner Stores the strings of every entity in the index.
+		explicit entity_index(string_interner& interner = string_interner::global());
+
+		entity_index(entity_index const&) = delete;
+		auto operator=(entity_index const&) -> entity_index& = delete;
+		~entity_index() = default;
+
+		/// Adds a copy of ``entity`` to the index, and returns its id. If an entity with the same
+		/// USR is already indexed, nothing is added and that entity's id is returned, since headers
+		/// are seen once per translation unit that includes them.
+		auto insert(detached_entity const& entity) -> entity_id;
+
+		/// Adds each entity in ``unit`` to the index.
+		void insert(detached_translation_unit const& unit);
+
+		/// Returns the number of entities in the index.
+		[[nodiscard]] auto size() const -> std::size_t;
+
+		/// Returns the entity with id ``id``.
+		///
+		/// \pre ``id < size()``
+		[[nodiscard]] auto get(entity_id id) const -> detached_entity const&;
+
+		/// Returns the entity with USR ``usr``, or ``nullptr`` if there isn't one.
+		[[nodiscard]] auto find_usr(std::string_view usr) const -> detached_entity const*;
+
+		/// Returns the entity whose documentation ``entity`` uses: ``entity`` itself, or the base
+		/// member that it inherits its documentation from. Inherited documentation is only looked
+		/// up here, so it's never copied into the entities that inherit it.
+		///
+		/// \returns The documented entity, or ``nullptr`` if the base member isn't in the index.
+		[[nodiscard]] auto find_documentation(detached_entity const& entity) const
+		  -> detached_entity const*;
+
+		/// Returns the entities named ``qualified_name``, such as each overload of a function.
+		[[nodiscard]] auto find_qualified_name(std::string_view qualified_name) const
+		  -> std::vector<detached_entity const*>;
+
+		/// Returns the entities declared in ``name_space`` or in a namespace nested inside it,
+		/// ordered by qualified name. An empty ``name_space`` returns everything.
+		[[nodiscard]] auto find_in_namespace(std::string_view name_space) const
+		  -> std::vector<detached_entity const*>;
+
+		/// Returns the entities declared in ``file``, in insertion order.
+		[[nodiscard]] auto find_in_file(std::string_view file) const
+		  -> std::vector<detached_entity const*>;
+
+		/// Returns the entities that can be imported from ``header``, in insertion order.
+		[[nodiscard]] auto find_in_header(std::string_view header) const
+		  -> std::vector<detached_entity const*>;
+
+		/// Returns the entities that can be imported from ``module``, in insertion order.
+		[[nodiscard]] auto find_in_module(std::string_view module) const
+		  -> std::vector<detached_entity const*>;
+	private:
+		string_interner* interner_;
+		mutable std::shared_mutex mutex_;
+
+		// A deque never moves its elements, which is what keeps returned entities valid.
+		std::deque<detached_entity> entities_;
+		absl::flat_hash_map<std::string_view, entity_id> by_usr_;
+		absl::flat_hash_map<std::string_view, std::vector<entity_id>> by_qualified_name_;
+		absl::btree_multimap<std::string_view, entity_id> by_name_;
+		absl::flat_hash_map<std::string_view, std::vector<entity_id>> by_file_;
+		import_index imports_;
+
+		[[nodiscard]] auto intern(detached_entity entity) -> detached_entity;
+		[[nodiscard]] auto
+		lookup(std::span<entity_id const> ids) const -> std::vector<detached_entity const*>;
+	};
+} // namespace info
+
+#endif // SCHREIBER_ENTITY_INDEX_HPP
@@ -0,0 +1,159 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_EXTRACT_HPP
+#define SCHREIBER_EXTRACT_HPP
+
+#include <chrono>
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclGroup.h>
+#include <clang/Basic/SourceLocation.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <cstdint>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <memory>
+#include <schreiber/cancellation.hpp>
+#include <schreiber/changed_lines.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <schreiber/prebuilt.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+#include <vector>
+
+namespace driver {
+	/// Returns every declaration in ``context`` whose documentation should be parsed.
+	[[nodiscard]] auto documentable_decls(clang::ASTContext& context)
+	  -> std::vector<clang::NamedDecl const*>;
+
+	/// Returns the absolute path of the file that ``file`` refers to, or an empty string if it isn't
+	/// a file on disk.
+	[[nodiscard]] auto absolute_path(clang::SourceManager const& source_manager, clang::FileID file)
+	  -> std::string;
+
+	/// Controls which declarations are extracted, and when extraction stops.
+	struct extract_options {
+		/// If present, it's checked between declarations, and extraction stops early once it's been
+		/// cancelled. Anything extracted before then is kept.
+		cancellation_token const* cancel = nullptr;
+
+		/// If present, only declarations whose declaration or comment overlaps a changed line are
+		/// parsed. Undocumented declarations are only reported when they overlap a changed line.
+		changed_lines const* changed = nullptr;
+
+		/// If present, declarations loaded from a precompiled header or module interface are skipped
+		/// once a translation unit has finished extracting them.
+		prebuilt_files* prebuilt = nullptr;
+
+		/// If present, each entity's documentation is counted before it's detached.
+		memory_stats* memory = nullptr;
+
+		/// The cache that the translation unit's files are read through, if any. Its buffers are
+		/// shared with the rest of the run, so they're left out of the translation unit's memory
+		/// stats. ``extract`` sets it to its own ``cache``.
+		file_cache const* cache = nullptr;
+
+		/// If present, files are read from here rather than from disk, such as to overlay buffers
+		/// that haven't been saved.
+		llvm::vfs::FileSystem* file_system = nullptr;
+
+		/// If present, the translation unit's strings are interned here rather than in
+		/// ``string_interner::global()``, so that they can be freed once the results are done with.
+		info::string_interner* interner = nullptr;
+	};
+
+	/// Parses the documentation for every declaration in ``context`` that should be documented, and
+	/// detaches the results into ``result``.
+	void extract(
+	  clang::ASTContext& context,
+	  info::detached_translation_unit& result,
+	  extract_options const& options = {});
+
+	/// The outcome of extracting a single translation unit.
+	struct translation_unit_result {
+		enum class status_t : std::uint8_t {
+			ok,
+			failed,
+			crashed,
+			timed_out,
+		};
+
+		std::string file;
+		status_t status = status_t::ok;
+		std::string diagnostics;
+		info::detached_translation_unit unit;
+
+		/// How long the translation unit took to extract, including building its AST.
+		std::chrono::milliseconds elapsed = {};
+
+		/// How many bytes the translation unit's AST allocated.
+		std::size_t ast_bytes = 0;
+
+		/// Where the translation unit's memory went.
+		memory_stats memory;
+	};
+
+	/// Extracts a translation unit's documentation once its AST has been built.
+	///
+	/// If ``options.cancel`` is present, it's also checked after each top-level declaration is
+	/// parsed, so that a cancelled translation unit stops building its AST. The declarations that
+	/// were parsed before then are still extracted.
+	class extract_consumer : public clang::ASTConsumer {
+	public:
+		explicit extract_consumer(
+		  translation_unit_result& result,
+		  extract_options options = {}) noexcept;
+
+		void Initialize(clang::ASTContext& context) override;
+		auto HandleTopLevelDecl(clang::DeclGroupRef decls) -> bool override;
+		void HandleTranslationUnit(clang::ASTContext& context) override;
+	private:
+		translation_unit_result* result_;
+		extract_options options_;
+		clang::ASTContext* context_ = nullptr;
+
+		/// Extracts every declaration that's been parsed into ``context``.
+		void extract_parsed(clang::ASTContext& context, extract_options options);
+	};
+
+	/// A frontend action that extracts a translation unit's documentation. The AST is destroyed when
+	/// the action finishes, leaving only the detached documentation.
+	class extract_action : public clang::ASTFrontendAction {
+	public:
+		explicit extract_action(translation_unit_result& result, extract_options options = {}) noexcept;
+	protected:
+		auto CreateASTConsumer(clang::CompilerInstance& compiler, llvm::StringRef file)
+		  -> std::unique_ptr<clang::ASTConsumer> override;
+	private:
+		translation_unit_result* result_;
+		extract_options options_;
+	};
+
+	/// Builds the AST for ``command``, extracts its documentation, and destroys the AST. Diagnostics
+	/// are buffered in the result rather than being printed, so that translation units that are
+	/// extracted concurrently don't interleave their diagnostics.
+	///
+	/// A translation unit that's cancelled through ``options.cancel`` is reported as ``timed_out``,
+	/// and keeps whatever was extracted before it was cancelled. If ``options.prebuilt`` is present,
+	/// stale precompiled headers in ``command`` are replaced with their sources, rather than failing
+	/// the translation unit (see ``prebuilt_files::adjust``).
+	///
+	/// \param cache Caches the files that are read, and can be shared with concurrent calls.
+	[[nodiscard]] auto extract(
+	  clang::tooling::CompileCommand const& command,
+	  file_cache& cache,
+	  extract_options const& options) -> translation_unit_result;
+
+	/// Builds the AST for ``command`` without sharing a file cache with other translation units.
+	[[nodiscard]] auto extract(clang::tooling::CompileCommand const& command) -> translation_unit_result;
+} // namespace driver
+
+#endif // SCHREIBER_EXTRACT_HPP
@@ -0,0 +1,98 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_FILE_CACHE_HPP
+#define SCHREIBER_FILE_CACHE_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <array>
+#include <cstddef>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/StringSaver.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+
+namespace driver {
+	/// Remembers the status and contents of every file that a run looks at, so that headers
+	/// included by many translation units are only stat'ed and read once. Failed lookups are
+	/// remembered too, since most of the stats made while searching include paths fail.
+	///
+	/// Files are keyed by absolute path, and the cache assumes that files don't change during a
+	/// run. It's thread-safe in the same way as ``info::string_interner``.
+	class file_cache {
+	public:
+		file_cache() = default;
+		file_cache(file_cache const&) = delete;
+		auto operator=(file_cache const&) -> file_cache& = delete;
+		~file_cache() = default;
+
+		/// Returns the status of ``path``, asking ``file_system`` the first time it's seen.
+		///
+		/// \param path An absolute path.
+		[[nodiscard]] auto status(std::string_view path, llvm::vfs::FileSystem& file_system)
+		  -> llvm::ErrorOr<llvm::vfs::Status>;
+
+		/// Returns the status and contents of ``path``, reading it from ``file_system`` the first
+		/// time it's opened. The buffer lives as long as the cache.
+		///
+		/// \param path An absolute path.
+		[[nodiscard]] auto contents(std::string_view path, llvm::vfs::FileSystem& file_system)
+		  -> llvm::ErrorOr<std::pair<llvm::vfs::Status, llvm::MemoryBuffer const*>>;
+
+		/// Returns the number of paths that have been looked up.
+		[[nodiscard]] auto size() const -> std::size_t;
+
+		/// Returns the number of bytes of file contents held by the cache.
+		[[nodiscard]] auto content_bytes() const -> std::size_t;
+
+		/// Returns whether ``contents`` is a view of a file that the cache holds, rather than memory
+		/// of its own.
+		[[nodiscard]] auto holds(std::string_view contents) const -> bool;
+	private:
+		static constexpr auto shard_count = std::size_t{64};
+
+		struct entry {
+			std::optional<llvm::ErrorOr<llvm::vfs::Status>> status;
+			std::unique_ptr<llvm::MemoryBuffer> contents;
+		};
+
+		struct alignas(64) shard {
+			mutable std::shared_mutex mutex;
+			absl::flat_hash_map<std::string_view, entry> entries;
+			llvm::BumpPtrAllocator allocator;
+			llvm::StringSaver saver{allocator};
+
+			/// Returns the entry for ``path``, adding it if it's missing. The caller must hold
+			/// ``mutex`` exclusively.
+			[[nodiscard]] auto entry_for(std::string_view path) -> entry&;
+		};
+
+		std::array<shard, shard_count> shards_;
+
+		/// The start of each buffer in the cache. Buffers are looked up by address rather than by
+		/// path, so they have to be tracked separately from the shards.
+		mutable std::shared_mutex buffers_mutex_;
+		absl::flat_hash_set<char const*> buffers_;
+
+		[[nodiscard]] auto shard_for(std::string_view path) -> shard&;
+	};
+
+	/// Returns a file system that answers ``status`` and ``openFileForRead`` from ``cache``, and
+	/// forwards everything else to ``underlying``. It keeps its own working directory and is cheap
+	/// to create, so each translation unit can have one while sharing ``cache`` with the rest of
+	/// the run.
+	[[nodiscard]] auto make_caching_file_system(
+	  file_cache& cache,
+	  llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> underlying)
+	  -> llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>;
+} // namespace driver
+
+#endif // SCHREIBER_FILE_CACHE_HPP
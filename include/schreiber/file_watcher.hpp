@@ -0,0 +1,59 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_FILE_WATCHER_HPP
+#define SCHREIBER_FILE_WATCHER_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace driver {
+	/// Reports files that are written, moved, or deleted in a set of directories, using inotify.
+	/// Directories aren't watched recursively: each directory that holds a file of interest needs
+	/// to be watched, which keeps build directories and other noise out of the watch.
+	class file_watcher {
+	public:
+		[[nodiscard]] static auto create() -> std::expected<file_watcher, std::string>;
+
+		file_watcher(file_watcher const&) = delete;
+		file_watcher(file_watcher&& other) noexcept;
+		auto operator=(file_watcher const&) -> file_watcher& = delete;
+		auto operator=(file_watcher&& other) noexcept -> file_watcher&;
+		~file_watcher();
+
+		/// Starts watching the files directly inside ``directory``. Watching a directory twice has
+		/// no effect.
+		///
+		/// \param directory An absolute path.
+		[[nodiscard]] auto watch(std::string_view directory) -> std::expected<void, std::string>;
+
+		/// Blocks until a watched file changes, then keeps collecting changes until none have been
+		/// seen for ``quiet``. Editors often write a file several times when saving it, and saving
+		/// many files at once shouldn't cause many rebuilds, so a burst is reported as one batch.
+		///
+		/// \returns The absolute path of each file that changed, sorted and without duplicates.
+		[[nodiscard]] auto wait(std::chrono::milliseconds quiet)
+		  -> std::expected<std::vector<std::string>, std::string>;
+
+		/// Returns the number of directories being watched.
+		[[nodiscard]] auto directories() const noexcept -> std::size_t;
+	private:
+		int fd_;
+
+		/// Maps each watch descriptor to the directory that it watches.
+		absl::flat_hash_map<int, std::string> directories_;
+
+		explicit file_watcher(int fd) noexcept;
+
+		/// Reads the events that are ready, and adds the files that they name to ``changed``.
+		[[nodiscard]] auto read_events(std::vector<std::string>& changed)
+		  -> std::expected<void, std::string>;
+	};
+} // namespace driver
+
+#endif // SCHREIBER_FILE_WATCHER_HPP
@@ -0,0 +1,54 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_IMPORT_INDEX_HPP
+#define SCHREIBER_IMPORT_INDEX_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <cstdint>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/string_interner.hpp>
+#include <span>
+#include <vector>
+
+namespace info {
+	/// Maps each header and module to the entities that can be imported from it, which is the
+	/// reverse of ``detached_entity::headers`` and ``detached_entity::modules``.
+	///
+	/// Names are looked up by their ``interned_string``, so a lookup hashes a pointer rather than a
+	/// string. Use the same interner that the entities' headers and modules were interned with.
+	class import_index {
+	public:
+		using entity_id = std::uint32_t;
+
+		/// Records that the entity identified by ``id`` can be imported from each of ``entity``'s
+		/// headers and modules. Ids should be added in increasing order, so that each list stays
+		/// sorted.
+		void add(entity_id id, detached_entity const& entity);
+
+		/// Records that the entity identified by ``id`` can be imported from ``header``.
+		void add_header(interned_string header, entity_id id);
+
+		/// Records that the entity identified by ``id`` can be imported from ``module``.
+		void add_module(interned_string module, entity_id id);
+
+		/// Returns the entities that can be imported from ``header``.
+		[[nodiscard]] auto header(interned_string header) const -> std::span<entity_id const>;
+
+		/// Returns the entities that can be imported from ``module``.
+		[[nodiscard]] auto module(interned_string module) const -> std::span<entity_id const>;
+
+		/// Returns every header that exports an entity, ordered by name.
+		[[nodiscard]] auto headers() const -> std::vector<interned_string>;
+
+		/// Returns every module that exports an entity, ordered by name.
+		[[nodiscard]] auto modules() const -> std::vector<interned_string>;
+
+		friend auto operator==(import_index const&, import_index const&) -> bool = default;
+	private:
+		absl::flat_hash_map<interned_string, std::vector<entity_id>> headers_;
+		absl::flat_hash_map<interned_string, std::vector<entity_id>> modules_;
+	};
+} // namespace info
+
+#endif // SCHREIBER_IMPORT_INDEX_HPP
@@ -0,0 +1,80 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_INCLUDE_GRAPH_HPP
+#define SCHREIBER_INCLUDE_GRAPH_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <cstdint>
+#include <schreiber/file_cache.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace driver {
+	/// Runs only the preprocessor over ``command``, and returns the absolute path of every file that
+	/// it enters, including the main file. Diagnostics are discarded: a header that can't be found
+	/// ends the scan early, and the result covers what the preprocessor reached before then.
+	[[nodiscard]] auto scan_includes(clang::tooling::CompileCommand const& command, file_cache& cache)
+	  -> std::vector<std::string>;
+
+	/// Records which files each translation unit reaches, directly or through other headers.
+	class include_graph {
+	public:
+		/// Scans every translation unit in ``commands`` using ``jobs`` threads.
+		[[nodiscard]] static auto
+		scan(std::span<clang::tooling::CompileCommand const> commands, unsigned jobs) -> include_graph;
+
+		/// Adds a translation unit that reaches ``files``, and returns its index.
+		auto add(std::span<std::string const> files) -> std::size_t;
+
+		/// Records that ``translation_unit`` now reaches ``files`` instead of what it reached before,
+		/// such as after its main file has been edited.
+		void replace(std::size_t translation_unit, std::span<std::string const> files);
+
+		/// Returns the indices of the translation units that reach ``file``, in ascending order.
+		[[nodiscard]] auto including(std::string_view file) const -> std::span<std::size_t const>;
+
+		/// Returns the indices of the translation units that reach any of ``files``, in ascending
+		/// order.
+		[[nodiscard]] auto including_any(std::span<std::string_view const> files) const
+		  -> std::vector<std::size_t>;
+
+		/// Chooses a small set of translation units that together reach every file in ``files``,
+		/// preferring cheap ones. Files that no translation unit reaches are ignored.
+		///
+		/// This is a greedy weighted set cover: it repeatedly picks the translation unit that reaches
+		/// the most files that aren't covered yet per unit of cost, which is within a logarithmic
+		/// factor of the cheapest cover.
+		///
+		/// \param costs The estimated cost of each translation unit, such as from ``estimate_costs``.
+		/// \returns The indices of the chosen translation units, in ascending order.
+		[[nodiscard]] auto
+		cover(std::span<std::string_view const> files, std::span<double const> costs) const
+		  -> std::vector<std::size_t>;
+
+		/// Returns the absolute path of every file under ``directory`` that a translation unit
+		/// reaches, sorted.
+		[[nodiscard]] auto files_under(std::string_view directory) const
+		  -> std::vector<std::string_view>;
+
+		/// Returns the absolute path of every file that ``translation_unit`` reaches.
+		[[nodiscard]] auto files(std::size_t translation_unit) const -> std::vector<std::string_view>;
+
+		[[nodiscard]] auto translation_units() const noexcept -> std::size_t;
+	private:
+		/// Each file is stored once, and translation units refer to it by its index in ``paths_``.
+		std::vector<std::string> paths_;
+		absl::flat_hash_map<std::string, std::uint32_t> ids_;
+		std::vector<std::vector<std::uint32_t>> files_;
+		std::vector<std::vector<std::size_t>> includers_;
+
+		/// Returns the sorted ids of ``files``, adding any that haven't been seen before.
+		[[nodiscard]] auto ids_for(std::span<std::string const> files) -> std::vector<std::uint32_t>;
+	};
+} // namespace driver
+
+#endif // SCHREIBER_INCLUDE_GRAPH_HPP
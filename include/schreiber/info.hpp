@@ -5,12 +5,16 @@
 #define SCHREIBER_INFO_HPP
 
 #include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
 #include <clang/AST/DeclTemplate.h>
 #include <clang/Basic/SourceLocation.h>
+#include <cstdint>
 #include <memory>
+#include <schreiber/string_interner.hpp>
 #include <span>
 #include <string>
 #include <string_view>
+#include <variant>
 #include <vector>
 
 namespace parser {
@@ -29,6 +33,9 @@ namespace info {
 		[[nodiscard]] auto description() const noexcept -> std::string_view;
 		[[nodiscard]] auto location() const noexcept -> clang::SourceLocation;
 
+		/// Returns the description if it was interned, and an empty string otherwise.
+		[[nodiscard]] auto interned_description() const noexcept -> interned_string;
+
 		friend auto operator==(basic_info const&, basic_info const&) -> bool = default;
 	protected:
 		enum class kind {
@@ -44,35 +51,59 @@ namespace info {
 			template_parameter_info,
 			function_info,
 			function_template_info,
+			record_info,
+			class_template_info,
 		};
 
 		basic_info(kind k, std::string description, clang::SourceLocation location);
+		basic_info(kind k, interned_string description, clang::SourceLocation location);
 
 		[[nodiscard]] static auto get_kind(basic_info const& info) noexcept -> kind;
 	private:
 		kind kind_;
-		std::string description_;
+		std::variant<std::string, interned_string> description_;
 		clang::SourceLocation location_;
 	};
 
 	/// Base class for describing a named declaration, such as an entity or a (template) parameter.
 	class decl_info : public basic_info {
 	public:
-		/// Identifies a header that a declaration can be found in.
+		/// Identifies a header that a declaration can be found in. Header names are interned, since
+		/// the same few headers are usually repeated across an entire project.
 		struct header_info final : basic_info {
-			header_info(std::string description, clang::SourceLocation location);
+			header_info(interned_string name, clang::SourceLocation location);
+
+			/// Interns ``name`` using ``string_interner::global()``.
+			header_info(std::string_view name, clang::SourceLocation location);
+
+			/// Returns the interned header name.
+			[[nodiscard]] auto name() const noexcept -> interned_string;
+
 			static auto classof(basic_info const* decl) -> bool;
 		};
 
-		/// Identifies a module that a declaration can be found in.
+		/// Identifies a module that a declaration can be found in. Module names are interned, since
+		/// the same few modules are usually repeated across an entire project.
 		struct module_info final : basic_info {
-			module_info(std::string description, clang::SourceLocation location);
+			module_info(interned_string name, clang::SourceLocation location);
+
+			/// Interns ``name`` using ``string_interner::global()``.
+			module_info(std::string_view name, clang::SourceLocation location);
+
+			/// Returns the interned module name.
+			[[nodiscard]] auto name() const noexcept -> interned_string;
+
 			static auto classof(basic_info const* decl) -> bool;
 		};
 
 		[[nodiscard]] auto decl() const noexcept -> clang::Decl const*;
 	protected:
 		decl_info(kind k, clang::Decl const* decl, std::string description, clang::SourceLocation location);
+		decl_info(
+		  kind k,
+		  clang::Decl const* decl,
+		  interned_string description,
+		  clang::SourceLocation location);
 	private:
 		clang::Decl const* decl_;
 	};
@@ -136,25 +167,59 @@ namespace info {
 		/// Returns which modules the declaration can be imported from.
 		[[nodiscard]] auto modules() const noexcept -> std::span<module_info const>;
 
+		/// Returns a hash of the entity's description and of everything that has been documented
+		/// about it, in the order that it was documented. Source locations aren't part of the hash, so
+		/// it only changes when the documentation's text does.
+		[[nodiscard]] auto content_hash() const noexcept -> std::uint64_t;
+
 		/// Adds a unit of information to the entity's graph.
 		virtual void store(parser::parser const& p, parser::directive directive, basic_info* info) = 0;
+
+		/// Determines whether a ``basic_info const*`` points to an ``entity_info`` object.
+		static auto classof(basic_info const* info) -> bool;
 	protected:
 		using decl_info::decl_info;
+
+		/// Folds ``info`` into the content hash. This is called as each directive is stored, so the
+		/// documentation never needs to be walked again to hash it.
+		///
+		/// \param name The name of the declaration that ``info`` documents, if any.
+		void update_content_hash(basic_info const& info, std::string_view name = {}) noexcept;
 	private:
 		std::vector<header_info> headers_;
 		std::vector<module_info> modules_;
+		std::uint64_t content_hash_ = 0;
 	};
 
 	class function_info : public entity_info {
 	public:
 		function_info(clang::FunctionDecl const* decl, std::string description, clang::SourceLocation location);
 
+		/// Shares an interned description, for declarations whose comments are identical.
+		function_info(
+		  clang::FunctionDecl const* decl,
+		  interned_string description,
+		  clang::SourceLocation location);
+
+		/// Documents an overriding member function that doesn't have a comment of its own. Nothing
+		/// is copied from ``base``: its documentation is looked up when it's needed, so that a member
+		/// overridden at every level of a deep hierarchy is only documented once.
+		///
+		/// \param decl The overriding member function.
+		/// \param base The member function whose documentation ``decl`` inherits.
+		function_info(clang::CXXMethodDecl const* decl, clang::CXXMethodDecl const* base);
+
+		/// Returns the member function whose documentation this one inherits, or ``nullptr`` if it
+		/// has documentation of its own.
+		[[nodiscard]] auto inherits_from() const noexcept -> clang::CXXMethodDecl const*;
+
 		/// Returns descriptions of the function's parameters.
 		[[nodiscard]] auto parameters() const noexcept -> std::span<parameter_info const>;
 
 		/// Describes what a function returns.
 		struct return_info final : basic_info {
 			return_info(std::string description, clang::SourceLocation location);
+			return_info(interned_string description, clang::SourceLocation location);
 			static auto classof(basic_info const* info) -> bool;
 		};
 
@@ -164,6 +229,7 @@ namespace info {
 		/// Describes a precondition.
 		struct precondition_info final : basic_info {
 			precondition_info(std::string description, clang::SourceLocation location);
+			precondition_info(interned_string description, clang::SourceLocation location);
 			static auto classof(basic_info const* info) -> bool;
 		};
 
@@ -173,6 +239,7 @@ namespace info {
 		/// Describes a postcondition.
 		struct postcondition_info final : basic_info {
 			postcondition_info(std::string description, clang::SourceLocation location);
+			postcondition_info(interned_string description, clang::SourceLocation location);
 			static auto classof(basic_info const* info) -> bool;
 		};
 
@@ -181,8 +248,29 @@ namespace info {
 
 		/// Describes an exception that a function may throw.
 		struct throws_info final : basic_info {
-			throws_info(std::string description, clang::SourceLocation location);
+			/// \param type The exception's type, as it's spelt in the documentation.
+			/// \param type_decl The declaration that ``type`` names, or ``nullptr`` if it doesn't name
+			///                  one (e.g. ``int``).
+			/// \param description When the exception is thrown.
+			/// \param location Where the directive is.
+			throws_info(
+			  std::string type,
+			  clang::NamedDecl const* type_decl,
+			  std::string description,
+			  clang::SourceLocation location);
+
+			/// Returns the exception's type, as it's spelt in the documentation.
+			[[nodiscard]] auto type() const noexcept -> std::string_view;
+
+			/// Returns the declaration of the exception's type, if it has one.
+			[[nodiscard]] auto type_decl() const noexcept -> clang::NamedDecl const*;
+
 			static auto classof(basic_info const* info) -> bool;
+
+			friend auto operator==(throws_info const&, throws_info const&) -> bool = default;
+		private:
+			std::string type_;
+			clang::NamedDecl const* type_decl_;
 		};
 
 		/// Returns the set of exceptions a function might throw.
@@ -192,6 +280,7 @@ namespace info {
 		/// ``std::abort();``).
 		struct exits_via_info final : basic_info {
 			exits_via_info(std::string description, clang::SourceLocation location);
+			exits_via_info(interned_string description, clang::SourceLocation location);
 			static auto classof(basic_info const* info) -> bool;
 		};
 
@@ -223,6 +312,7 @@ namespace info {
 		/// Documents ways a function might exit, other than returning or throwing.
 		void add_exits_via(parser::parser const& p, parser::directive directive, exits_via_info info);
 	private:
+		clang::CXXMethodDecl const* inherits_from_ = nullptr;
 		std::vector<parameter_info> parameters_;
 		std::optional<return_info> returns_;
 		std::vector<precondition_info> preconditions_;
@@ -262,6 +352,56 @@ namespace info {
 		std::vector<template_parameter_info> template_parameters_;
 		std::optional<noexcept_if_info> noexcept_if_;
 	};
+
+	/// Describes a class, struct, or union. Records only support the directives that every entity
+	/// supports: their members are documented separately.
+	class record_info : public entity_info {
+	public:
+		record_info(
+		  clang::CXXRecordDecl const* decl,
+		  std::string description,
+		  clang::SourceLocation location);
+
+		/// Shares an interned description, for declarations whose comments are identical.
+		record_info(
+		  clang::CXXRecordDecl const* decl,
+		  interned_string description,
+		  clang::SourceLocation location);
+
+		/// Returns the documented record. For a class template, this is the class that it declares.
+		[[nodiscard]] auto record() const noexcept -> clang::CXXRecordDecl const*;
+
+		void store(parser::parser const& p, parser::directive directive, basic_info* info) override;
+
+		/// Determines whether a ``basic_info const*`` points to a ``record_info`` object, including
+		/// a ``class_template_info`` object.
+		static auto classof(basic_info const* info) -> bool;
+	protected:
+		record_info(
+		  clang::ClassTemplateDecl const* decl,
+		  interned_string description,
+		  clang::SourceLocation location);
+	};
+
+	class class_template_info final : public record_info {
+	public:
+		class_template_info(
+		  clang::ClassTemplateDecl const* decl,
+		  interned_string description,
+		  clang::SourceLocation location);
+
+		/// Documents a template parameter.
+		void add_template_parameter(template_parameter_info info);
+
+		/// Returns the class template's template parameters, in the order that they're declared.
+		[[nodiscard]] auto
+		template_parameters() const noexcept -> std::span<template_parameter_info const>;
+
+		/// Determines whether a ``basic_info const*`` points to a ``class_template_info`` object.
+		static auto classof(basic_info const* info) -> bool;
+	private:
+		std::vector<template_parameter_info> template_parameters_;
+	};
 } // namespace info
 
 #endif // SCHREIBER_INFO_HPP
@@ -0,0 +1,63 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_MEMORY_BUDGET_HPP
+#define SCHREIBER_MEMORY_BUDGET_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <sys/types.h>
+
+namespace driver {
+	/// Returns the resident set size of the process ``pid`` in bytes, read from ``/proc/<pid>/statm``,
+	/// or ``std::nullopt`` if it can't be read.
+	[[nodiscard]] auto resident_set_size(pid_t pid) -> std::optional<std::size_t>;
+
+	/// Returns the resident set size of the calling process in bytes.
+	[[nodiscard]] auto resident_set_size() -> std::optional<std::size_t>;
+
+	/// Returns freed memory to the operating system where the allocator supports it, so that the
+	/// resident set size drops once an AST is destroyed.
+	void release_free_memory() noexcept;
+
+	/// Limits how many translation units are in flight so that a run stays under a memory budget.
+	///
+	/// A translation unit is admitted when the memory in use plus the largest AST seen so far fits
+	/// in the budget. One translation unit is always admitted when none are in flight, so a run
+	/// slows down rather than stalling when the budget is too small for the translation units in it.
+	class memory_budget {
+	public:
+		/// \param limit The budget in bytes. Zero means that there's no limit.
+		explicit memory_budget(std::size_t limit) noexcept;
+
+		/// Returns whether another translation unit can start.
+		///
+		/// \param in_use The number of bytes currently resident.
+		/// \param in_flight The number of translation units currently being extracted.
+		[[nodiscard]] auto admits(std::size_t in_use, std::size_t in_flight) const -> bool;
+
+		/// Records how large a finished translation unit's AST was.
+		void record(std::size_t ast_bytes);
+
+		/// Blocks the calling thread until another translation unit can start in this process.
+		void acquire();
+
+		/// Marks a translation unit that was started with ``acquire`` as finished, and wakes any
+		/// threads that are waiting for memory.
+		void release(std::size_t ast_bytes);
+
+		[[nodiscard]] auto limit() const noexcept -> std::size_t;
+	private:
+		std::size_t limit_;
+		mutable std::mutex mutex_;
+		std::condition_variable released_;
+		std::size_t in_flight_ = 0;
+		std::size_t largest_ast_ = 0;
+
+		[[nodiscard]] auto admits_locked(std::size_t in_use, std::size_t in_flight) const -> bool;
+	};
+} // namespace driver
+
+#endif // SCHREIBER_MEMORY_BUDGET_HPP
@@ -0,0 +1,110 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_MEMORY_STATS_HPP
+#define SCHREIBER_MEMORY_STATS_HPP
+
+#include <array>
+#include <clang/AST/ASTContext.h>
+#include <cstddef>
+#include <cstdint>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/info.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string_view>
+
+namespace driver {
+	/// Where the memory used to extract a translation unit went, for sizing the machines that runs
+	/// are on and for checking that memory optimisations pay off.
+	class memory_stats {
+	public:
+		enum class category : std::uint8_t {
+			function_info,
+			record_info,
+			parameter_info,
+			return_info,
+			precondition_info,
+			postcondition_info,
+			throws_info,
+			exits_via_info,
+			header_info,
+			module_info,
+			descriptions,
+			interned_strings,
+			detached_entities,
+			diagnostics,
+			ast,
+			ast_side_tables,
+			source_manager,
+			source_buffers,
+			cached_files,
+		};
+
+		static constexpr auto category_count = std::size_t{19};
+
+		struct usage {
+			/// The number of objects allocated, where that's meaningful.
+			std::size_t count = 0;
+
+			/// The number of bytes allocated over the whole translation unit.
+			std::size_t bytes = 0;
+
+			/// The most bytes that were alive at once. Documentation objects are destroyed once their
+			/// declaration has been detached, so this is usually far smaller than ``bytes`` for them.
+			std::size_t peak = 0;
+
+			friend auto operator==(usage const&, usage const&) -> bool = default;
+		};
+
+		/// Counts ``entity`` and everything that's documented about it. Descriptions that are interned
+		/// are counted by the interner instead.
+		void record(info::entity_info const& entity);
+
+		/// Records the memory that ``unit``'s detached entities occupy. Their strings are interned, so
+		/// only the entities themselves are counted.
+		void record(info::detached_translation_unit const& unit);
+
+		/// Records the memory that ``context``'s AST and source manager occupy. ASTs only grow, so this
+		/// should be called once the whole translation unit has been parsed.
+		///
+		/// \param cache The cache that the translation unit's files were read through, if any. Its
+		///              buffers are shared with the rest of the run, so they aren't counted here.
+		void record(clang::ASTContext const& context, file_cache const* cache = nullptr);
+
+		/// Records the size of the buffer that a translation unit's diagnostics are held in.
+		void record_diagnostics(std::size_t capacity);
+
+		/// Records the strings in ``interner``. Interners are shared by every translation unit in a
+		/// run, so this only makes sense for the run as a whole.
+		void record(info::string_interner const& interner);
+
+		/// Records the file contents held by ``cache``. Like interners, caches are shared by every
+		/// translation unit in a run.
+		void record(file_cache const& cache);
+
+		/// Sets the usage of ``c`` directly, such as when reading the stats from a worker process.
+		void set(category c, usage u) noexcept;
+
+		[[nodiscard]] auto operator[](category c) const noexcept -> usage const&;
+
+		/// Adds ``other``'s counts and bytes to these. The peak is the larger of the two peaks, since
+		/// the translation units in a run aren't all alive at once.
+		auto operator+=(memory_stats const& other) noexcept -> memory_stats&;
+
+		friend auto operator==(memory_stats const&, memory_stats const&) -> bool = default;
+	private:
+		std::array<usage, category_count> usage_ = {};
+
+		void add(category c, std::size_t bytes, std::size_t count = 1) noexcept;
+	};
+
+	/// Returns the name that ``c`` is reported as, such as ``function_info``.
+	[[nodiscard]] auto to_string(memory_stats::category c) -> std::string_view;
+
+	/// Writes ``stats`` as a table with a row for each category, under the heading ``title``.
+	void write_stats(llvm::raw_ostream& os, std::string_view title, memory_stats const& stats);
+} // namespace driver
+
+#endif // SCHREIBER_MEMORY_STATS_HPP
@@ -0,0 +1,58 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_MERGE_HPP
+#define SCHREIBER_MERGE_HPP
+
+#include <cstddef>
+#include <expected>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace driver {
+	/// Returns the USR of an entity written by ``serialise``, usually without parsing the rest of
+	/// the line, or ``std::nullopt`` if ``line`` isn't an entity.
+	[[nodiscard]] auto entity_usr(std::string_view line) -> std::optional<std::string>;
+
+	struct merge_options {
+		/// The number of threads to merge with. Each thread merges the USRs whose hash falls in its
+		/// share of the hash range, and the shards are combined at the end.
+		unsigned shards = 1;
+
+		/// The most inputs that a merge reads at once. More inputs than this are merged into
+		/// temporary files first, so that a merge never runs out of file descriptors. The shards
+		/// split it between them, since they run at the same time.
+		std::size_t fan_in = 256;
+	};
+
+	/// Counts what happened during a merge, and holds a warning for each conflict.
+	struct merge_result {
+		/// The number of entities that were written.
+		std::size_t entities = 0;
+
+		/// The number of entities that were dropped because another input had the same USR.
+		std::size_t duplicates = 0;
+
+		/// The number of USRs that were documented differently by different inputs.
+		std::size_t conflicts = 0;
+
+		std::string diagnostics;
+	};
+
+	/// Merges files of entities written by ``write_entities`` into ``output``, which is also
+	/// ordered by USR. Each input must already be sorted by USR, so the merge is a streaming k-way
+	/// merge that only holds one line per input at a time.
+	///
+	/// When several inputs have an entity with the same USR, the one with the most documentation
+	/// is kept, and ties go to the earliest input. Entities with the same USR whose descriptions
+	/// differ are reported as conflicts. Entities without a USR are always kept.
+	[[nodiscard]] auto merge_entities(
+	  std::span<std::string const> inputs,
+	  llvm::raw_ostream& output,
+	  merge_options const& options = {}) -> std::expected<merge_result, std::string>;
+} // namespace driver
+
+#endif // SCHREIBER_MERGE_HPP
@@ -4,15 +4,23 @@
 #ifndef SCHREIBER_PARSER_HPP
 #define SCHREIBER_PARSER_HPP
 
+#include <absl/container/flat_hash_map.h>
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/CommentCommandTraits.h>
 #include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/RawCommentList.h>
 #include <clang/Basic/Diagnostic.h>
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Basic/SourceManager.h>
-#include <expected>
+#include <memory>
 #include <schreiber/info.hpp>
+#include <schreiber/string_interner.hpp>
+#include <set>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace parser {
 	struct command_info {
@@ -91,9 +99,42 @@ namespace parser {
 		  -> description;
 	};
 
+	/// The part of a comment's parse that doesn't depend on the declaration it documents: its
+	/// description, and the text of each directive. Locations are stored as offsets from the start of
+	/// the comment, so that a comment can be lexed once and replayed for every declaration whose
+	/// comment is identical, such as an overload set.
+	struct lexed_comment {
+		struct entry {
+			/// The directive, or ``nullptr`` if it isn't one that's supported.
+			command_info const* token;
+
+			/// The directive's name, as it's spelt in the comment.
+			info::interned_string name;
+
+			/// The text between the directive's name and the next directive.
+			info::interned_string description;
+
+			/// The number of characters between the start of the comment and the directive.
+			int offset = 0;
+
+			/// The line that the directive is on, counted from the comment's first line, and the
+			/// column that the line's text starts at.
+			unsigned line = 0;
+			unsigned column = 0;
+		};
+
+		info::interned_string description;
+		std::vector<entry> directives;
+	};
+
 	class parser {
 	public:
-		explicit parser(clang::ASTContext& context) noexcept;
+		/// \param interner Stores the text of each comment that's parsed. Use the interner of the
+		///                 translation unit that the results are detached into, so that the text is
+		///                 freed along with it.
+		explicit parser(
+		  clang::ASTContext& context,
+		  info::string_interner& interner = info::string_interner::global()) noexcept;
 		~parser();
 
 		/// Parses a named declaration's documentation and returns its intermediate representation.
@@ -117,25 +158,52 @@ namespace parser {
 		/// \param loc The source location of the diagnostic.
 		/// \param diag_id The diagnostic's DiagnosticEngine ID.
 		auto diagnose(clang::SourceLocation loc, unsigned int diag_id) const -> clang::DiagnosticBuilder;
+
+		/// Looks up the type named ``spelling`` as it would be written in ``scope``, such as
+		/// ``std::out_of_range`` or ``vector<int>``. Template arguments aren't checked. Results are
+		/// cached, since the same few exception types are documented across most of a project.
+		///
+		/// \returns The type's declaration, or ``nullptr`` if ``spelling`` doesn't name a type.
+		[[nodiscard]] auto find_type(clang::DeclContext const* scope, std::string_view spelling)
+		  -> clang::NamedDecl const*;
 	private:
 		clang::ASTContext& context_;
 		clang::SourceManager& source_manager_;
 		clang::DiagnosticsEngine& diags_;
+		info::string_interner& interner_;
+
+		struct compare_locations {
+			[[nodiscard]] auto
+			operator()(clang::Decl const* x, clang::Decl const* y) const noexcept -> bool;
+		};
+
+		std::set<clang::Decl const*, compare_locations> undocumented_declarations_;
+		std::set<clang::Decl const*, compare_locations> documented_declarations_;
+		absl::flat_hash_map<std::pair<clang::DeclContext const*, std::string>, clang::NamedDecl const*>
+		  types_;
+
+		/// Comments that have already been lexed, keyed by their text and the column they start at.
+		/// The text is owned by the source manager, which outlives the parser.
+		absl::flat_hash_map<std::pair<std::string_view, unsigned>, lexed_comment> comments_;
 
 		/// Emits a warning for a declaration being undocumented.
 		void diagnose_undocumented_decl(clang::NamedDecl const*) const;
 
+		/// Splits ``comment`` into its description and directives, or returns the result of doing so
+		/// for an identical comment.
+		[[nodiscard]] auto lex(clang::RawComment const& comment) -> lexed_comment const&;
+
+		/// Parses each of ``comment``'s directives for ``entity``, whose documentation begins at
+		/// ``begin_loc``.
 		void parse_directives(
-		  info::entity_info& decl,
-		  line_iterator first,
-		  line_iterator last,
+		  info::entity_info& entity,
+		  lexed_comment const& comment,
 		  clang::SourceLocation begin_loc);
 
-		struct parse_result_t {
-			std::unique_ptr<info::basic_info> info;
-			directive current;
-			next_directive next;
-		};
+		/// Splits a ``\headers`` or ``\modules`` directive's comma-separated ``description`` into
+		/// one entry per name.
+		[[nodiscard]] auto parse_imports(directive directive, info::interned_string description)
+		  -> std::vector<std::unique_ptr<info::basic_info>>;
 
 		// Parses a function declaration's documentation.
 		//
@@ -159,8 +227,9 @@ namespace parser {
 		//   * - ``\\post <description>``
 		//     - Describes a postcondition for the function. May be repeated.
 		//   * - ``\\throws <type> <description>``
-		//     - Describes an exception that might be thrown by the function. The function cannot be
-		//       ``noexcept``. May be repeated.
+		//     - Describes an exception that might be thrown by the function. The ``<type>`` must name
+		//       a type that's visible from the declaration. The function cannot be ``noexcept``. May
+		//       be repeated.
 		//   * - ``\\exits-via <description>``
 		//     - Describes how a function exits, aside from returning or throwing (e.g. via
 		//       ``std::abort()``).
@@ -173,17 +242,41 @@ namespace parser {
 		//
 		// There isn't any need to document specifiers, standard attributes, and some non-standard
 		// attributes recognised by Clang: these will be picked up and put into the documentation.
-		[[nodiscard]]
-		auto visit(clang::FunctionDecl const* decl, directive directive, description description)
-		  -> std::expected<parse_result_t, next_directive>;
+		//
+		// Returns one entry per name for ``\\headers`` and ``\\modules``, and nothing if the directive
+		// is diagnosed as invalid for ``decl``.
+		[[nodiscard]] auto
+		visit(clang::FunctionDecl const* decl, directive directive, info::interned_string description)
+		  -> std::vector<std::unique_ptr<info::basic_info>>;
+
+		// Parses a class, struct, or union's documentation. For a class template, ``decl`` is the
+		// class that the template declares.
+		//
+		// Records support the ``\\headers`` and ``\\modules`` directives. Their members are
+		// documented separately, so the function directives are diagnosed.
+		//
+		// Returns one entry per name for ``\\headers`` and ``\\modules``, and nothing if the directive
+		// is diagnosed as invalid for ``decl``.
+		[[nodiscard]] auto
+		visit(clang::CXXRecordDecl const* decl, directive directive, info::interned_string description)
+		  -> std::vector<std::unique_ptr<info::basic_info>>;
 	};
 
 	[[nodiscard]] auto to_text(clang::RawComment::CommentLine const& line) noexcept -> std::string_view;
 	[[nodiscard]] auto starts_with_backslash(std::string_view c) noexcept -> bool;
 	[[nodiscard]] auto is_space(char c) noexcept -> bool;
 
-	auto parse_module_info(std::string_view text) -> std::vector<info::decl_info::module_info>;
-	auto parse_header_info(std::string_view text) -> std::vector<info::decl_info::header_info>;
+	/// Splits a comma-separated list of module names, interning each name using ``interner``.
+	auto parse_module_info(
+	  std::string_view text,
+	  info::string_interner& interner = info::string_interner::global())
+	  -> std::vector<info::decl_info::module_info>;
+
+	/// Splits a comma-separated list of header names, interning each name using ``interner``.
+	auto parse_header_info(
+	  std::string_view text,
+	  info::string_interner& interner = info::string_interner::global())
+	  -> std::vector<info::decl_info::header_info>;
 } // namespace parser
 
 #endif // SCHREIBER_PARSER_HPP
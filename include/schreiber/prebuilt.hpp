@@ -0,0 +1,72 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_PREBUILT_HPP
+#define SCHREIBER_PREBUILT_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/ADT/StringRef.h>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace driver {
+	/// Returns whether the precompiled header or module interface ``ast_file`` is missing, or is
+	/// older than one of the non-system files that it was built from.
+	[[nodiscard]] auto is_stale(std::string const& ast_file) -> bool;
+
+	/// Tracks the precompiled headers and module interfaces that a run's compile commands load.
+	///
+	/// Loading a header from an AST file that the build already produced is much cheaper than
+	/// parsing it again, but a stale AST file is a fatal error. Stale precompiled headers are
+	/// replaced with the headers that they were built from, so an out-of-date build directory costs
+	/// time rather than failing the run. Module interfaces have no such fallback: a stale one can
+	/// only be dropped if the module can be found through ``-fprebuilt-module-path``. Once a
+	/// translation unit has extracted the declarations loaded from an AST file, the others skip them.
+	///
+	/// It's thread-safe, so a single instance can be shared by a run's threads.
+	class prebuilt_files {
+	public:
+		/// Replaces each stale ``-include-pch`` in ``arguments`` with an ``-include`` of the header
+		/// that it was built from. Each stale ``-fmodule-file`` is dropped if ``arguments`` has a
+		/// ``-fprebuilt-module-path`` to find the module through instead, and is otherwise kept, so
+		/// that the translation unit fails. Each AST file is only checked once per run.
+		///
+		/// \param directory The directory that relative paths in ``arguments`` are relative to.
+		/// \param diagnostics Receives a warning for each stale AST file that's replaced or dropped,
+		///                    and an error for each one that's kept.
+		[[nodiscard]] auto adjust(
+		  clang::tooling::CommandLineArguments const& arguments,
+		  llvm::StringRef directory,
+		  std::string& diagnostics) -> clang::tooling::CommandLineArguments;
+
+		/// Returns whether a translation unit has already extracted the declarations that were loaded
+		/// from an AST file into ``file``.
+		[[nodiscard]] auto is_claimed(std::string_view file) const -> bool;
+
+		/// Records that the calling translation unit extracted the declarations in ``files``. It's
+		/// only called once the translation unit has finished extracting, so that a translation unit
+		/// that's cancelled doesn't stop others from extracting its files. Translation units that
+		/// run at the same time might extract the same file, which is harmless, since entities are
+		/// merged by USR.
+		void claim(std::span<std::string const> files);
+	private:
+		struct ast_file {
+			bool stale = true;
+
+			/// The header that a precompiled header was built from, if it could be read.
+			std::string original_source;
+		};
+
+		mutable std::mutex mutex_;
+		absl::flat_hash_map<std::string, ast_file> ast_files_;
+		absl::flat_hash_set<std::string> claimed_;
+
+		[[nodiscard]] auto inspect(std::string const& path) -> ast_file;
+	};
+} // namespace driver
+
+#endif // SCHREIBER_PREBUILT_HPP
@@ -0,0 +1,71 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_RENDER_RST_HPP
+#define SCHREIBER_RENDER_RST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <schreiber/detached_info.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace driver {
+	/// Chooses which page each entity is documented on.
+	enum class page_grouping : std::uint8_t {
+		/// One page per namespace.
+		by_namespace,
+
+		/// One page per header that declares an entity. Entities that can be found in several
+		/// headers are documented on each of their pages.
+		by_header,
+	};
+
+	struct render_options {
+		page_grouping grouping = page_grouping::by_namespace;
+
+		/// The number of threads to render pages with.
+		unsigned jobs = 1;
+	};
+
+	struct render_result {
+		/// The number of pages that were written, including the index.
+		std::size_t pages_written = 0;
+
+		/// The number of pages that were left alone because their entities haven't changed.
+		std::size_t pages_unchanged = 0;
+
+		/// The number of pages from an earlier run that were removed because they no longer have any
+		/// entities.
+		std::size_t pages_removed = 0;
+	};
+
+	/// Appends a Sphinx directive documenting ``entity`` to ``output``: ``cpp:function`` for a
+	/// function, and ``cpp:class``, ``cpp:struct``, or ``cpp:union`` for a record.
+	void render_entity(std::string& output, info::detached_entity const& entity);
+
+	/// Appends a Sphinx directive declaring ``entity`` with ``documented``'s documentation, for an
+	/// entity that inherits its documentation from a base member. A null ``documented`` renders the
+	/// declaration alone.
+	void render_entity(
+	  std::string& output,
+	  info::detached_entity const& entity,
+	  info::detached_entity const* documented);
+
+	/// Writes a reStructuredText page for each namespace or header in ``entities`` to
+	/// ``directory``, along with an ``index.rst`` whose toctree lists them.
+	///
+	/// Each page records a hash of the entities on it, computed from their ``content_hash``es and
+	/// signatures. A page whose hash hasn't changed isn't rendered or rewritten, so Sphinx only
+	/// rebuilds the pages whose documentation changed. Pages that an earlier run rendered, but
+	/// that no longer have any entities, are removed. Files in ``directory`` without a page hash are
+	/// never touched.
+	[[nodiscard]] auto render_pages(
+	  std::span<info::detached_entity const* const> entities,
+	  std::string_view directory,
+	  render_options const& options = {}) -> std::expected<render_result, std::string>;
+} // namespace driver
+
+#endif // SCHREIBER_RENDER_RST_HPP
@@ -0,0 +1,90 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_SCHEDULER_HPP
+#define SCHREIBER_SCHEDULER_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <chrono>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace driver {
+	/// Remembers how long each translation unit took to extract, so that the next run can start the
+	/// slowest ones first.
+	class timing_history {
+	public:
+		/// Reads a history written by ``save``. A file that doesn't exist yet is an empty history.
+		[[nodiscard]] static auto load(std::string const& path)
+		  -> std::expected<timing_history, std::string>;
+
+		/// Writes the history to ``path``, one translation unit per line.
+		[[nodiscard]] auto save(std::string const& path) const -> std::expected<void, std::string>;
+
+		/// Returns how long ``file`` took to extract, if it's been seen before.
+		[[nodiscard]] auto find(std::string_view file) const -> std::optional<std::chrono::milliseconds>;
+
+		/// Records that ``file`` took ``elapsed`` to extract. The measurement is averaged with the
+		/// previous one, so that a single noisy run doesn't reorder the next.
+		void record(std::string_view file, std::chrono::milliseconds elapsed);
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+	private:
+		absl::flat_hash_map<std::string, std::chrono::milliseconds> durations_;
+	};
+
+	/// Returns the absolute path to ``command``'s main file.
+	[[nodiscard]] auto main_file_path(clang::tooling::CompileCommand const& command) -> std::string;
+
+	/// Estimates the relative cost of extracting each translation unit in ``commands``.
+	///
+	/// Translation units in ``history`` cost what they took last time. The rest are estimated from
+	/// the size of their main file and how many headers it includes, scaled to match the
+	/// translation units that do have a history.
+	[[nodiscard]] auto estimate_costs(
+	  std::span<clang::tooling::CompileCommand const> commands,
+	  timing_history const* history) -> std::vector<double>;
+
+	/// Returns the indices of ``costs``, from most to least expensive.
+	[[nodiscard]] auto longest_first(std::span<double const> costs) -> std::vector<std::size_t>;
+
+	/// Hands out jobs to a fixed set of worker threads.
+	///
+	/// Jobs are dealt to the workers' deques longest-first, so every worker starts on one of the most
+	/// expensive jobs. A worker whose deque runs dry steals the most expensive job from the deque
+	/// with the most work left, so that a few large translation units don't end up queued behind
+	/// each other at the end of a run.
+	class work_queue {
+	public:
+		/// \param costs The estimated cost of each job.
+		/// \param workers The number of workers that will call ``pop``.
+		work_queue(std::span<double const> costs, std::size_t workers);
+
+		/// Returns the next job for ``worker``, or ``std::nullopt`` once every job has been handed
+		/// out.
+		[[nodiscard]] auto pop(std::size_t worker) -> std::optional<std::size_t>;
+	private:
+		struct alignas(64) worker_deque {
+			std::mutex mutex;
+			std::deque<std::size_t> jobs;
+			double remaining = 0;
+		};
+
+		std::vector<double> costs_;
+		std::size_t worker_count_;
+		std::unique_ptr<worker_deque[]> deques_;
+
+		[[nodiscard]] auto pop_front(worker_deque& deque) -> std::optional<std::size_t>;
+	};
+} // namespace driver
+
+#endif // SCHREIBER_SCHEDULER_HPP
@@ -0,0 +1,218 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_SCHREIBER_H
+#define SCHREIBER_SCHREIBER_H
+
+// A C interface to schreiber, for tools that would rather load it as a library than run it once per
+// file. Everything is reached through a session, which owns the translation units that have been
+// extracted and everything that they refer to.
+//
+// Strings are returned as views that aren't null-terminated. They, and every handle, stay valid
+// until the session that they came from is destroyed. A session mustn't be used by more than one
+// thread at once, but different sessions can be used concurrently.
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define SCHREIBER_EXPORT __attribute__((visibility("default")))
+#else
+#define SCHREIBER_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The version of this interface. It changes whenever a function is added or changed, but
+/// functions are never removed.
+#define SCHREIBER_API_VERSION 2
+
+typedef struct schreiber_session schreiber_session;
+typedef struct schreiber_translation_unit schreiber_translation_unit;
+typedef struct schreiber_entity schreiber_entity;
+
+typedef enum schreiber_status {
+	SCHREIBER_OK = 0,
+
+	/// The arguments didn't make sense, such as a relative path where an absolute one was needed.
+	SCHREIBER_INVALID_ARGUMENT = 1,
+
+	/// At least one translation unit didn't compile. Whatever was extracted is still available.
+	SCHREIBER_FAILED = 2,
+} schreiber_status;
+
+typedef enum schreiber_translation_unit_status {
+	SCHREIBER_TRANSLATION_UNIT_OK = 0,
+	SCHREIBER_TRANSLATION_UNIT_FAILED = 1,
+	SCHREIBER_TRANSLATION_UNIT_CRASHED = 2,
+	SCHREIBER_TRANSLATION_UNIT_TIMED_OUT = 3,
+} schreiber_translation_unit_status;
+
+typedef enum schreiber_entity_kind {
+	SCHREIBER_ENTITY_FUNCTION = 0,
+	SCHREIBER_ENTITY_FUNCTION_TEMPLATE = 1,
+
+	/// A class, struct, or union. Its type says which.
+	SCHREIBER_ENTITY_RECORD = 2,
+	SCHREIBER_ENTITY_CLASS_TEMPLATE = 3,
+} schreiber_entity_kind;
+
+/// The kinds of directive that can be documented for an entity. Each kind fills in a different
+/// subset of ``schreiber_directive``'s fields, and leaves the rest empty.
+typedef enum schreiber_directive_kind {
+	/// ``name``, ``type``, ``description``, and ``location``.
+	SCHREIBER_DIRECTIVE_TEMPLATE_PARAMETER = 0,
+
+	/// ``name``, ``type``, ``description``, and ``location``.
+	SCHREIBER_DIRECTIVE_PARAMETER = 1,
+
+	/// ``description`` and ``location``.
+	SCHREIBER_DIRECTIVE_PRECONDITION = 2,
+
+	/// ``description`` and ``location``.
+	SCHREIBER_DIRECTIVE_POSTCONDITION = 3,
+
+	/// ``type``, ``usr``, ``description``, and ``location``. ``usr`` is empty when the exception
+	/// type couldn't be found.
+	SCHREIBER_DIRECTIVE_THROWS = 4,
+
+	/// ``description`` and ``location``.
+	SCHREIBER_DIRECTIVE_EXITS_VIA = 5,
+
+	/// ``name``.
+	SCHREIBER_DIRECTIVE_HEADER = 6,
+
+	/// ``name``.
+	SCHREIBER_DIRECTIVE_MODULE = 7,
+
+	/// ``name`` and ``usr``: another entity that the documentation mentions.
+	SCHREIBER_DIRECTIVE_REFERENCE = 8,
+} schreiber_directive_kind;
+
+typedef struct schreiber_string {
+	char const* data;
+	size_t size;
+} schreiber_string;
+
+typedef struct schreiber_location {
+	schreiber_string file;
+	unsigned line;
+	unsigned column;
+} schreiber_location;
+
+typedef struct schreiber_directive {
+	schreiber_string name;
+	schreiber_string type;
+	schreiber_string usr;
+	schreiber_string description;
+	schreiber_location location;
+} schreiber_directive;
+
+/// Returns ``SCHREIBER_API_VERSION`` as it was when the library was built.
+SCHREIBER_EXPORT unsigned schreiber_api_version(void);
+
+/// Returns a new session, or a null pointer if one couldn't be created.
+SCHREIBER_EXPORT schreiber_session* schreiber_session_create(void);
+
+/// Destroys ``session`` and everything that it returned. ``session`` may be a null pointer.
+SCHREIBER_EXPORT void schreiber_session_destroy(schreiber_session* session);
+
+/// Returns a description of the last call on ``session`` that didn't return ``SCHREIBER_OK``.
+SCHREIBER_EXPORT schreiber_string schreiber_session_last_error(schreiber_session const* session);
+
+/// Queues a translation unit to be extracted by the next ``schreiber_session_run``.
+///
+/// \param directory The directory that the command is run from.
+/// \param file The translation unit's main file.
+/// \param arguments The command line, starting with the compiler, as it would appear in
+///                  ``compile_commands.json``. If ``argument_count`` is zero, the file is compiled
+///                  with ``clang++`` and no flags.
+SCHREIBER_EXPORT schreiber_status schreiber_session_add_file(
+  schreiber_session* session,
+  char const* directory,
+  char const* file,
+  char const* const* arguments,
+  size_t argument_count);
+
+/// Queues every translation unit in the compilation database found in ``build_directory``.
+SCHREIBER_EXPORT schreiber_status
+schreiber_session_add_compilation_database(schreiber_session* session, char const* build_directory);
+
+/// Makes ``path`` read as ``contents`` rather than from disk, such as for a buffer that an editor
+/// hasn't saved. It applies to every later run, and replaces any previous contents for ``path``. A
+/// buffer can be both a translation unit's main file and included by other files.
+///
+/// \param path An absolute path.
+SCHREIBER_EXPORT schreiber_status schreiber_session_add_buffer(
+  schreiber_session* session,
+  char const* path,
+  char const* contents,
+  size_t size);
+
+/// Extracts every queued translation unit using ``jobs`` threads, then resolves the references
+/// between all of the session's entities.
+///
+/// \returns ``SCHREIBER_FAILED`` if any of the translation units didn't compile.
+SCHREIBER_EXPORT schreiber_status schreiber_session_run(schreiber_session* session, unsigned jobs);
+
+/// Returns the number of translation units that have been extracted, in the order that they were
+/// added.
+SCHREIBER_EXPORT size_t schreiber_session_translation_unit_count(schreiber_session const* session);
+
+/// \pre ``index < schreiber_session_translation_unit_count(session)``.
+SCHREIBER_EXPORT schreiber_translation_unit const*
+schreiber_session_translation_unit(schreiber_session const* session, size_t index);
+
+SCHREIBER_EXPORT schreiber_string
+schreiber_translation_unit_file(schreiber_translation_unit const* unit);
+
+SCHREIBER_EXPORT schreiber_translation_unit_status
+schreiber_translation_unit_get_status(schreiber_translation_unit const* unit);
+
+/// Returns the translation unit's diagnostics, formatted as Clang would print them.
+SCHREIBER_EXPORT schreiber_string
+schreiber_translation_unit_diagnostics(schreiber_translation_unit const* unit);
+
+SCHREIBER_EXPORT size_t
+schreiber_translation_unit_entity_count(schreiber_translation_unit const* unit);
+
+/// \pre ``index < schreiber_translation_unit_entity_count(unit)``.
+SCHREIBER_EXPORT schreiber_entity const*
+schreiber_translation_unit_entity(schreiber_translation_unit const* unit, size_t index);
+
+SCHREIBER_EXPORT schreiber_entity_kind schreiber_entity_get_kind(schreiber_entity const* entity);
+SCHREIBER_EXPORT schreiber_string schreiber_entity_usr(schreiber_entity const* entity);
+SCHREIBER_EXPORT schreiber_string schreiber_entity_name(schreiber_entity const* entity);
+SCHREIBER_EXPORT schreiber_string schreiber_entity_qualified_name(schreiber_entity const* entity);
+SCHREIBER_EXPORT schreiber_string schreiber_entity_type(schreiber_entity const* entity);
+SCHREIBER_EXPORT schreiber_location schreiber_entity_location(schreiber_entity const* entity);
+
+/// Returns the USR of the member function whose documentation the entity inherits, or an empty
+/// string if it has documentation of its own. The inherited documentation belongs to that entity,
+/// which might be in a different translation unit.
+SCHREIBER_EXPORT schreiber_string schreiber_entity_inherits_from(schreiber_entity const* entity);
+
+/// Returns the entity's description and where its comment starts.
+SCHREIBER_EXPORT schreiber_directive schreiber_entity_documentation(schreiber_entity const* entity);
+
+/// Writes the entity's ``\returns`` directive to ``result``, if it has one.
+///
+/// \returns Non-zero if the entity has a ``\returns`` directive.
+SCHREIBER_EXPORT int
+schreiber_entity_returns(schreiber_entity const* entity, schreiber_directive* result);
+
+SCHREIBER_EXPORT size_t
+schreiber_entity_directive_count(schreiber_entity const* entity, schreiber_directive_kind kind);
+
+/// \pre ``index < schreiber_entity_directive_count(entity, kind)``.
+SCHREIBER_EXPORT schreiber_directive schreiber_entity_directive(
+  schreiber_entity const* entity,
+  schreiber_directive_kind kind,
+  size_t index);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // SCHREIBER_SCHREIBER_H
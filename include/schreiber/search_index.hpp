@@ -0,0 +1,104 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_SEARCH_INDEX_HPP
+#define SCHREIBER_SEARCH_INDEX_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <schreiber/detached_info.hpp>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace info {
+	/// Splits ``text`` into lowercase words for the search index. A word is a run of letters,
+	/// digits, underscores, and non-ASCII bytes, so ``std::vector<int>`` is ``std``, ``vector``, and
+	/// ``int``.
+	[[nodiscard]] auto search_terms(std::string_view text) -> std::vector<std::string>;
+
+	/// Collects the words in each entity's documentation, for writing a ``search_index``.
+	///
+	/// Translation units can be added from any number of threads, so the index can be built while
+	/// the rest of the run is still extracting. Each entity is a document, identified by its USR.
+	/// Entities without a USR can't be looked up afterwards, so they're left out.
+	class search_index_builder {
+	public:
+		/// Adds each entity in ``unit`` that hasn't already been added. Tokenising happens before
+		/// the builder is locked, so concurrent calls only contend while their words are recorded.
+		void add(detached_translation_unit const& unit);
+
+		/// Returns the number of documents added so far.
+		[[nodiscard]] auto size() const -> std::size_t;
+
+		/// Writes the index in the format that ``search_index::load`` reads. Documents are numbered
+		/// in USR order, so the same entities always produce the same file.
+		void write(llvm::raw_ostream& os) const;
+	private:
+		mutable std::shared_mutex mutex_;
+		absl::flat_hash_map<std::string, std::uint32_t> documents_;
+		absl::flat_hash_map<std::string, std::vector<std::uint32_t>> postings_;
+	};
+
+	/// A read-only full-text index over entity documentation, written by ``search_index_builder``.
+	///
+	/// The file is read in place, so loading it costs a map of the file rather than a parse. Terms
+	/// are sorted so that exact and prefix lookups are binary searches, and each term's documents
+	/// are stored as ascending deltas encoded as ULEB128.
+	class search_index {
+	public:
+		using document_id = std::uint32_t;
+
+		/// Maps the index at ``path``.
+		[[nodiscard]] static auto load(std::string const& path)
+		  -> std::expected<search_index, std::string>;
+
+		/// Reads the index in ``buffer``, checking that its tables are within bounds.
+		[[nodiscard]] static auto parse(std::unique_ptr<llvm::MemoryBuffer> buffer)
+		  -> std::expected<search_index, std::string>;
+
+		/// Returns the number of documents in the index.
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		/// Returns the USR of the entity that ``id`` describes.
+		///
+		/// \pre ``id < size()``
+		[[nodiscard]] auto usr(document_id id) const -> std::string_view;
+
+		/// Returns the documents that contain ``term``, in ascending order.
+		[[nodiscard]] auto find(std::string_view term) const -> std::vector<document_id>;
+
+		/// Returns the documents that contain a term starting with ``prefix``, in ascending order.
+		[[nodiscard]] auto find_prefix(std::string_view prefix) const -> std::vector<document_id>;
+
+		/// Returns the documents matching ``query``, in ascending order.
+		///
+		/// A query is a list of words that must all appear. ``-word`` excludes documents containing
+		/// ``word``, ``word*`` matches any word that starts with ``word``, and ``OR`` separates
+		/// alternatives, so ``vector -deprecated OR span*`` finds documents that either mention
+		/// ``vector`` but not ``deprecated``, or that mention ``span`` or ``spans``.
+		[[nodiscard]] auto search(std::string_view query) const -> std::vector<document_id>;
+	private:
+		std::unique_ptr<llvm::MemoryBuffer> buffer_;
+		std::uint32_t document_count_ = 0;
+		std::uint32_t term_count_ = 0;
+		char const* documents_ = nullptr;
+		char const* terms_ = nullptr;
+		std::string_view postings_;
+		std::string_view strings_;
+
+		explicit search_index(std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+		[[nodiscard]] auto term(std::uint32_t i) const -> std::string_view;
+		[[nodiscard]] auto lower_bound(std::string_view term) const -> std::uint32_t;
+		[[nodiscard]] auto decode(std::uint32_t i) const -> std::vector<document_id>;
+	};
+} // namespace info
+
+#endif // SCHREIBER_SEARCH_INDEX_HPP
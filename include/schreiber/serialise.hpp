@@ -0,0 +1,70 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_SERIALISE_HPP
+#define SCHREIBER_SERIALISE_HPP
+
+#include <absl/container/flat_hash_map.h>
+#include <cstdint>
+#include <expected>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/import_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace driver {
+	/// Writes ``entity`` as a JSON object.
+	void serialise(llvm::json::OStream& writer, info::detached_entity const& entity);
+
+	/// Reads an entity written by ``serialise``, interning its strings into ``unit``.
+	[[nodiscard]] auto
+	deserialise_entity(llvm::json::Value const& json, info::detached_translation_unit& unit)
+	  -> std::expected<info::detached_entity, std::string>;
+
+	/// Writes ``result`` as a JSON object on a single line.
+	void serialise(llvm::raw_ostream& os, translation_unit_result const& result);
+
+	/// Reads a translation unit written by ``serialise``, interning its strings into ``interner``.
+	[[nodiscard]] auto deserialise_translation_unit(
+	  std::string_view text,
+	  info::string_interner& interner = info::string_interner::global())
+	  -> std::expected<translation_unit_result, std::string>;
+
+	/// Returns the entities from every translation unit in ``results`` ordered by USR, keeping only
+	/// the first entity with each USR.
+	[[nodiscard]] auto unique_entities(std::span<translation_unit_result const> results)
+	  -> std::vector<info::detached_entity const*>;
+
+	/// Writes the entities from every translation unit in ``results`` as JSON Lines (i.e. one entity
+	/// per line), ordered by USR.
+	void write_entities(llvm::raw_ostream& os, std::span<translation_unit_result const> results);
+
+	/// Maps the USR of each entity in a run to its ``content_hash``.
+	using content_manifest = absl::flat_hash_map<std::string, std::uint64_t>;
+
+	/// Writes the USR and content hash of each entity that ``write_entities`` writes, as JSON Lines.
+	/// Comparing a run's manifest with the previous run's shows which entities' documentation has
+	/// changed. Entities without a USR can't be matched across runs, so they're left out.
+	void write_manifest(llvm::raw_ostream& os, std::span<translation_unit_result const> results);
+
+	/// Reads a manifest written by ``write_manifest``.
+	[[nodiscard]] auto read_manifest(std::string_view text)
+	  -> std::expected<content_manifest, std::string>;
+
+	/// Writes an ``import_index`` of ``entities`` as a JSON object, where each entity's id is its
+	/// position in ``entities``. Passing the result of ``unique_entities`` makes each id the line
+	/// that ``write_entities`` wrote the entity on, counting from zero.
+	void write_imports(llvm::raw_ostream& os, std::span<info::detached_entity const* const> entities);
+
+	/// Reads an index written by ``write_imports``, interning its names into ``interner``.
+	[[nodiscard]] auto read_imports(std::string_view text, info::string_interner& interner)
+	  -> std::expected<info::import_index, std::string>;
+} // namespace driver
+
+#endif // SCHREIBER_SERIALISE_HPP
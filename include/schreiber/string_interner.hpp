@@ -0,0 +1,115 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_STRING_INTERNER_HPP
+#define SCHREIBER_STRING_INTERNER_HPP
+
+#include <absl/container/flat_hash_set.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/StringSaver.h>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+
+namespace info {
+	/// A handle to a string owned by a ``string_interner``. Each distinct string is stored exactly
+	/// once, so two handles from the same interner are equal exactly when they point to the same
+	/// storage: comparing and hashing handles never looks at the characters.
+	class interned_string {
+	public:
+		constexpr interned_string() noexcept = default;
+
+		/// Returns the interned string. The view is valid for as long as its interner is alive.
+		[[nodiscard]] constexpr auto view() const noexcept -> std::string_view
+		{
+			return {data_, size_};
+		}
+
+		/// Returns a pointer to the null-terminated interned string.
+		[[nodiscard]] constexpr auto c_str() const noexcept -> char const*
+		{
+			return data_ != nullptr ? data_ : "";
+		}
+
+		[[nodiscard]] constexpr auto empty() const noexcept -> bool
+		{
+			return size_ == 0;
+		}
+
+		friend constexpr auto
+		operator==(interned_string const x, interned_string const y) noexcept -> bool
+		{
+			return x.data_ == y.data_;
+		}
+
+		template<class H>
+		friend auto AbslHashValue(H h, interned_string const s) -> H
+		{
+			return H::combine(std::move(h), s.data_);
+		}
+	private:
+		friend class string_interner;
+
+		constexpr interned_string(char const* const data, std::size_t const size) noexcept
+		: data_(data)
+		, size_(size)
+		{}
+
+		char const* data_ = nullptr;
+		std::size_t size_ = 0;
+	};
+
+	/// Stores each distinct string once, and hands out stable handles to them. Interning is
+	/// thread-safe: the string space is split into independently locked shards so that worker
+	/// threads interning unrelated strings rarely contend, and lookups of strings that have already
+	/// been interned only take a shared lock.
+	class string_interner {
+	public:
+		string_interner() = default;
+		string_interner(string_interner const&) = delete;
+		auto operator=(string_interner const&) -> string_interner& = delete;
+		~string_interner() = default;
+
+		/// Returns a handle to the stored copy of ``s``, storing it first if it hasn't been seen.
+		[[nodiscard]] auto intern(std::string_view s) -> interned_string;
+
+		/// Returns a handle to the stored copy of ``s`` if it's been interned, and an empty handle
+		/// otherwise. Unlike ``intern``, it never stores anything, so it's suitable for lookups of
+		/// strings that come from outside, such as queries.
+		[[nodiscard]] auto find(std::string_view s) const -> interned_string;
+
+		/// Returns the number of distinct strings that have been interned.
+		[[nodiscard]] auto size() const -> std::size_t;
+
+		/// Returns the number of bytes that have been allocated to store the strings.
+		[[nodiscard]] auto allocated_bytes() const -> std::size_t;
+
+		/// Returns the interner shared by everything in the process.
+		[[nodiscard]] static auto global() -> string_interner&;
+	private:
+		static constexpr auto shard_count = std::size_t{64};
+
+		struct alignas(64) shard {
+			mutable std::shared_mutex mutex;
+			absl::flat_hash_set<std::string_view> strings;
+			llvm::BumpPtrAllocator allocator;
+			llvm::StringSaver saver{allocator};
+		};
+
+		std::array<shard, shard_count> shards_;
+	};
+} // namespace info
+
+template<>
+struct std::hash<info::interned_string> {
+	[[nodiscard]] auto operator()(info::interned_string const s) const noexcept -> std::size_t
+	{
+		return std::hash<char const*>()(s.view().data());
+	}
+};
+
+#endif // SCHREIBER_STRING_INTERNER_HPP
@@ -0,0 +1,86 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef SCHREIBER_WORKER_POOL_HPP
+#define SCHREIBER_WORKER_POOL_HPP
+
+#include <chrono>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <schreiber/changed_lines.hpp>
+#include <schreiber/entity_index.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/scheduler.hpp>
+#include <schreiber/search_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <span>
+#include <vector>
+
+namespace driver {
+	/// Describes how a run should be executed.
+	struct run_options {
+		/// The number of translation units to extract concurrently.
+		unsigned jobs = 1;
+
+		/// How long each translation unit took in previous runs, if known. It's used to start the
+		/// most expensive translation units first.
+		timing_history const* history = nullptr;
+
+		/// Stops new translation units from starting while the run's resident memory is close to
+		/// this many bytes. Zero means that there's no limit.
+		std::size_t memory_limit = 0;
+
+		/// How long each translation unit may take before it's cancelled. Zero means that there's no
+		/// limit.
+		std::chrono::milliseconds timeout = {};
+
+		/// If present, only declarations that overlap these lines are extracted.
+		changed_lines const* changed = nullptr;
+
+		/// If present, each translation unit's entities are added as soon as it finishes, so that
+		/// the index can be queried while the rest of the run continues.
+		info::entity_index* index = nullptr;
+
+		/// If present, each translation unit's documentation is added to the search index as soon as
+		/// it finishes, so that indexing overlaps with extracting the rest of the run.
+		info::search_index_builder* search = nullptr;
+
+		/// If present, files are read from here rather than from disk.
+		llvm::vfs::FileSystem* file_system = nullptr;
+
+		/// If present, ``run_in_process`` caches the files that it reads here rather than in a cache
+		/// of its own, so that the caller can see how much memory they take. The cache assumes that
+		/// files don't change, so it shouldn't be shared between runs. ``run_isolated`` ignores it,
+		/// since each worker process has a cache of its own.
+		file_cache* cache = nullptr;
+
+		/// If present, every translation unit's strings are interned here rather than in
+		/// ``string_interner::global()``. It must outlive the results.
+		info::string_interner* interner = nullptr;
+	};
+
+	/// Extracts each translation unit in ``commands`` using ``options.jobs`` threads. Timeouts are
+	/// cooperative: a translation unit stops at the next declaration after its deadline.
+	///
+	/// \returns The result for each translation unit, in the same order as ``commands``.
+	[[nodiscard]] auto
+	run_in_process(std::span<clang::tooling::CompileCommand const> commands, run_options const& options)
+	  -> std::vector<translation_unit_result>;
+
+	/// Extracts each translation unit in ``commands`` using ``options.jobs`` worker processes. The
+	/// workers are forked from the calling process, so they inherit an initialised LLVM rather than
+	/// paying for process startup. A translation unit that crashes its worker is reported as
+	/// ``crashed``, and the worker is replaced so that the rest of the run can continue. A worker
+	/// that's still busy after twice ``options.timeout`` is killed and replaced in the same way.
+	///
+	/// The caller must be single-threaded.
+	///
+	/// \returns The result for each translation unit, in the same order as ``commands``.
+	[[nodiscard]] auto
+	run_isolated(std::span<clang::tooling::CompileCommand const> commands, run_options const& options)
+	  -> std::vector<translation_unit_result>;
+} // namespace driver
+
+#endif // SCHREIBER_WORKER_POOL_HPP
@@ -0,0 +1,176 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_set.h>
+#include <cstddef>
+#include <schreiber/cross_references.hpp>
+#include <schreiber/detached_info.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace info {
+	namespace {
+		[[nodiscard]] auto is_identifier_start(char const c) -> bool
+		{
+			return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or c == '_';
+		}
+
+		[[nodiscard]] auto is_identifier_character(char const c) -> bool
+		{
+			return is_identifier_start(c) or (c >= '0' and c <= '9');
+		}
+
+		/// Returns the length of the identifier at the start of ``text``.
+		[[nodiscard]] auto identifier_size(std::string_view const text) -> std::size_t
+		{
+			if (text.empty() or not is_identifier_start(text[0])) {
+				return 0;
+			}
+
+			auto size = std::size_t{1};
+			while (size < text.size() and is_identifier_character(text[size])) {
+				++size;
+			}
+
+			return size;
+		}
+
+		/// Returns the length of the ``::``-separated name at the start of ``text``, including a
+		/// leading ``::``.
+		[[nodiscard]] auto name_size(std::string_view const text) -> std::size_t
+		{
+			auto size = std::size_t{0};
+			while (true) {
+				auto const separator = size > 0 or text.starts_with("::") ? std::size_t{2} : 0;
+				if (separator > 0 and text.substr(size, 2) != "::") {
+					return size;
+				}
+
+				auto const identifier = identifier_size(text.substr(size + separator));
+				if (identifier == 0) {
+					return size;
+				}
+
+				size += separator + identifier;
+			}
+		}
+	} // namespace
+
+	auto find_mentions(std::string_view const text) -> std::vector<std::string_view>
+	{
+		auto result = std::vector<std::string_view>();
+		auto i = std::size_t{0};
+		while (i < text.size()) {
+			// Names only start at the beginning of a word, and the ``b`` in ``a.b()`` or ``a->b()`` is
+			// a member access rather than a mention of ``b``.
+			auto const previous = i == 0 ? ' ' : text[i - 1];
+			auto const member = previous == '.' or (previous == '>' and i >= 2 and text[i - 2] == '-');
+			auto const size = is_identifier_character(previous) or previous == ':' or member
+			                  ? 0
+			                  : name_size(text.substr(i));
+			if (size == 0) {
+				++i;
+				continue;
+			}
+
+			auto const name = text.substr(i, size);
+			i += size;
+			if (name.find("::") != std::string_view::npos or text.substr(i).starts_with("()")) {
+				result.push_back(name);
+			}
+		}
+
+		return result;
+	}
+
+	void symbol_table::add(detached_entity const& entity)
+	{
+		if (not entity.qualified_name.empty() and not entity.usr.empty()) {
+			usrs_.try_emplace(entity.qualified_name, entity.usr);
+		}
+	}
+
+	auto symbol_table::find(std::string_view const qualified_name) const -> std::string_view
+	{
+		auto const i = usrs_.find(qualified_name);
+		return i != usrs_.end() ? i->second : std::string_view();
+	}
+
+	auto symbol_table::resolve(std::string_view const name, std::string_view scope) const
+	  -> std::string_view
+	{
+		if (name.starts_with("::")) {
+			return find(name.substr(2));
+		}
+
+		auto candidate = std::string();
+		while (not scope.empty()) {
+			candidate.assign(scope);
+			candidate += "::";
+			candidate += name;
+			if (auto const usr = find(candidate); not usr.empty()) {
+				return usr;
+			}
+
+			auto const parent = scope.rfind("::");
+			scope = parent == std::string_view::npos ? std::string_view() : scope.substr(0, parent);
+		}
+
+		return find(name);
+	}
+
+	auto symbol_table::size() const noexcept -> std::size_t
+	{
+		return usrs_.size();
+	}
+
+	auto resolve_references(detached_entity const& entity, symbol_table const& symbols)
+	  -> std::vector<detached_reference>
+	{
+		auto const qualifier = entity.qualified_name.rfind("::");
+		auto const scope = qualifier == std::string_view::npos
+		                   ? std::string_view()
+		                   : entity.qualified_name.substr(0, qualifier);
+
+		auto result = std::vector<detached_reference>();
+		auto seen = absl::flat_hash_set<std::string_view>();
+		auto const resolve = [&](std::string_view const description) {
+			for (auto const name : find_mentions(description)) {
+				if (not seen.insert(name).second) {
+					continue;
+				}
+
+				auto const usr = symbols.resolve(name, scope);
+				if (not usr.empty() and usr != entity.usr) {
+					result.push_back(detached_reference{.name = name, .usr = usr});
+				}
+			}
+		};
+
+		resolve(entity.documentation.description);
+		for (auto const* const parameters : {&entity.template_parameters, &entity.parameters}) {
+			for (auto const& parameter : *parameters) {
+				resolve(parameter.description);
+			}
+		}
+
+		if (entity.returns.has_value()) {
+			resolve(entity.returns->description);
+		}
+
+		for (auto const* const texts :
+		     {&entity.preconditions, &entity.postconditions, &entity.exits_via})
+		{
+			for (auto const& text : *texts) {
+				resolve(text.description);
+			}
+		}
+
+		for (auto const& exception : entity.throws) {
+			resolve(exception.description);
+		}
+
+		return result;
+	}
+} // namespace info
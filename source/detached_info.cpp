@@ -0,0 +1,248 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/DeclTemplate.h>
+#include <clang/Basic/SourceLocation.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Index/USRGeneration.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Casting.h>
+#include <ranges>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/info.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace stdr = std::ranges;
+namespace stdv = std::views;
+
+namespace info {
+	namespace {
+		/// Returns what introduces the template parameter ``decl`` in its template's parameter list,
+		/// such as ``typename``, ``std::size_t``, or ``template<class> class``.
+		[[nodiscard]] auto template_parameter_type(clang::NamedDecl const* const decl) -> std::string
+		{
+			auto result = std::string();
+			if (auto const type = llvm::dyn_cast<clang::TemplateTypeParmDecl>(decl)) {
+				result = type->wasDeclaredWithTypename() ? "typename" : "class";
+			}
+			else if (auto const value = llvm::dyn_cast<clang::NonTypeTemplateParmDecl>(decl)) {
+				result = value->getType().getAsString(decl->getASTContext().getPrintingPolicy());
+			}
+			else {
+				auto const& parameters =
+				  *llvm::cast<clang::TemplateTemplateParmDecl>(decl)->getTemplateParameters();
+				result = "template<";
+				for (auto i = 0u; i < parameters.size(); ++i) {
+					if (i != 0) {
+						result += ", ";
+					}
+
+					result += template_parameter_type(parameters.getParam(i));
+				}
+				result += "> class";
+			}
+
+			if (decl->isParameterPack()) {
+				result += "...";
+			}
+
+			return result;
+		}
+	} // namespace
+
+	detached_translation_unit::detached_translation_unit(
+	  std::string_view const main_file,
+	  string_interner& interner)
+	: interner_(&interner)
+	, main_file_(intern(main_file))
+	{}
+
+	auto detached_translation_unit::main_file() const noexcept -> std::string_view
+	{
+		return main_file_;
+	}
+
+	auto detached_translation_unit::entities() const noexcept -> std::span<detached_entity const>
+	{
+		return entities_;
+	}
+
+	auto detached_translation_unit::entities() noexcept -> std::span<detached_entity>
+	{
+		return entities_;
+	}
+
+	auto detached_translation_unit::interner() const noexcept -> string_interner&
+	{
+		return *interner_;
+	}
+
+	auto detached_translation_unit::intern(std::string_view const s) -> std::string_view
+	{
+		return interner_->intern(s).view();
+	}
+
+	auto detached_translation_unit::resolve_location(
+	  clang::SourceLocation const location,
+	  clang::SourceManager const& source_manager) -> detached_location
+	{
+		auto const presumed = source_manager.getPresumedLoc(location);
+		if (presumed.isInvalid()) {
+			return {};
+		}
+
+		return detached_location{
+		  .file = intern(presumed.getFilename()),
+		  .line = presumed.getLine(),
+		  .column = presumed.getColumn(),
+		};
+	}
+
+	auto detached_translation_unit::resolve_text(
+	  basic_info const& info,
+	  clang::SourceManager const& source_manager) -> detached_text
+	{
+		return detached_text{
+		  .description = intern(info.description()),
+		  .location = resolve_location(info.location(), source_manager),
+		};
+	}
+
+	auto detached_translation_unit::resolve_parameter(
+	  decl_info const& info,
+	  clang::SourceManager const& source_manager) -> detached_parameter
+	{
+		auto const decl = llvm::cast<clang::NamedDecl>(info.decl());
+		auto type = std::string();
+		if (llvm::isa<
+		      clang::TemplateTypeParmDecl,
+		      clang::NonTypeTemplateParmDecl,
+		      clang::TemplateTemplateParmDecl>(decl))
+		{
+			type = template_parameter_type(decl);
+		}
+		else if (auto const value = llvm::dyn_cast<clang::ValueDecl>(decl)) {
+			type = value->getType().getAsString(decl->getASTContext().getPrintingPolicy());
+		}
+
+		return detached_parameter{
+		  .name = intern(decl->getName()),
+		  .type = intern(type),
+		  .description = intern(info.description()),
+		  .location = resolve_location(info.location(), source_manager),
+		};
+	}
+
+	auto detached_translation_unit::resolve_exception(
+	  function_info::throws_info const& info,
+	  clang::SourceManager const& source_manager) -> detached_exception
+	{
+		auto usr = llvm::SmallString<128>();
+		if (info.type_decl() == nullptr or clang::index::generateUSRForDecl(info.type_decl(), usr)) {
+			usr.clear();
+		}
+
+		return detached_exception{
+		  .type = intern(info.type()),
+		  .type_usr = intern(usr.str()),
+		  .description = intern(info.description()),
+		  .location = resolve_location(info.location(), source_manager),
+		};
+	}
+
+	auto detached_translation_unit::detach(
+	  entity_info const& entity,
+	  clang::SourceManager const& source_manager) -> detached_entity const&
+	{
+		auto const decl = llvm::cast<clang::NamedDecl>(entity.decl());
+		auto usr = llvm::SmallString<128>();
+		if (clang::index::generateUSRForDecl(decl, usr)) {
+			usr.clear();
+		}
+
+		auto result = detached_entity{
+		  .usr = intern(usr.str()),
+		  .name = intern(decl->getNameAsString()),
+		  .qualified_name = intern(decl->getQualifiedNameAsString()),
+		  .location = resolve_location(decl->getLocation(), source_manager),
+		  .documentation = resolve_text(entity, source_manager),
+		  .headers = entity.headers()
+		           | stdv::transform(&decl_info::header_info::name)
+		           | stdr::to<std::vector>(),
+		  .modules = entity.modules()
+		           | stdv::transform(&decl_info::module_info::name)
+		           | stdr::to<std::vector>(),
+		  .content_hash = entity.content_hash(),
+		};
+
+		if (auto const* record = llvm::dyn_cast<record_info>(&entity)) {
+			result.type = intern(record->record()->getKindName());
+			if (auto const* class_template = llvm::dyn_cast<class_template_info>(record)) {
+				result.kind = detached_entity::entity_kind::class_template;
+				result.template_parameters =
+				  class_template->template_parameters()
+				  | stdv::transform([this, &source_manager](template_parameter_info const& p) {
+					    return resolve_parameter(p, source_manager);
+				    })
+				  | stdr::to<std::vector>();
+			}
+			else {
+				result.kind = detached_entity::entity_kind::record;
+			}
+
+			return insert(std::move(result));
+		}
+
+		auto const resolve = [this, &source_manager](auto const& info) {
+			return resolve_text(info, source_manager);
+		};
+
+		if (auto const* const function = llvm::dyn_cast<function_info>(&entity)) {
+			if (auto const base = function->inherits_from()) {
+				auto base_usr = llvm::SmallString<128>();
+				if (not clang::index::generateUSRForDecl(base, base_usr)) {
+					result.inherits_from = intern(base_usr.str());
+				}
+			}
+
+			auto const function_decl = decl->getAsFunction();
+			result.type =
+			  intern(function_decl->getType().getAsString(decl->getASTContext().getPrintingPolicy()));
+			result.parameters =
+			  function->parameters()
+			  | stdv::transform([this, &source_manager](parameter_info const& p) {
+				    return resolve_parameter(p, source_manager);
+			    })
+			  | stdr::to<std::vector>();
+			if (function->returns().has_value()) {
+				result.returns = resolve(*function->returns());
+			}
+
+			result.preconditions =
+			  function->preconditions() | stdv::transform(resolve) | stdr::to<std::vector>();
+			result.postconditions =
+			  function->postconditions() | stdv::transform(resolve) | stdr::to<std::vector>();
+			result.throws =
+			  function->throws()
+			  | stdv::transform([this, &source_manager](function_info::throws_info const& t) {
+				    return resolve_exception(t, source_manager);
+			    })
+			  | stdr::to<std::vector>();
+			result.exits_via = function->exits_via() | stdv::transform(resolve) | stdr::to<std::vector>();
+		}
+
+		return insert(std::move(result));
+	}
+
+	auto detached_translation_unit::insert(detached_entity entity) -> detached_entity const&
+	{
+		return entities_.emplace_back(std::move(entity));
+	}
+} // namespace info
@@ -7,17 +7,26 @@
 namespace diag {
 	using clang::diag::Severity; // NOLINT(misc-include-cleaner)
 
-	void add_diagnostics(clang::DiagnosticsEngine& engine)
+	auto add_diagnostics(clang::DiagnosticsEngine& engine) -> bool
 	{
+		// Custom diagnostics are numbered in the order that they're first added, starting at
+		// ``DIAG_UPPER_LIMIT``, which is what ``diag::id`` assumes.
+		auto matches = true;
+
 		// clang-format off
 #define DIAG(ENUM, FLAGS, SEVERITY, DESC, GROUP, SFINAE, NOWERROR,                              \
              SHOWINSYSHEADER, SHOWINSYSMACRO, DEFERRABLE, CATEGORY)                             \
-		engine.getCustomDiagID(static_cast<clang::DiagnosticsEngine::Level>(SEVERITY), DESC);
+		if (engine.getCustomDiagID(static_cast<clang::DiagnosticsEngine::Level>(SEVERITY), DESC)  \
+		    != static_cast<unsigned>(ENUM)) {                                                   \
+			matches = false;                                                                      \
+		}
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 #include "diagnostics/DiagnosticLexKinds.inc" // NOLINT(misc-include-cleaner)
 #pragma GCC diagnostic pop
 #undef DIAG
 		// clang-format on
+
+		return matches;
 	}
 } // namespace diag
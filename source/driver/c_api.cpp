@@ -0,0 +1,430 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <cassert>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <deque>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <schreiber/cross_references.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/schreiber.h>
+#include <schreiber/string_interner.hpp>
+#include <schreiber/worker_pool.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct schreiber_session {
+	std::vector<clang::tooling::CompileCommand> queued;
+
+	/// Holds the strings of every translation unit in ``results``, so that they're freed with the
+	/// session rather than kept for the life of the process. It's declared before ``results`` so
+	/// that it outlives them.
+	info::string_interner interner;
+
+	/// Translation units are never moved once they've been extracted, so that their handles stay
+	/// valid across runs.
+	std::deque<driver::translation_unit_result> results;
+	absl::flat_hash_map<std::string, std::string> buffers;
+	std::string last_error;
+
+	[[nodiscard]] auto fail(schreiber_status const status, std::string message) -> schreiber_status
+	{
+		last_error = std::move(message);
+		return status;
+	}
+};
+
+namespace {
+	namespace tooling = clang::tooling;
+
+	[[nodiscard]] auto to_c(std::string_view const s) noexcept -> schreiber_string
+	{
+		return {.data = s.data(), .size = s.size()};
+	}
+
+	[[nodiscard]] auto to_c(info::detached_location const& location) noexcept -> schreiber_location
+	{
+		return {.file = to_c(location.file), .line = location.line, .column = location.column};
+	}
+
+	[[nodiscard]] auto to_c(info::detached_text const& text) noexcept -> schreiber_directive
+	{
+		return {.description = to_c(text.description), .location = to_c(text.location)};
+	}
+
+	[[nodiscard]] auto to_c(info::detached_parameter const& parameter) noexcept
+	  -> schreiber_directive
+	{
+		return {
+		  .name = to_c(parameter.name),
+		  .type = to_c(parameter.type),
+		  .description = to_c(parameter.description),
+		  .location = to_c(parameter.location),
+		};
+	}
+
+	[[nodiscard]] auto to_c(info::detached_exception const& exception) noexcept
+	  -> schreiber_directive
+	{
+		return {
+		  .type = to_c(exception.type),
+		  .usr = to_c(exception.type_usr),
+		  .description = to_c(exception.description),
+		  .location = to_c(exception.location),
+		};
+	}
+
+	[[nodiscard]] auto to_c(info::detached_reference const& reference) noexcept
+	  -> schreiber_directive
+	{
+		return {.name = to_c(reference.name), .usr = to_c(reference.usr)};
+	}
+
+	[[nodiscard]] auto to_c(info::interned_string const name) noexcept -> schreiber_directive
+	{
+		return {.name = to_c(name.view())};
+	}
+
+	[[nodiscard]] auto to_c(driver::translation_unit_result const* const unit) noexcept
+	  -> schreiber_translation_unit const*
+	{
+		return reinterpret_cast<schreiber_translation_unit const*>(unit);
+	}
+
+	[[nodiscard]] auto from_c(schreiber_translation_unit const* const unit) noexcept
+	  -> driver::translation_unit_result const&
+	{
+		assert(unit != nullptr);
+		return *reinterpret_cast<driver::translation_unit_result const*>(unit);
+	}
+
+	[[nodiscard]] auto from_c(schreiber_entity const* const entity) noexcept
+	  -> info::detached_entity const&
+	{
+		assert(entity != nullptr);
+		return *reinterpret_cast<info::detached_entity const*>(entity);
+	}
+
+	/// Returns a file system that reads ``buffers`` in place of the files that they're named after.
+	[[nodiscard]] auto overlay(absl::flat_hash_map<std::string, std::string> const& buffers)
+	  -> llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>
+	{
+		auto const real = llvm::vfs::getRealFileSystem();
+		if (buffers.empty()) {
+			return real;
+		}
+
+		auto memory = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+		for (auto const& [path, contents] : buffers) {
+			memory->addFile(path, 0, llvm::MemoryBuffer::getMemBuffer(contents, path));
+		}
+
+		auto result = llvm::makeIntrusiveRefCnt<llvm::vfs::OverlayFileSystem>(real);
+		result->pushOverlay(std::move(memory));
+		return result;
+	}
+
+	/// Calls ``f`` with a span of ``entity``'s directives of kind ``kind``.
+	template<class F>
+	auto with_directives(
+	  info::detached_entity const& entity,
+	  schreiber_directive_kind const kind,
+	  F f)
+	{
+		switch (kind) {
+		case SCHREIBER_DIRECTIVE_TEMPLATE_PARAMETER:
+			return f(std::span(entity.template_parameters));
+		case SCHREIBER_DIRECTIVE_PARAMETER:
+			return f(std::span(entity.parameters));
+		case SCHREIBER_DIRECTIVE_PRECONDITION:
+			return f(std::span(entity.preconditions));
+		case SCHREIBER_DIRECTIVE_POSTCONDITION:
+			return f(std::span(entity.postconditions));
+		case SCHREIBER_DIRECTIVE_THROWS:
+			return f(std::span(entity.throws));
+		case SCHREIBER_DIRECTIVE_EXITS_VIA:
+			return f(std::span(entity.exits_via));
+		case SCHREIBER_DIRECTIVE_HEADER:
+			return f(std::span(entity.headers));
+		case SCHREIBER_DIRECTIVE_MODULE:
+			return f(std::span(entity.modules));
+		case SCHREIBER_DIRECTIVE_REFERENCE:
+			return f(std::span(entity.references));
+		}
+
+		// The kind came from C, so it might not be one of the enumerators.
+		return f(std::span<info::detached_text const>());
+	}
+} // namespace
+
+extern "C" {
+unsigned schreiber_api_version(void)
+{
+	return SCHREIBER_API_VERSION;
+}
+
+schreiber_session* schreiber_session_create(void)
+{
+	return new schreiber_session();
+}
+
+void schreiber_session_destroy(schreiber_session* const session)
+{
+	delete session;
+}
+
+schreiber_string schreiber_session_last_error(schreiber_session const* const session)
+{
+	return to_c(session->last_error);
+}
+
+schreiber_status schreiber_session_add_file(
+  schreiber_session* const session,
+  char const* const directory,
+  char const* const file,
+  char const* const* const arguments,
+  std::size_t const argument_count)
+{
+	if (directory == nullptr or file == nullptr or (arguments == nullptr and argument_count != 0)) {
+		return session->fail(SCHREIBER_INVALID_ARGUMENT, "expected a directory and a file");
+	}
+
+	auto command_line = std::vector<std::string>(arguments, arguments + argument_count);
+	if (command_line.empty()) {
+		command_line = {"clang++", file};
+	}
+
+	session->queued.emplace_back(directory, file, std::move(command_line), "");
+	return SCHREIBER_OK;
+}
+
+schreiber_status schreiber_session_add_compilation_database(
+  schreiber_session* const session,
+  char const* const build_directory)
+{
+	if (build_directory == nullptr) {
+		return session->fail(SCHREIBER_INVALID_ARGUMENT, "expected a build directory");
+	}
+
+	auto error = std::string();
+	auto const database = tooling::CompilationDatabase::loadFromDirectory(build_directory, error);
+	if (database == nullptr) {
+		return session->fail(SCHREIBER_INVALID_ARGUMENT, std::move(error));
+	}
+
+	for (auto& command : database->getAllCompileCommands()) {
+		session->queued.push_back(std::move(command));
+	}
+
+	return SCHREIBER_OK;
+}
+
+schreiber_status schreiber_session_add_buffer(
+  schreiber_session* const session,
+  char const* const path,
+  char const* const contents,
+  std::size_t const size)
+{
+	if (path == nullptr or not llvm::sys::path::is_absolute(path)) {
+		return session->fail(SCHREIBER_INVALID_ARGUMENT, "buffers need an absolute path");
+	}
+
+	if (contents == nullptr and size != 0) {
+		return session->fail(SCHREIBER_INVALID_ARGUMENT, "expected the buffer's contents");
+	}
+
+	session->buffers.insert_or_assign(path, std::string(contents, size));
+	return SCHREIBER_OK;
+}
+
+schreiber_status schreiber_session_run(schreiber_session* const session, unsigned const jobs)
+{
+	// The buffers might have changed since the last run, so the file system is rebuilt each time.
+	auto const file_system = overlay(session->buffers);
+	auto results = driver::run_in_process(
+	  session->queued,
+	  {
+	    .jobs = std::max(jobs, 1u),
+	    .file_system = file_system.get(),
+	    .interner = &session->interner,
+	  });
+	session->queued.clear();
+
+	auto failed = std::size_t{0};
+	for (auto& result : results) {
+		if (result.status != driver::translation_unit_result::status_t::ok) {
+			++failed;
+		}
+
+		session->results.push_back(std::move(result));
+	}
+
+	// Entities from earlier runs can mention entities from this one, so every reference is
+	// resolved again.
+	auto symbols = info::symbol_table();
+	for (auto const& result : session->results) {
+		for (auto const& entity : result.unit.entities()) {
+			symbols.add(entity);
+		}
+	}
+
+	for (auto& result : session->results) {
+		for (auto& entity : result.unit.entities()) {
+			entity.references = info::resolve_references(entity, symbols);
+		}
+	}
+
+	if (failed != 0) {
+		return session->fail(
+		  SCHREIBER_FAILED,
+		  std::to_string(failed) + " of " + std::to_string(results.size())
+		    + " translation units failed; see their diagnostics");
+	}
+
+	return SCHREIBER_OK;
+}
+
+std::size_t schreiber_session_translation_unit_count(schreiber_session const* const session)
+{
+	return session->results.size();
+}
+
+schreiber_translation_unit const*
+schreiber_session_translation_unit(schreiber_session const* const session, std::size_t const index)
+{
+	assert(index < session->results.size());
+	return to_c(&session->results[index]);
+}
+
+schreiber_string schreiber_translation_unit_file(schreiber_translation_unit const* const unit)
+{
+	return to_c(from_c(unit).file);
+}
+
+schreiber_translation_unit_status
+schreiber_translation_unit_get_status(schreiber_translation_unit const* const unit)
+{
+	using status_t = driver::translation_unit_result::status_t;
+	switch (from_c(unit).status) {
+	case status_t::ok:
+		return SCHREIBER_TRANSLATION_UNIT_OK;
+	case status_t::failed:
+		return SCHREIBER_TRANSLATION_UNIT_FAILED;
+	case status_t::crashed:
+		return SCHREIBER_TRANSLATION_UNIT_CRASHED;
+	case status_t::timed_out:
+		return SCHREIBER_TRANSLATION_UNIT_TIMED_OUT;
+	}
+}
+
+schreiber_string
+schreiber_translation_unit_diagnostics(schreiber_translation_unit const* const unit)
+{
+	return to_c(from_c(unit).diagnostics);
+}
+
+std::size_t schreiber_translation_unit_entity_count(schreiber_translation_unit const* const unit)
+{
+	return from_c(unit).unit.entities().size();
+}
+
+schreiber_entity const* schreiber_translation_unit_entity(
+  schreiber_translation_unit const* const unit,
+  std::size_t const index)
+{
+	auto const entities = from_c(unit).unit.entities();
+	assert(index < entities.size());
+	return reinterpret_cast<schreiber_entity const*>(&entities[index]);
+}
+
+schreiber_entity_kind schreiber_entity_get_kind(schreiber_entity const* const entity)
+{
+	switch (from_c(entity).kind) {
+	case info::detached_entity::entity_kind::function:
+		return SCHREIBER_ENTITY_FUNCTION;
+	case info::detached_entity::entity_kind::function_template:
+		return SCHREIBER_ENTITY_FUNCTION_TEMPLATE;
+	case info::detached_entity::entity_kind::record:
+		return SCHREIBER_ENTITY_RECORD;
+	case info::detached_entity::entity_kind::class_template:
+		return SCHREIBER_ENTITY_CLASS_TEMPLATE;
+	}
+}
+
+schreiber_string schreiber_entity_usr(schreiber_entity const* const entity)
+{
+	return to_c(from_c(entity).usr);
+}
+
+schreiber_string schreiber_entity_name(schreiber_entity const* const entity)
+{
+	return to_c(from_c(entity).name);
+}
+
+schreiber_string schreiber_entity_qualified_name(schreiber_entity const* const entity)
+{
+	return to_c(from_c(entity).qualified_name);
+}
+
+schreiber_string schreiber_entity_type(schreiber_entity const* const entity)
+{
+	return to_c(from_c(entity).type);
+}
+
+schreiber_location schreiber_entity_location(schreiber_entity const* const entity)
+{
+	return to_c(from_c(entity).location);
+}
+
+schreiber_string schreiber_entity_inherits_from(schreiber_entity const* const entity)
+{
+	return to_c(from_c(entity).inherits_from);
+}
+
+schreiber_directive schreiber_entity_documentation(schreiber_entity const* const entity)
+{
+	return to_c(from_c(entity).documentation);
+}
+
+int
+schreiber_entity_returns(schreiber_entity const* const entity, schreiber_directive* const result)
+{
+	auto const& returns = from_c(entity).returns;
+	if (not returns.has_value()) {
+		return 0;
+	}
+
+	*result = to_c(*returns);
+	return 1;
+}
+
+std::size_t schreiber_entity_directive_count(
+  schreiber_entity const* const entity,
+  schreiber_directive_kind const kind)
+{
+	return with_directives(from_c(entity), kind, [](auto const directives) {
+		return directives.size();
+	});
+}
+
+schreiber_directive schreiber_entity_directive(
+  schreiber_entity const* const entity,
+  schreiber_directive_kind const kind,
+  std::size_t const index)
+{
+	return with_directives(from_c(entity), kind, [index](auto const directives) {
+		assert(index < directives.size());
+		return to_c(directives[index]);
+	});
+}
+} // extern "C"
@@ -0,0 +1,255 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <expected>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Path.h>
+#include <optional>
+#include <ranges>
+#include <schreiber/changed_lines.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace stdr = std::ranges;
+
+	namespace {
+		[[nodiscard]] auto parse_number(std::string_view& text) -> std::optional<unsigned>
+		{
+			auto value = 0u;
+			auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+			if (error != std::errc()) {
+				return std::nullopt;
+			}
+
+			text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+			return value;
+		}
+
+		struct hunk_range {
+			unsigned start = 0;
+			unsigned count = 1;
+		};
+
+		/// Reads one side of a hunk header, which looks like ``-start,count`` or ``+start,count``. A
+		/// missing count means that the hunk covers a single line.
+		[[nodiscard]] auto parse_hunk_range(std::string_view& text, char const sign)
+		  -> std::optional<hunk_range>
+		{
+			if (not text.starts_with(sign)) {
+				return std::nullopt;
+			}
+
+			text.remove_prefix(1);
+			auto result = hunk_range();
+			if (auto const start = parse_number(text)) {
+				result.start = *start;
+			}
+			else {
+				return std::nullopt;
+			}
+
+			if (text.starts_with(',')) {
+				text.remove_prefix(1);
+				auto const count = parse_number(text);
+				if (not count.has_value()) {
+					return std::nullopt;
+				}
+
+				result.count = *count;
+			}
+
+			return result;
+		}
+
+		/// Returns the path in a ``---`` or ``+++`` line.
+		[[nodiscard]] auto header_path(std::string_view line) -> std::string_view
+		{
+			line.remove_prefix(4);
+
+			// Some tools follow the path with a tab and a timestamp.
+			return line.substr(0, line.find('\t'));
+		}
+
+		void merge(std::vector<line_range>& ranges)
+		{
+			stdr::sort(ranges, {}, &line_range::first);
+			auto merged = std::vector<line_range>();
+			for (auto const range : ranges) {
+				if (not merged.empty() and range.first <= merged.back().last + 1) {
+					merged.back().last = std::max(merged.back().last, range.last);
+				}
+				else {
+					merged.push_back(range);
+				}
+			}
+
+			ranges = std::move(merged);
+		}
+	} // namespace
+
+	auto changed_lines::parse(std::string_view diff, std::string_view const root)
+	  -> std::expected<changed_lines, std::string>
+	{
+		auto result = changed_lines();
+		auto current = static_cast<std::vector<line_range>*>(nullptr);
+		auto has_file = false;
+		auto old_has_prefix = false;
+		auto old_remaining = 0u;
+		auto new_remaining = 0u;
+		auto line = 0u;
+		auto line_number = std::size_t{0};
+		auto const error = [&line_number](std::string_view const message) {
+			return std::unexpected(
+			  "line " + std::to_string(line_number) + " of the diff " + std::string(message));
+		};
+
+		while (not diff.empty()) {
+			++line_number;
+			auto const newline = diff.find('\n');
+			auto text = diff.substr(0, newline);
+			diff.remove_prefix(newline == std::string_view::npos ? diff.size() : newline + 1);
+			if (text.ends_with('\r')) {
+				text.remove_suffix(1);
+			}
+
+			if (old_remaining > 0 or new_remaining > 0) {
+				// Some tools strip the space from blank context lines.
+				switch (text.empty() ? ' ' : text.front()) {
+				case ' ':
+					if (old_remaining == 0 or new_remaining == 0) {
+						return error("has more context than its hunk header says");
+					}
+
+					--old_remaining;
+					--new_remaining;
+					++line;
+					break;
+				case '+':
+					if (new_remaining == 0) {
+						return error("adds more lines than its hunk header says");
+					}
+
+					if (current != nullptr) {
+						current->push_back({line, line});
+					}
+
+					--new_remaining;
+					++line;
+					break;
+				case '-':
+					if (old_remaining == 0) {
+						return error("removes more lines than its hunk header says");
+					}
+
+					if (current != nullptr) {
+						current->push_back({std::max(line - 1, 1u), line});
+					}
+
+					--old_remaining;
+					break;
+				case '\\':
+					// "\ No newline at end of file"
+					break;
+				default:
+					return error("ends a hunk early");
+				}
+
+				continue;
+			}
+
+			if (text.starts_with("--- ")) {
+				auto const path = header_path(text);
+				old_has_prefix = path.starts_with("a/") or path == "/dev/null";
+				continue;
+			}
+
+			if (text.starts_with("+++ ")) {
+				has_file = true;
+				auto path = header_path(text);
+				if (path == "/dev/null") {
+					current = nullptr;
+					continue;
+				}
+
+				if (old_has_prefix and path.starts_with("b/")) {
+					path.remove_prefix(2);
+				}
+
+				auto absolute = llvm::SmallString<256>(root);
+				llvm::sys::path::append(absolute, path);
+				llvm::sys::path::remove_dots(absolute, /*remove_dot_dot=*/true);
+				current = &result.ranges_[absolute.str().str()];
+				continue;
+			}
+
+			if (text.starts_with("@@ ")) {
+				if (not has_file) {
+					return error("has a hunk before any file header");
+				}
+
+				text.remove_prefix(3);
+				auto const old_range = parse_hunk_range(text, '-');
+				if (not old_range.has_value() or not text.starts_with(' ')) {
+					return error("isn't a valid hunk header");
+				}
+
+				text.remove_prefix(1);
+				auto const new_range = parse_hunk_range(text, '+');
+				if (not new_range.has_value() or not text.starts_with(" @@")) {
+					return error("isn't a valid hunk header");
+				}
+
+				old_remaining = old_range->count;
+				new_remaining = new_range->count;
+
+				// A hunk that only removes lines starts at the line before the ones that were removed.
+				line = new_range->count == 0 ? new_range->start + 1 : new_range->start;
+			}
+		}
+
+		if (old_remaining > 0 or new_remaining > 0) {
+			return error("ends in the middle of a hunk");
+		}
+
+		for (auto& [file, ranges] : result.ranges_) {
+			merge(ranges);
+		}
+
+		return result;
+	}
+
+	auto changed_lines::find(std::string_view const file) const -> std::span<line_range const>
+	{
+		auto const i = ranges_.find(std::string(file));
+		return i != ranges_.end() ? std::span<line_range const>(i->second) : std::span<line_range const>();
+	}
+
+	auto changed_lines::overlaps(std::string_view const file, line_range const lines) const -> bool
+	{
+		auto const ranges = find(file);
+		auto const i = stdr::lower_bound(ranges, lines.first, {}, &line_range::last);
+		return i != ranges.end() and i->first <= lines.last;
+	}
+
+	auto changed_lines::files() const -> std::vector<std::string_view>
+	{
+		auto result = std::vector<std::string_view>();
+		result.reserve(ranges_.size());
+		for (auto const& [file, ranges] : ranges_) {
+			if (not ranges.empty()) {
+				result.push_back(file);
+			}
+		}
+
+		stdr::sort(result);
+		return result;
+	}
+} // namespace driver
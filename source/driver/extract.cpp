@@ -0,0 +1,294 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclFriend.h>
+#include <clang/AST/DeclGroup.h>
+#include <clang/AST/DeclTemplate.h>
+#include <clang/ASTMatchers/ASTMatchFinder.h>
+#include <clang/ASTMatchers/ASTMatchers.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/SourceLocation.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <optional>
+#include <schreiber/cancellation.hpp>
+#include <schreiber/changed_lines.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/diagnostic_ids.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/info.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <schreiber/parser.hpp>
+#include <schreiber/prebuilt.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace ast_matchers = clang::ast_matchers;
+
+	auto documentable_decls(clang::ASTContext& context) -> std::vector<clang::NamedDecl const*>
+	{
+		using ast_matchers::allOf;
+		using ast_matchers::anyOf;
+		using ast_matchers::decl;
+		using ast_matchers::friendDecl;
+		using ast_matchers::hasParent;
+		using ast_matchers::isImplicit;
+		using ast_matchers::isPrivate;
+		using ast_matchers::namedDecl;
+		using ast_matchers::namespaceDecl;
+		using ast_matchers::recordDecl;
+		using ast_matchers::translationUnitDecl;
+		using ast_matchers::unless;
+
+		auto const matches = ast_matchers::match(
+		  decl(
+		    anyOf(
+		      namedDecl(allOf(
+		        anyOf(hasParent(translationUnitDecl()), hasParent(namespaceDecl()), hasParent(recordDecl())),
+		        unless(anyOf(isImplicit(), isPrivate())))),
+		      friendDecl()))
+		    .bind("root"),
+		  context);
+
+		auto result = std::vector<clang::NamedDecl const*>();
+		result.reserve(matches.size());
+		for (auto const& i : matches) {
+			if (auto const named_decl = i.getNodeAs<clang::NamedDecl>("root")) {
+				result.push_back(named_decl);
+				continue;
+			}
+
+			auto const friend_decl = i.getNodeAs<clang::FriendDecl>("root");
+			auto const named_decl = friend_decl != nullptr ? friend_decl->getFriendDecl() : nullptr;
+			if (named_decl == nullptr) {
+				continue;
+			}
+
+			if (named_decl->hasBody()) {
+				result.push_back(named_decl);
+			}
+			else if (auto const function_template = llvm::dyn_cast<clang::FunctionTemplateDecl>(named_decl);
+			         function_template and function_template->getAsFunction()->hasBody())
+			{
+				result.push_back(named_decl);
+			}
+		}
+
+		return result;
+	}
+
+	auto absolute_path(clang::SourceManager const& source_manager, clang::FileID const file)
+	  -> std::string
+	{
+		auto const entry = source_manager.getFileEntryRefForID(file);
+		if (not entry.has_value()) {
+			return {};
+		}
+
+		if (auto const real_path = entry->getFileEntry().tryGetRealPathName(); not real_path.empty()) {
+			return real_path.str();
+		}
+
+		auto path = llvm::SmallString<256>(entry->getName());
+		source_manager.getFileManager().makeAbsolutePath(path);
+		llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/true);
+		return path.str().str();
+	}
+
+	namespace {
+		/// Decides whether a declaration overlaps a changed line. Each file's path is only looked up
+		/// once, since most declarations share a handful of files.
+		class change_filter {
+		public:
+			change_filter(clang::ASTContext& context, changed_lines const& changed) noexcept
+			: context_(&context)
+			, changed_(&changed)
+			{}
+
+			[[nodiscard]] auto overlaps(clang::NamedDecl const* const decl) -> bool
+			{
+				if (overlaps(decl->getSourceRange())) {
+					return true;
+				}
+
+				auto const comment = context_->getRawCommentForDeclNoCache(decl);
+				return comment != nullptr and overlaps(comment->getSourceRange());
+			}
+		private:
+			clang::ASTContext* context_;
+			changed_lines const* changed_;
+			llvm::DenseMap<clang::FileID, std::string> paths_;
+
+			[[nodiscard]] auto overlaps(clang::SourceRange const range) -> bool
+			{
+				auto const& source_manager = context_->getSourceManager();
+				auto const begin = source_manager.getExpansionLoc(range.getBegin());
+				if (begin.isInvalid()) {
+					return false;
+				}
+
+				auto const file = source_manager.getFileID(begin);
+				auto const [i, inserted] = paths_.try_emplace(file);
+				if (inserted) {
+					i->second = absolute_path(source_manager, file);
+				}
+
+				auto const end = source_manager.getExpansionLoc(range.getEnd());
+				auto const first = source_manager.getExpansionLineNumber(begin);
+				auto const last = end.isValid() and source_manager.getFileID(end) == file
+				                  ? source_manager.getExpansionLineNumber(end)
+				                  : first;
+				return changed_->overlaps(i->second, line_range{first, last});
+			}
+		};
+	} // namespace
+
+	void extract(
+	  clang::ASTContext& context,
+	  info::detached_translation_unit& result,
+	  extract_options const& options)
+	{
+		auto& diagnostics = context.getDiagnostics();
+		if (not diag::add_diagnostics(diagnostics)) {
+			auto const id = diagnostics.getCustomDiagID(
+			  clang::DiagnosticsEngine::Error,
+			  "unable to extract documentation: schreiber's diagnostics can't be registered after "
+			  "another diagnostic was registered");
+			diagnostics.Report(id);
+			return;
+		}
+
+		auto filter = std::optional<change_filter>();
+		if (options.changed != nullptr) {
+			filter.emplace(context, *options.changed);
+		}
+
+		// Remembers whether another translation unit already extracted each file whose declarations
+		// were loaded from an AST file. The files that this translation unit extracts are only claimed
+		// once it's finished, in case it's cancelled first.
+		auto const& source_manager = context.getSourceManager();
+		auto claimed = llvm::DenseMap<clang::FileID, bool>();
+		auto claims = std::vector<std::string>();
+		auto const is_claimed = [&](clang::NamedDecl const* const decl) {
+			auto const location = source_manager.getExpansionLoc(decl->getLocation());
+			auto const file = source_manager.getFileID(location);
+			auto const [i, inserted] = claimed.try_emplace(file);
+			if (inserted) {
+				auto path = absolute_path(source_manager, file);
+				i->second = options.prebuilt->is_claimed(path);
+				if (not i->second) {
+					claims.push_back(std::move(path));
+				}
+			}
+
+			return i->second;
+		};
+
+		auto p = parser::parser(context, result.interner());
+		for (auto const decl : documentable_decls(context)) {
+			if (options.cancel != nullptr and options.cancel->is_cancelled()) {
+				return;
+			}
+
+			if (options.prebuilt != nullptr and decl->isFromASTFile() and not is_claimed(decl)) {
+				continue;
+			}
+
+			if (filter.has_value()) {
+				if (not filter->overlaps(decl)) {
+					continue;
+				}
+
+				// The parser only knows that a declaration is documented if it's seen a documented
+				// redeclaration, and that redeclaration might not have changed.
+				if (context.getRawCommentForDeclNoCache(decl) == nullptr
+				    and context.getRawCommentForAnyRedecl(decl) != nullptr)
+				{
+					continue;
+				}
+			}
+
+			auto const info = p.parse(decl);
+			if (auto const entity = llvm::dyn_cast_if_present<info::entity_info>(info.get())) {
+				if (options.memory != nullptr) {
+					options.memory->record(*entity);
+				}
+
+				result.detach(*entity, source_manager);
+			}
+		}
+
+		if (options.prebuilt != nullptr) {
+			options.prebuilt->claim(claims);
+		}
+	}
+
+	extract_consumer::extract_consumer(
+	  translation_unit_result& result,
+	  extract_options const options) noexcept
+	: result_(&result)
+	, options_(options)
+	{}
+
+	void extract_consumer::Initialize(clang::ASTContext& context)
+	{
+		context_ = &context;
+	}
+
+	auto extract_consumer::HandleTopLevelDecl(clang::DeclGroupRef) -> bool
+	{
+		if (options_.cancel == nullptr or not options_.cancel->is_cancelled()) {
+			return true;
+		}
+
+		// Returning false stops the parser, so HandleTranslationUnit won't be called. Everything
+		// that's been parsed so far is extracted now instead, so that it's kept, which means that
+		// this pass can't be cancelled.
+		auto options = options_;
+		options.cancel = nullptr;
+		extract_parsed(*context_, options);
+		return false;
+	}
+
+	void extract_consumer::HandleTranslationUnit(clang::ASTContext& context)
+	{
+		extract_parsed(context, options_);
+	}
+
+	void extract_consumer::extract_parsed(clang::ASTContext& context, extract_options options)
+	{
+		if (context.getDiagnostics().hasUncompilableErrorOccurred()) {
+			return;
+		}
+
+		options.memory = &result_->memory;
+		extract(context, result_->unit, options);
+		result_->ast_bytes = context.getASTAllocatedMemory() + context.getSideTableAllocatedMemory();
+		result_->memory.record(context, options.cache);
+	}
+
+	extract_action::extract_action(
+	  translation_unit_result& result,
+	  extract_options const options) noexcept
+	: result_(&result)
+	, options_(options)
+	{}
+
+	auto extract_action::CreateASTConsumer(clang::CompilerInstance&, llvm::StringRef)
+	  -> std::unique_ptr<clang::ASTConsumer>
+	{
+		return std::make_unique<extract_consumer>(*result_, options_);
+	}
+} // namespace driver
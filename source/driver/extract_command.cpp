@@ -0,0 +1,99 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <chrono>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/FileSystemOptions.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <schreiber/cancellation.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/prebuilt.hpp>
+#include <schreiber/string_interner.hpp>
+#include <utility>
+
+// Extracting a translation unit from its compile command needs clangTooling, which is kept apart
+// from the rest of extract.cpp so that the compiler plugin can be built without it.
+namespace driver {
+	namespace tooling = clang::tooling;
+
+	auto extract(
+	  tooling::CompileCommand const& command,
+	  file_cache& cache,
+	  extract_options const& options) -> translation_unit_result
+	{
+		auto const start = std::chrono::steady_clock::now();
+		auto result = translation_unit_result{
+		  .file = command.Filename,
+		  .unit = info::detached_translation_unit(
+		    command.Filename,
+		    options.interner != nullptr ? *options.interner : info::string_interner::global()),
+		};
+
+		// Each translation unit gets its own working directory, rather than changing the process's,
+		// so that translation units can be extracted concurrently.
+		auto const file_system = make_caching_file_system(
+		  cache,
+		  options.file_system != nullptr ? llvm::IntrusiveRefCntPtr(options.file_system)
+		                                 : llvm::vfs::getRealFileSystem());
+		file_system->setCurrentWorkingDirectory(command.Directory);
+		auto const files =
+		  llvm::makeIntrusiveRefCnt<clang::FileManager>(clang::FileSystemOptions(), file_system);
+
+		auto const adjust = tooling::combineAdjusters(
+		  tooling::getClangSyntaxOnlyAdjuster(),
+		  tooling::combineAdjusters(
+		    tooling::getClangStripOutputAdjuster(),
+		    tooling::getClangStripDependencyFileAdjuster()));
+
+		auto arguments = adjust(command.CommandLine, command.Filename);
+		if (options.prebuilt != nullptr) {
+			arguments = options.prebuilt->adjust(arguments, command.Directory, result.diagnostics);
+		}
+
+		{
+			auto diagnostics = llvm::raw_string_ostream(result.diagnostics);
+			auto diagnostic_options = llvm::makeIntrusiveRefCnt<clang::DiagnosticOptions>();
+			auto printer = clang::TextDiagnosticPrinter(diagnostics, diagnostic_options.get());
+
+			auto action_options = options;
+			action_options.cache = &cache;
+			auto invocation = tooling::ToolInvocation(
+			  std::move(arguments),
+			  std::make_unique<extract_action>(result, action_options),
+			  files.get());
+			invocation.setDiagnosticConsumer(&printer);
+			if (not invocation.run()) {
+				result.status = translation_unit_result::status_t::failed;
+			}
+
+			if (options.cancel != nullptr and options.cancel->is_cancelled()) {
+				result.status = translation_unit_result::status_t::timed_out;
+				diagnostics << "error: timed out while extracting '" << command.Filename
+				            << "'; keeping the " << result.unit.entities().size()
+				            << " entities extracted so far\n";
+			}
+		}
+
+		result.memory.record(result.unit);
+		result.memory.record_diagnostics(result.diagnostics.capacity());
+		result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		  std::chrono::steady_clock::now() - start);
+		return result;
+	}
+
+	auto extract(tooling::CompileCommand const& command) -> translation_unit_result
+	{
+		auto cache = file_cache();
+		return extract(command, cache, extract_options());
+	}
+} // namespace driver
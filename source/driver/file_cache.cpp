@@ -0,0 +1,320 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/hash/hash.h>
+#include <cstddef>
+#include <cstdint>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <schreiber/file_cache.hpp>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace driver {
+	namespace vfs = llvm::vfs;
+
+	namespace {
+		/// A file whose contents are owned by a ``file_cache``.
+		class cached_file final : public vfs::File {
+		public:
+			cached_file(vfs::Status status, llvm::MemoryBuffer const& contents)
+			: status_(std::move(status))
+			, contents_(&contents)
+			{}
+
+			auto status() -> llvm::ErrorOr<vfs::Status> override
+			{
+				return status_;
+			}
+
+			auto getName() -> llvm::ErrorOr<std::string> override
+			{
+				return status_.getName().str();
+			}
+
+			auto getBuffer(
+			  llvm::Twine const& name,
+			  std::int64_t,
+			  bool const requires_null_terminator,
+			  bool) -> llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> override
+			{
+				return llvm::MemoryBuffer::getMemBuffer(
+				  contents_->getBuffer(),
+				  name.str(),
+				  requires_null_terminator);
+			}
+
+			auto close() -> std::error_code override
+			{
+				return {};
+			}
+		private:
+			vfs::Status status_;
+			llvm::MemoryBuffer const* contents_;
+		};
+
+		/// Answers ``status`` and ``openFileForRead`` from a shared ``file_cache``. It keeps its own
+		/// working directory, rather than changing the underlying file system's, and resolves every
+		/// path against it before forwarding, so that the underlying file system can be shared too.
+		class caching_file_system final : public vfs::ProxyFileSystem {
+		public:
+			caching_file_system(file_cache& cache, llvm::IntrusiveRefCntPtr<vfs::FileSystem> underlying)
+			: ProxyFileSystem(underlying)
+			, cache_(&cache)
+			, underlying_(std::move(underlying))
+			{
+				if (auto const working_directory = underlying_->getCurrentWorkingDirectory()) {
+					working_directory_ = *working_directory;
+				}
+			}
+
+			auto status(llvm::Twine const& path) -> llvm::ErrorOr<vfs::Status> override
+			{
+				auto absolute = llvm::SmallString<256>();
+				if (auto const error = make_key(path, absolute)) {
+					return error;
+				}
+
+				auto result = cache_->status(absolute.str(), *underlying_);
+				if (not result) {
+					return result;
+				}
+
+				return vfs::Status::copyWithNewName(*result, path);
+			}
+
+			auto exists(llvm::Twine const& path) -> bool override
+			{
+				return static_cast<bool>(status(path));
+			}
+
+			auto openFileForRead(llvm::Twine const& path)
+			  -> llvm::ErrorOr<std::unique_ptr<vfs::File>> override
+			{
+				auto absolute = llvm::SmallString<256>();
+				if (auto const error = make_key(path, absolute)) {
+					return error;
+				}
+
+				auto result = cache_->contents(absolute.str(), *underlying_);
+				if (not result) {
+					return result.getError();
+				}
+
+				auto& [status, contents] = *result;
+				return std::make_unique<cached_file>(vfs::Status::copyWithNewName(status, path), *contents);
+			}
+
+			auto dir_begin(llvm::Twine const& path, std::error_code& error)
+			  -> vfs::directory_iterator override
+			{
+				auto absolute = llvm::SmallString<256>();
+				if ((error = make_key(path, absolute))) {
+					return {};
+				}
+
+				return underlying_->dir_begin(absolute, error);
+			}
+
+			auto getRealPath(llvm::Twine const& path, llvm::SmallVectorImpl<char>& output) const
+			  -> std::error_code override
+			{
+				auto absolute = llvm::SmallString<256>();
+				if (auto const error = make_key(path, absolute)) {
+					return error;
+				}
+
+				return underlying_->getRealPath(absolute, output);
+			}
+
+			auto isLocal(llvm::Twine const& path, bool& result) -> std::error_code override
+			{
+				auto absolute = llvm::SmallString<256>();
+				if (auto const error = make_key(path, absolute)) {
+					return error;
+				}
+
+				return underlying_->isLocal(absolute, result);
+			}
+
+			auto getCurrentWorkingDirectory() const -> llvm::ErrorOr<std::string> override
+			{
+				return working_directory_;
+			}
+
+			auto setCurrentWorkingDirectory(llvm::Twine const& path) -> std::error_code override
+			{
+				auto absolute = llvm::SmallString<256>();
+				if (auto const error = make_key(path, absolute)) {
+					return error;
+				}
+
+				auto const result = status(absolute);
+				if (not result) {
+					return result.getError();
+				}
+
+				if (not result->isDirectory()) {
+					return std::make_error_code(std::errc::not_a_directory);
+				}
+
+				working_directory_ = absolute.str();
+				return {};
+			}
+		private:
+			file_cache* cache_;
+			llvm::IntrusiveRefCntPtr<vfs::FileSystem> underlying_;
+			std::string working_directory_;
+
+			[[nodiscard]] auto make_key(llvm::Twine const& path, llvm::SmallString<256>& key) const
+			  -> std::error_code
+			{
+				path.toVector(key);
+				if (auto const error = makeAbsolute(key)) {
+					return error;
+				}
+
+				// Removing ``..`` isn't safe in the presence of symlinks, so we only remove ``.``.
+				llvm::sys::path::remove_dots(key, /*remove_dot_dot=*/false);
+				return {};
+			}
+		};
+	} // namespace
+
+	auto file_cache::shard_for(std::string_view const path) -> shard&
+	{
+		return shards_[absl::Hash<std::string_view>()(path) % shard_count];
+	}
+
+	auto file_cache::shard::entry_for(std::string_view const path) -> entry&
+	{
+		if (auto const i = entries.find(path); i != entries.end()) {
+			return i->second;
+		}
+
+		auto const stored = saver.save(llvm::StringRef(path.data(), path.size()));
+		return entries[std::string_view(stored.data(), stored.size())];
+	}
+
+	auto file_cache::status(std::string_view const path, vfs::FileSystem& file_system)
+	  -> llvm::ErrorOr<vfs::Status>
+	{
+		auto& shard = shard_for(path);
+		{
+			auto const lock = std::shared_lock(shard.mutex);
+			if (auto const i = shard.entries.find(path); i != shard.entries.end() and i->second.status) {
+				return *i->second.status;
+			}
+		}
+
+		// The system call is made without holding the lock, so that a slow file system doesn't hold
+		// up lookups of other paths in the same shard.
+		auto result = file_system.status(llvm::StringRef(path.data(), path.size()));
+
+		auto const lock = std::unique_lock(shard.mutex);
+		auto& entry = shard.entry_for(path);
+		if (not entry.status) {
+			entry.status = std::move(result);
+		}
+
+		return *entry.status;
+	}
+
+	auto file_cache::contents(std::string_view const path, vfs::FileSystem& file_system)
+	  -> llvm::ErrorOr<std::pair<vfs::Status, llvm::MemoryBuffer const*>>
+	{
+		auto& shard = shard_for(path);
+		{
+			auto const lock = std::shared_lock(shard.mutex);
+			if (auto const i = shard.entries.find(path);
+			    i != shard.entries.end() and i->second.contents != nullptr)
+			{
+				return std::pair(**i->second.status, i->second.contents.get());
+			}
+		}
+
+		auto const name = llvm::StringRef(path.data(), path.size());
+		auto file = file_system.openFileForRead(name);
+		if (not file) {
+			return file.getError();
+		}
+
+		auto file_status = (*file)->status();
+		if (not file_status) {
+			return file_status.getError();
+		}
+
+		auto const size = static_cast<std::int64_t>(file_status->getSize());
+		auto buffer = (*file)->getBuffer(name, size);
+		if (not buffer) {
+			return buffer.getError();
+		}
+
+		auto const lock = std::unique_lock(shard.mutex);
+		auto& entry = shard.entry_for(path);
+		if (entry.contents == nullptr) {
+			entry.status = std::move(file_status);
+			entry.contents = std::move(*buffer);
+
+			auto const buffers_lock = std::unique_lock(buffers_mutex_);
+			buffers_.insert(entry.contents->getBufferStart());
+		}
+
+		return std::pair(**entry.status, entry.contents.get());
+	}
+
+	auto file_cache::size() const -> std::size_t
+	{
+		return std::accumulate(
+		  shards_.begin(),
+		  shards_.end(),
+		  std::size_t{0},
+		  [](std::size_t const n, shard const& s) {
+			  auto const lock = std::shared_lock(s.mutex);
+			  return n + s.entries.size();
+		  });
+	}
+
+	auto file_cache::content_bytes() const -> std::size_t
+	{
+		return std::accumulate(
+		  shards_.begin(),
+		  shards_.end(),
+		  std::size_t{0},
+		  [](std::size_t const n, shard const& s) {
+			  auto const lock = std::shared_lock(s.mutex);
+			  auto total = n;
+			  for (auto const& [path, entry] : s.entries) {
+				  if (entry.contents != nullptr) {
+					  total += entry.contents->getBufferSize();
+				  }
+			  }
+			  return total;
+		  });
+	}
+
+	auto file_cache::holds(std::string_view const contents) const -> bool
+	{
+		auto const lock = std::shared_lock(buffers_mutex_);
+		return buffers_.contains(contents.data());
+	}
+
+	auto make_caching_file_system(
+	  file_cache& cache,
+	  llvm::IntrusiveRefCntPtr<vfs::FileSystem> underlying) -> llvm::IntrusiveRefCntPtr<vfs::FileSystem>
+	{
+		return llvm::makeIntrusiveRefCnt<caching_file_system>(cache, std::move(underlying));
+	}
+} // namespace driver
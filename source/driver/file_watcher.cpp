@@ -0,0 +1,179 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <expected>
+#include <poll.h>
+#include <ranges>
+#include <schreiber/file_watcher.hpp>
+#include <string>
+#include <string_view>
+#include <sys/inotify.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace stdr = std::ranges;
+
+	namespace {
+		/// Saving a file in place closes it after writing, and editors that save atomically move a
+		/// temporary file over the original.
+		constexpr auto watched_events = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE;
+
+		[[nodiscard]] auto errno_message() -> std::string
+		{
+			return std::error_code(errno, std::generic_category()).message();
+		}
+
+		/// Waits up to ``timeout`` for ``fd`` to be readable. A negative timeout waits forever.
+		[[nodiscard]] auto wait_readable(int const fd, int const timeout)
+		  -> std::expected<bool, std::string>
+		{
+			auto request = ::pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+			while (true) {
+				auto const ready = ::poll(&request, 1, timeout);
+				if (ready >= 0) {
+					return ready > 0;
+				}
+
+				if (errno != EINTR) {
+					return std::unexpected("unable to wait for file changes: " + errno_message());
+				}
+			}
+		}
+	} // namespace
+
+	file_watcher::file_watcher(int const fd) noexcept
+	: fd_(fd)
+	{}
+
+	file_watcher::file_watcher(file_watcher&& other) noexcept
+	: fd_(std::exchange(other.fd_, -1))
+	, directories_(std::move(other.directories_))
+	{}
+
+	auto file_watcher::operator=(file_watcher&& other) noexcept -> file_watcher&
+	{
+		if (this != &other) {
+			if (fd_ >= 0) {
+				::close(fd_);
+			}
+
+			fd_ = std::exchange(other.fd_, -1);
+			directories_ = std::move(other.directories_);
+		}
+
+		return *this;
+	}
+
+	file_watcher::~file_watcher()
+	{
+		if (fd_ >= 0) {
+			::close(fd_);
+		}
+	}
+
+	auto file_watcher::create() -> std::expected<file_watcher, std::string>
+	{
+		auto const fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd < 0) {
+			return std::unexpected("unable to watch for file changes: " + errno_message());
+		}
+
+		return file_watcher(fd);
+	}
+
+	auto file_watcher::watch(std::string_view const directory) -> std::expected<void, std::string>
+	{
+		auto path = std::string(directory);
+		auto const wd = ::inotify_add_watch(fd_, path.c_str(), watched_events | IN_ONLYDIR);
+		if (wd < 0) {
+			return std::unexpected("unable to watch '" + path + "': " + errno_message());
+		}
+
+		directories_.try_emplace(wd, std::move(path));
+		return {};
+	}
+
+	auto file_watcher::read_events(std::vector<std::string>& changed)
+	  -> std::expected<void, std::string>
+	{
+		alignas(::inotify_event) char buffer[4096];
+		while (true) {
+			auto const n = ::read(fd_, buffer, sizeof(buffer));
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				if (errno == EAGAIN) {
+					return {};
+				}
+
+				return std::unexpected("unable to read file changes: " + errno_message());
+			}
+
+			for (auto offset = ::ssize_t{0}; offset < n;) {
+				auto event = ::inotify_event();
+				std::memcpy(&event, buffer + offset, sizeof(event));
+				auto const* const name = buffer + offset + sizeof(event);
+				offset += static_cast<::ssize_t>(sizeof(event) + event.len);
+
+				if ((event.mask & IN_IGNORED) != 0) {
+					directories_.erase(event.wd);
+					continue;
+				}
+
+				auto const directory = directories_.find(event.wd);
+				if (directory == directories_.end() or event.len == 0) {
+					continue;
+				}
+
+				changed.push_back(directory->second + '/' + name);
+			}
+		}
+	}
+
+	auto file_watcher::wait(std::chrono::milliseconds const quiet)
+	  -> std::expected<std::vector<std::string>, std::string>
+	{
+		auto changed = std::vector<std::string>();
+
+		// Nothing is reported until something changes, so there's no timeout until then.
+		auto timeout = -1;
+		while (true) {
+			auto const ready = wait_readable(fd_, timeout);
+			if (not ready) {
+				return std::unexpected(ready.error());
+			}
+
+			if (not *ready) {
+				break;
+			}
+
+			if (auto const read = read_events(changed); not read) {
+				return std::unexpected(read.error());
+			}
+
+			if (not changed.empty()) {
+				timeout = static_cast<int>(quiet.count());
+			}
+		}
+
+		stdr::sort(changed);
+		auto const duplicates = stdr::unique(changed);
+		changed.erase(duplicates.begin(), duplicates.end());
+		return changed;
+	}
+
+	auto file_watcher::directories() const noexcept -> std::size_t
+	{
+		return directories_.size();
+	}
+} // namespace driver
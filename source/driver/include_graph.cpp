@@ -0,0 +1,325 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <atomic>
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/FileSystemOptions.h>
+#include <clang/Basic/SourceLocation.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendActions.h>
+#include <clang/Lex/PPCallbacks.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <cstddef>
+#include <cstdint>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <memory>
+#include <queue>
+#include <ranges>
+#include <schreiber/extract.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/include_graph.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace stdr = std::ranges;
+	namespace tooling = clang::tooling;
+
+	namespace {
+		/// Records each file that the preprocessor enters.
+		class include_collector : public clang::PPCallbacks {
+		public:
+			include_collector(
+			  clang::SourceManager const& source_manager,
+			  std::vector<std::string>& files) noexcept
+			: source_manager_(&source_manager)
+			, files_(&files)
+			{}
+
+			void FileChanged(
+			  clang::SourceLocation const location,
+			  FileChangeReason const reason,
+			  clang::SrcMgr::CharacteristicKind,
+			  clang::FileID) override
+			{
+				if (reason != EnterFile) {
+					return;
+				}
+
+				if (auto path = absolute_path(*source_manager_, source_manager_->getFileID(location));
+				    not path.empty())
+				{
+					files_->push_back(std::move(path));
+				}
+			}
+		private:
+			clang::SourceManager const* source_manager_;
+			std::vector<std::string>* files_;
+		};
+
+		class include_scan_action : public clang::PreprocessOnlyAction {
+		public:
+			explicit include_scan_action(std::vector<std::string>& files) noexcept
+			: files_(&files)
+			{}
+		protected:
+			auto BeginSourceFileAction(clang::CompilerInstance& compiler) -> bool override
+			{
+				compiler.getPreprocessor().addPPCallbacks(
+				  std::make_unique<include_collector>(compiler.getSourceManager(), *files_));
+				return true;
+			}
+		private:
+			std::vector<std::string>* files_;
+		};
+	} // namespace
+
+	auto scan_includes(tooling::CompileCommand const& command, file_cache& cache)
+	  -> std::vector<std::string>
+	{
+		auto const file_system = make_caching_file_system(cache, llvm::vfs::getRealFileSystem());
+		file_system->setCurrentWorkingDirectory(command.Directory);
+		auto const files =
+		  llvm::makeIntrusiveRefCnt<clang::FileManager>(clang::FileSystemOptions(), file_system);
+
+		auto const adjust = tooling::combineAdjusters(
+		  tooling::getClangSyntaxOnlyAdjuster(),
+		  tooling::combineAdjusters(
+		    tooling::getClangStripOutputAdjuster(),
+		    tooling::getClangStripDependencyFileAdjuster()));
+
+		auto result = std::vector<std::string>();
+		auto ignore = clang::IgnoringDiagConsumer();
+		auto invocation = tooling::ToolInvocation(
+		  adjust(command.CommandLine, command.Filename),
+		  std::make_unique<include_scan_action>(result),
+		  files.get());
+		invocation.setDiagnosticConsumer(&ignore);
+		(void)invocation.run();
+
+		stdr::sort(result);
+		auto const duplicates = stdr::unique(result);
+		result.erase(duplicates.begin(), duplicates.end());
+		return result;
+	}
+
+	auto
+	include_graph::scan(std::span<tooling::CompileCommand const> const commands, unsigned const jobs)
+	  -> include_graph
+	{
+		auto scanned = std::vector<std::vector<std::string>>(commands.size());
+		{
+			auto cache = file_cache();
+			auto next = std::atomic<std::size_t>(0);
+			auto const count = std::min<std::size_t>(std::max(jobs, 1u), commands.size());
+			auto workers = std::vector<std::jthread>();
+			workers.reserve(count);
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				workers.emplace_back([&] {
+					for (auto job = next++; job < commands.size(); job = next++) {
+						scanned[job] = scan_includes(commands[job], cache);
+					}
+				});
+			}
+		}
+
+		auto result = include_graph();
+		for (auto const& files : scanned) {
+			result.add(files);
+		}
+
+		return result;
+	}
+
+	auto include_graph::ids_for(std::span<std::string const> const files)
+	  -> std::vector<std::uint32_t>
+	{
+		auto ids = std::vector<std::uint32_t>();
+		ids.reserve(files.size());
+		for (auto const& path : files) {
+			auto const [i, inserted] = ids_.try_emplace(path, static_cast<std::uint32_t>(paths_.size()));
+			if (inserted) {
+				paths_.push_back(path);
+				includers_.emplace_back();
+			}
+
+			ids.push_back(i->second);
+		}
+
+		stdr::sort(ids);
+		auto const duplicates = stdr::unique(ids);
+		ids.erase(duplicates.begin(), duplicates.end());
+		return ids;
+	}
+
+	auto include_graph::add(std::span<std::string const> const files) -> std::size_t
+	{
+		auto const translation_unit = files_.size();
+		auto const& ids = files_.emplace_back(ids_for(files));
+		for (auto const id : ids) {
+			includers_[id].push_back(translation_unit);
+		}
+
+		return translation_unit;
+	}
+
+	void include_graph::replace(
+	  std::size_t const translation_unit,
+	  std::span<std::string const> const files)
+	{
+		for (auto const id : files_[translation_unit]) {
+			auto& includers = includers_[id];
+			includers.erase(stdr::lower_bound(includers, translation_unit));
+		}
+
+		files_[translation_unit] = ids_for(files);
+		for (auto const id : files_[translation_unit]) {
+			auto& includers = includers_[id];
+			includers.insert(stdr::lower_bound(includers, translation_unit), translation_unit);
+		}
+	}
+
+	auto include_graph::including(std::string_view const file) const -> std::span<std::size_t const>
+	{
+		auto const i = ids_.find(std::string(file));
+		return i != ids_.end() ? std::span<std::size_t const>(includers_[i->second])
+		                       : std::span<std::size_t const>();
+	}
+
+	auto include_graph::including_any(std::span<std::string_view const> const files) const
+	  -> std::vector<std::size_t>
+	{
+		auto result = std::vector<std::size_t>();
+		for (auto const file : files) {
+			auto const translation_units = including(file);
+			result.insert(result.end(), translation_units.begin(), translation_units.end());
+		}
+
+		stdr::sort(result);
+		auto const duplicates = stdr::unique(result);
+		result.erase(duplicates.begin(), duplicates.end());
+		return result;
+	}
+
+	auto include_graph::cover(
+	  std::span<std::string_view const> const files,
+	  std::span<double const> const costs) const -> std::vector<std::size_t>
+	{
+		auto uncovered = std::vector<bool>(paths_.size());
+		auto remaining = std::size_t{0};
+		for (auto const file : files) {
+			auto const i = ids_.find(std::string(file));
+			if (i != ids_.end() and not uncovered[i->second]) {
+				uncovered[i->second] = true;
+				++remaining;
+			}
+		}
+
+		auto const is_uncovered = [&uncovered](std::uint32_t const id) { return uncovered[id]; };
+		auto const gain = [&](std::size_t const translation_unit) {
+			return static_cast<double>(stdr::count_if(files_[translation_unit], is_uncovered));
+		};
+
+		// A translation unit that's estimated to be free would otherwise always be chosen first.
+		auto const cost = [costs](std::size_t const translation_unit) {
+			return std::max(costs[translation_unit], 1.0);
+		};
+
+		// A translation unit's gain only shrinks as others are chosen, so a stale ratio is an upper
+		// bound on its real one. That lets us recompute ratios lazily, when they reach the top.
+		struct candidate {
+			double ratio;
+			std::size_t translation_unit;
+
+			[[nodiscard]] auto operator<(candidate const& other) const noexcept -> bool
+			{
+				// Ties go to the translation unit that comes first.
+				return ratio != other.ratio ? ratio < other.ratio
+				                            : translation_unit > other.translation_unit;
+			}
+		};
+
+		auto candidates = std::priority_queue<candidate>();
+		for (auto i = std::size_t{0}; i < files_.size(); ++i) {
+			if (auto const g = gain(i); g > 0) {
+				candidates.push({g / cost(i), i});
+			}
+		}
+
+		auto result = std::vector<std::size_t>();
+		while (remaining > 0 and not candidates.empty()) {
+			auto const top = candidates.top();
+			candidates.pop();
+
+			auto const g = gain(top.translation_unit);
+			if (g == 0) {
+				continue;
+			}
+
+			auto const ratio = g / cost(top.translation_unit);
+			if (not candidates.empty() and ratio < candidates.top().ratio) {
+				candidates.push({ratio, top.translation_unit});
+				continue;
+			}
+
+			result.push_back(top.translation_unit);
+			for (auto const id : files_[top.translation_unit]) {
+				if (uncovered[id]) {
+					uncovered[id] = false;
+					--remaining;
+				}
+			}
+		}
+
+		stdr::sort(result);
+		return result;
+	}
+
+	auto include_graph::files_under(std::string_view const directory) const
+	  -> std::vector<std::string_view>
+	{
+		auto prefix = std::string(directory);
+		if (not prefix.ends_with('/')) {
+			prefix += '/';
+		}
+
+		auto result = std::vector<std::string_view>();
+		for (auto id = std::size_t{0}; id < paths_.size(); ++id) {
+			// Files stop being reached when the translation units that reached them are replaced.
+			if (paths_[id].starts_with(prefix) and not includers_[id].empty()) {
+				result.push_back(paths_[id]);
+			}
+		}
+
+		stdr::sort(result);
+		return result;
+	}
+
+	auto include_graph::files(std::size_t const translation_unit) const
+	  -> std::vector<std::string_view>
+	{
+		auto result = std::vector<std::string_view>();
+		result.reserve(files_[translation_unit].size());
+		for (auto const id : files_[translation_unit]) {
+			result.push_back(paths_[id]);
+		}
+
+		return result;
+	}
+
+	auto include_graph::translation_units() const noexcept -> std::size_t
+	{
+		return files_.size();
+	}
+} // namespace driver
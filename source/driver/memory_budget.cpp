@@ -0,0 +1,111 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <schreiber/memory_budget.hpp>
+#include <string>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif // __GLIBC__
+
+namespace driver {
+	namespace {
+		[[nodiscard]] auto read_statm(std::string const& path) -> std::optional<std::size_t>
+		{
+			auto statm = std::ifstream(path);
+			auto size = std::size_t{0};
+			auto resident = std::size_t{0};
+			if (not(statm >> size >> resident)) {
+				return std::nullopt;
+			}
+
+			return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		}
+
+		/// The ASTContext's allocations are most, but not all, of what a translation unit needs:
+		/// the preprocessor, Sema, and the source buffers account for the rest.
+		constexpr auto ast_overhead = std::size_t{2};
+
+		/// How often a waiting thread looks at the resident set size again, in case it has dropped
+		/// without a translation unit finishing.
+		constexpr auto recheck_interval = std::chrono::milliseconds(100);
+	} // namespace
+
+	auto resident_set_size(pid_t const pid) -> std::optional<std::size_t>
+	{
+		return read_statm("/proc/" + std::to_string(pid) + "/statm");
+	}
+
+	auto resident_set_size() -> std::optional<std::size_t>
+	{
+		return read_statm("/proc/self/statm");
+	}
+
+	void release_free_memory() noexcept
+	{
+#ifdef __GLIBC__
+		::malloc_trim(0);
+#endif // __GLIBC__
+	}
+
+	memory_budget::memory_budget(std::size_t const limit) noexcept
+	: limit_(limit)
+	{}
+
+	auto memory_budget::admits_locked(std::size_t const in_use, std::size_t const in_flight) const
+	  -> bool
+	{
+		return limit_ == 0 or in_flight == 0 or in_use + largest_ast_ * ast_overhead <= limit_;
+	}
+
+	auto memory_budget::admits(std::size_t const in_use, std::size_t const in_flight) const -> bool
+	{
+		auto const lock = std::scoped_lock(mutex_);
+		return admits_locked(in_use, in_flight);
+	}
+
+	void memory_budget::record(std::size_t const ast_bytes)
+	{
+		auto const lock = std::scoped_lock(mutex_);
+		largest_ast_ = std::max(largest_ast_, ast_bytes);
+	}
+
+	void memory_budget::acquire()
+	{
+		auto lock = std::unique_lock(mutex_);
+		while (not admits_locked(resident_set_size().value_or(0), in_flight_)) {
+			released_.wait_for(lock, recheck_interval);
+		}
+
+		++in_flight_;
+	}
+
+	void memory_budget::release(std::size_t const ast_bytes)
+	{
+		{
+			auto const lock = std::scoped_lock(mutex_);
+			--in_flight_;
+			largest_ast_ = std::max(largest_ast_, ast_bytes);
+		}
+
+		if (limit_ != 0) {
+			release_free_memory();
+		}
+
+		released_.notify_all();
+	}
+
+	auto memory_budget::limit() const noexcept -> std::size_t
+	{
+		return limit_;
+	}
+} // namespace driver
@@ -0,0 +1,276 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <array>
+#include <clang/AST/ASTContext.h>
+#include <clang/Basic/SourceManager.h>
+#include <cstddef>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/info.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string_view>
+#include <utility>
+
+namespace driver {
+	namespace {
+		/// Returns the number of bytes that ``info`` owns for its description. Interned descriptions
+		/// belong to the interner.
+		[[nodiscard]] auto owned_description(info::basic_info const& info) noexcept -> std::size_t
+		{
+			return info.interned_description().empty() ? info.description().size() : 0;
+		}
+
+		/// Returns the number of bytes in the buffers that ``source_manager`` has loaded, leaving out
+		/// the views of files that ``cache`` holds. Each file is counted once, however many times it
+		/// was included.
+		[[nodiscard]] auto
+		owned_buffer_bytes(clang::SourceManager const& source_manager, file_cache const* const cache)
+		  -> std::size_t
+		{
+			auto seen = llvm::SmallPtrSet<clang::SrcMgr::ContentCache const*, 64>();
+			auto bytes = std::size_t{0};
+			for (auto i = 0u; i < source_manager.local_sloc_entry_size(); ++i) {
+				auto const& entry = source_manager.getLocalSLocEntry(i);
+				if (not entry.isFile()) {
+					continue;
+				}
+
+				auto const& content = entry.getFile().getContentCache();
+				if (not seen.insert(&content).second) {
+					continue;
+				}
+
+				auto const data = content.getBufferDataIfLoaded();
+				if (not data.has_value() or (cache != nullptr and cache->holds(*data))) {
+					continue;
+				}
+
+				bytes += data->size();
+			}
+
+			return bytes;
+		}
+
+		template<class T>
+		[[nodiscard]] auto vector_bytes(std::vector<T> const& v) noexcept -> std::size_t
+		{
+			return v.capacity() * sizeof(T);
+		}
+	} // namespace
+
+	void
+	memory_stats::add(category const c, std::size_t const bytes, std::size_t const count) noexcept
+	{
+		auto& u = usage_[std::to_underlying(c)];
+		u.count += count;
+		u.bytes += bytes;
+	}
+
+	void memory_stats::record(info::entity_info const& entity)
+	{
+		// Each entity's documentation is destroyed before the next is parsed, so the peak for each
+		// category is the most that a single entity used.
+		auto entity_bytes = std::array<std::size_t, category_count>{};
+		auto const count = [&](category const c, std::size_t const bytes, info::basic_info const& i) {
+			entity_bytes[std::to_underlying(c)] += bytes;
+			add(c, bytes);
+
+			auto const description = owned_description(i);
+			entity_bytes[std::to_underlying(category::descriptions)] += description;
+			add(category::descriptions, description, 0);
+		};
+
+		for (auto const& header : entity.headers()) {
+			count(category::header_info, sizeof(header), header);
+		}
+
+		for (auto const& module : entity.modules()) {
+			count(category::module_info, sizeof(module), module);
+		}
+
+		if (auto const* const class_ = llvm::dyn_cast<info::record_info>(&entity)) {
+			auto const* const class_template = llvm::dyn_cast<info::class_template_info>(class_);
+			count(
+			  category::record_info,
+			  class_template != nullptr ? sizeof(*class_template) : sizeof(*class_),
+			  *class_);
+			if (class_template != nullptr) {
+				for (auto const& parameter : class_template->template_parameters()) {
+					count(category::parameter_info, sizeof(parameter), parameter);
+				}
+			}
+		}
+
+		if (auto const* const function = llvm::dyn_cast<info::function_info>(&entity)) {
+			count(category::function_info, sizeof(*function), *function);
+			for (auto const& parameter : function->parameters()) {
+				count(category::parameter_info, sizeof(parameter), parameter);
+			}
+
+			if (function->returns().has_value()) {
+				count(category::return_info, 0, *function->returns());
+			}
+
+			for (auto const& precondition : function->preconditions()) {
+				count(category::precondition_info, sizeof(precondition), precondition);
+			}
+
+			for (auto const& postcondition : function->postconditions()) {
+				count(category::postcondition_info, sizeof(postcondition), postcondition);
+			}
+
+			for (auto const& throws : function->throws()) {
+				count(category::throws_info, sizeof(throws) + throws.type().size(), throws);
+			}
+
+			for (auto const& exits_via : function->exits_via()) {
+				count(category::exits_via_info, sizeof(exits_via), exits_via);
+			}
+		}
+
+		for (auto i = std::size_t{0}; i < category_count; ++i) {
+			usage_[i].peak = std::max(usage_[i].peak, entity_bytes[i]);
+		}
+	}
+
+	void memory_stats::record(info::detached_translation_unit const& unit)
+	{
+		auto bytes = unit.entities().size() * sizeof(info::detached_entity);
+		for (auto const& entity : unit.entities()) {
+			bytes += vector_bytes(entity.headers) + vector_bytes(entity.modules)
+			       + vector_bytes(entity.template_parameters) + vector_bytes(entity.parameters)
+			       + vector_bytes(entity.preconditions) + vector_bytes(entity.postconditions)
+			       + vector_bytes(entity.throws) + vector_bytes(entity.exits_via)
+			       + vector_bytes(entity.references);
+		}
+
+		// Detached entities live until the end of the run.
+		add(category::detached_entities, bytes, unit.entities().size());
+		auto& u = usage_[std::to_underlying(category::detached_entities)];
+		u.peak = std::max(u.peak, bytes);
+	}
+
+	void memory_stats::record(clang::ASTContext const& context, file_cache const* const cache)
+	{
+		auto const& source_manager = context.getSourceManager();
+		for (auto const [c, bytes] : {
+		       std::pair(category::ast, context.getASTAllocatedMemory()),
+		       std::pair(category::ast_side_tables, context.getSideTableAllocatedMemory()),
+		       std::pair(category::source_manager, source_manager.getDataStructureSizes()),
+		       std::pair(category::source_buffers, owned_buffer_bytes(source_manager, cache)),
+		     })
+		{
+			add(c, bytes, 0);
+			auto& u = usage_[std::to_underlying(c)];
+			u.peak = std::max(u.peak, bytes);
+		}
+	}
+
+	void memory_stats::record_diagnostics(std::size_t const capacity)
+	{
+		add(category::diagnostics, capacity, 0);
+		auto& u = usage_[std::to_underlying(category::diagnostics)];
+		u.peak = std::max(u.peak, capacity);
+	}
+
+	void memory_stats::record(info::string_interner const& interner)
+	{
+		auto const bytes = interner.allocated_bytes();
+		set(category::interned_strings, {.count = interner.size(), .bytes = bytes, .peak = bytes});
+	}
+
+	void memory_stats::record(file_cache const& cache)
+	{
+		auto const bytes = cache.content_bytes();
+		set(category::cached_files, {.count = cache.size(), .bytes = bytes, .peak = bytes});
+	}
+
+	void memory_stats::set(category const c, usage const u) noexcept
+	{
+		usage_[std::to_underlying(c)] = u;
+	}
+
+	auto memory_stats::operator[](category const c) const noexcept -> usage const&
+	{
+		return usage_[std::to_underlying(c)];
+	}
+
+	auto memory_stats::operator+=(memory_stats const& other) noexcept -> memory_stats&
+	{
+		for (auto i = std::size_t{0}; i < category_count; ++i) {
+			usage_[i].count += other.usage_[i].count;
+			usage_[i].bytes += other.usage_[i].bytes;
+			usage_[i].peak = std::max(usage_[i].peak, other.usage_[i].peak);
+		}
+
+		return *this;
+	}
+
+	auto to_string(memory_stats::category const c) -> std::string_view
+	{
+		using enum memory_stats::category;
+		switch (c) {
+		case function_info:
+			return "function_info";
+		case record_info:
+			return "record_info";
+		case parameter_info:
+			return "parameter_info";
+		case return_info:
+			return "return_info";
+		case precondition_info:
+			return "precondition_info";
+		case postcondition_info:
+			return "postcondition_info";
+		case throws_info:
+			return "throws_info";
+		case exits_via_info:
+			return "exits_via_info";
+		case header_info:
+			return "header_info";
+		case module_info:
+			return "module_info";
+		case descriptions:
+			return "descriptions";
+		case interned_strings:
+			return "interned_strings";
+		case detached_entities:
+			return "detached_entities";
+		case diagnostics:
+			return "diagnostics";
+		case ast:
+			return "ast";
+		case ast_side_tables:
+			return "ast_side_tables";
+		case source_manager:
+			return "source_manager";
+		case source_buffers:
+			return "source_buffers";
+		case cached_files:
+			return "cached_files";
+		}
+	}
+
+	void write_stats(llvm::raw_ostream& os, std::string_view const title, memory_stats const& stats)
+	{
+		os << title << ":\n";
+		constexpr auto row = "  {0,-20} {1,10} {2,14} {3,14}\n";
+		os << llvm::formatv(row, "category", "count", "bytes", "peak");
+		for (auto i = std::size_t{0}; i < memory_stats::category_count; ++i) {
+			auto const c = static_cast<memory_stats::category>(i);
+			auto const& u = stats[c];
+			if (u == memory_stats::usage()) {
+				continue;
+			}
+
+			os << llvm::formatv(row, to_string(c), u.count, u.bytes, u.peak);
+		}
+	}
+} // namespace driver
@@ -0,0 +1,496 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <limits>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+#include <optional>
+#include <queue>
+#include <schreiber/merge.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace json = llvm::json;
+	namespace stdr = std::ranges;
+
+	namespace {
+		/// The part of the hash range that a merge is responsible for.
+		struct shard {
+			unsigned index = 0;
+			unsigned count = 1;
+
+			[[nodiscard]] auto contains(std::string_view const usr) const -> bool
+			{
+				if (count == 1) {
+					return true;
+				}
+
+				auto const width = std::numeric_limits<std::uint64_t>::max() / count + 1;
+				return llvm::xxh3_64bits(llvm::StringRef(usr.data(), usr.size())) / width == index;
+			}
+		};
+
+		/// Reads one input a line at a time, skipping the entities that belong to other shards.
+		class cursor {
+		public:
+			cursor(std::string path, shard const part)
+			: path_(std::move(path))
+			, file_(path_)
+			, part_(part)
+			{}
+
+			[[nodiscard]] auto is_open() const -> bool
+			{
+				return file_.is_open();
+			}
+
+			/// Moves to the next entity in this shard. Returns ``false`` at the end of the input.
+			[[nodiscard]] auto advance() -> std::expected<bool, std::string>
+			{
+				while (std::getline(file_, line_)) {
+					++line_number_;
+					if (line_.empty()) {
+						continue;
+					}
+
+					auto usr = entity_usr(line_);
+					if (not usr.has_value()) {
+						return std::unexpected(
+						  "line " + std::to_string(line_number_) + " of '" + path_ + "' isn't an entity");
+					}
+
+					// The order is checked before filtering, so that an unsorted input is always an error
+					// rather than only when the entities happen to fall in the same shard.
+					if (*usr < previous_usr_) {
+						return std::unexpected(
+						  "'" + path_ + "' isn't sorted by USR at line " + std::to_string(line_number_));
+					}
+
+					previous_usr_ = *usr;
+					if (part_.contains(*usr)) {
+						usr_ = *std::move(usr);
+						return true;
+					}
+				}
+
+				if (file_.bad()) {
+					return std::unexpected("unable to read '" + path_ + "'");
+				}
+
+				return false;
+			}
+
+			[[nodiscard]] auto usr() const noexcept -> std::string const&
+			{
+				return usr_;
+			}
+
+			[[nodiscard]] auto take_line() noexcept -> std::string
+			{
+				return std::move(line_);
+			}
+		private:
+			std::string path_;
+			std::ifstream file_;
+			shard part_;
+			std::string line_;
+			std::string usr_;
+			std::string previous_usr_;
+			std::size_t line_number_ = 0;
+		};
+
+		/// Counts the non-empty descriptions anywhere in an entity.
+		[[nodiscard]] auto documentation_score(json::Value const& value) -> std::size_t
+		{
+			if (auto const object = value.getAsObject()) {
+				auto score = std::size_t{0};
+				for (auto const& [key, member] : *object) {
+					if (auto const description = member.getAsString();
+					    llvm::StringRef(key) == "description" and description.has_value())
+					{
+						score += description->empty() ? 0 : 1;
+						continue;
+					}
+
+					score += documentation_score(member);
+				}
+
+				return score;
+			}
+
+			if (auto const array = value.getAsArray()) {
+				auto score = std::size_t{0};
+				for (auto const& element : *array) {
+					score += documentation_score(element);
+				}
+
+				return score;
+			}
+
+			return 0;
+		}
+
+		/// An entity's description and where it came from, for reporting conflicts.
+		struct documented {
+			std::string qualified_name;
+			std::string description;
+			std::string location;
+		};
+
+		[[nodiscard]] auto read_documentation(json::Value const& value) -> documented
+		{
+			auto result = documented();
+			auto const entity = value.getAsObject();
+			if (entity == nullptr) {
+				return result;
+			}
+
+			result.qualified_name = entity->getString("qualified_name").value_or("").str();
+			auto const documentation = entity->getObject("documentation");
+			if (documentation == nullptr) {
+				return result;
+			}
+
+			result.description = documentation->getString("description").value_or("").str();
+			if (auto const location = documentation->getObject("location")) {
+				result.location = location->getString("file").value_or("").str() + ':'
+				                + std::to_string(location->getInteger("line").value_or(0));
+			}
+
+			return result;
+		}
+
+		/// Picks the entity to keep from several with the same USR, and reports a conflict if they
+		/// disagree about its description.
+		///
+		/// \param reported The USRs whose conflicts have already been reported. A merge with several
+		///                 passes sees a conflict again when it merges the earlier passes' winners, and
+		///                 each USR is only reported the first time.
+		[[nodiscard]] auto resolve(
+		  std::span<std::string const> const group,
+		  std::string_view const usr,
+		  llvm::StringSet<>& reported,
+		  merge_result& result) -> std::size_t
+		{
+			result.duplicates += group.size() - 1;
+			if (stdr::all_of(group, [&group](std::string const& line) { return line == group[0]; })) {
+				return 0;
+			}
+
+			auto best = std::size_t{0};
+			auto best_score = std::size_t{0};
+			auto kept = std::string();
+			auto variants = std::vector<documented>();
+			for (auto i = std::size_t{0}; i < group.size(); ++i) {
+				auto value = json::parse(group[i]);
+				if (not value) {
+					llvm::consumeError(value.takeError());
+					continue;
+				}
+
+				auto variant = read_documentation(*value);
+				if (auto const score = documentation_score(*value); score > best_score) {
+					best = i;
+					best_score = score;
+					kept = variant.location;
+				}
+
+				if (not variant.description.empty()
+				    and stdr::find(variants, variant.description, &documented::description)
+				          == variants.end())
+				{
+					variants.push_back(std::move(variant));
+				}
+			}
+
+			if (variants.size() > 1 and reported.insert(usr).second) {
+				++result.conflicts;
+				result.diagnostics += "warning: '" + variants[0].qualified_name
+				                    + "' is documented differently at " + variants[0].location;
+				for (auto const& variant : std::span(variants).subspan(1)) {
+					result.diagnostics += " and " + variant.location;
+				}
+
+				result.diagnostics += "; keeping the one at " + kept + '\n';
+			}
+
+			return best;
+		}
+
+		/// Merges inputs that are few enough to be open at once.
+		[[nodiscard]] auto merge_pass(
+		  std::span<std::string const> const inputs,
+		  llvm::raw_ostream& output,
+		  shard const part,
+		  llvm::StringSet<>& reported,
+		  merge_result& result) -> std::expected<void, std::string>
+		{
+			auto cursors = std::vector<cursor>();
+			cursors.reserve(inputs.size());
+			for (auto const& path : inputs) {
+				cursors.emplace_back(path, part);
+				if (not cursors.back().is_open()) {
+					return std::unexpected("unable to open '" + path + "'");
+				}
+			}
+
+			// The heap's top is the input with the smallest USR, with ties going to the earliest input
+			// so that the group below stays in input order.
+			auto const later = [&cursors](std::size_t const x, std::size_t const y) {
+				auto const& x_usr = cursors[x].usr();
+				auto const& y_usr = cursors[y].usr();
+				return x_usr == y_usr ? x > y : x_usr > y_usr;
+			};
+			using heap_t = std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)>;
+			auto heap = heap_t(later);
+			for (auto i = std::size_t{0}; i < cursors.size(); ++i) {
+				auto const advanced = cursors[i].advance();
+				if (not advanced) {
+					return std::unexpected(advanced.error());
+				}
+
+				if (*advanced) {
+					heap.push(i);
+				}
+			}
+
+			auto group = std::vector<std::string>();
+			while (not heap.empty()) {
+				auto const usr = cursors[heap.top()].usr();
+				group.clear();
+
+				// Entities without a USR can't be told apart, so each is its own group.
+				do {
+					auto const i = heap.top();
+					heap.pop();
+					group.push_back(cursors[i].take_line());
+
+					auto const advanced = cursors[i].advance();
+					if (not advanced) {
+						return std::unexpected(advanced.error());
+					}
+
+					if (*advanced) {
+						heap.push(i);
+					}
+				} while (not usr.empty() and not heap.empty() and cursors[heap.top()].usr() == usr);
+
+				output << group[resolve(group, usr, reported, result)] << '\n';
+				++result.entities;
+			}
+
+			return {};
+		}
+
+		/// Removes the temporary files that a merge wrote once it's done with them.
+		class temporary_files {
+		public:
+			temporary_files() = default;
+			temporary_files(temporary_files const&) = delete;
+			auto operator=(temporary_files const&) -> temporary_files& = delete;
+
+			~temporary_files()
+			{
+				for (auto const& path : paths_) {
+					llvm::sys::fs::remove(path);
+				}
+			}
+
+			void add(std::string path)
+			{
+				paths_.push_back(std::move(path));
+			}
+
+			[[nodiscard]] auto paths() const noexcept -> std::span<std::string const>
+			{
+				return paths_;
+			}
+		private:
+			std::vector<std::string> paths_;
+		};
+
+		/// Writes the result of a merge to a new temporary file, and returns its path.
+		template<class F>
+		[[nodiscard]] auto merge_to_temporary(F merge) -> std::expected<std::string, std::string>
+		{
+			auto path = llvm::SmallString<256>();
+			auto fd = 0;
+			auto const error = llvm::sys::fs::createTemporaryFile("schreiber-merge", "json", fd, path);
+			if (error) {
+				return std::unexpected("unable to create a temporary file: " + error.message());
+			}
+
+			auto os = llvm::raw_fd_ostream(fd, /*shouldClose=*/true);
+			if (auto merged = merge(os); not merged) {
+				os.close();
+				llvm::sys::fs::remove(path);
+				return std::unexpected(std::move(merged).error());
+			}
+
+			os.close();
+			if (os.has_error()) {
+				auto const message = os.error().message();
+				os.clear_error();
+				llvm::sys::fs::remove(path);
+				return std::unexpected("unable to write '" + path.str().str() + "': " + message);
+			}
+
+			return path.str().str();
+		}
+
+		/// Merges ``inputs``, first merging them into temporary files in batches of ``fan_in`` when
+		/// there are too many to open at once.
+		[[nodiscard]] auto merge_files(
+		  std::span<std::string const> const inputs,
+		  llvm::raw_ostream& output,
+		  shard const part,
+		  std::size_t const fan_in,
+		  llvm::StringSet<>& reported,
+		  merge_result& result) -> std::expected<void, std::string>
+		{
+			if (inputs.size() <= fan_in) {
+				return merge_pass(inputs, output, part, reported, result);
+			}
+
+			auto batches = temporary_files();
+			for (auto i = std::size_t{0}; i < inputs.size(); i += fan_in) {
+				auto const batch = inputs.subspan(i, std::min(fan_in, inputs.size() - i));
+
+				// Only the final pass's entities are written to ``output``.
+				auto batch_result = merge_result();
+				auto path = merge_to_temporary([&](llvm::raw_ostream& os) {
+					return merge_files(batch, os, part, fan_in, reported, batch_result);
+				});
+				if (not path) {
+					return std::unexpected(std::move(path).error());
+				}
+
+				result.duplicates += batch_result.duplicates;
+				result.conflicts += batch_result.conflicts;
+				result.diagnostics += batch_result.diagnostics;
+				batches.add(*std::move(path));
+			}
+
+			return merge_files(batches.paths(), output, part, fan_in, reported, result);
+		}
+	} // namespace
+
+	auto entity_usr(std::string_view const line) -> std::optional<std::string>
+	{
+		// ``serialise`` always writes the USR first, so it can usually be read without parsing the
+		// whole entity. Anything unusual, such as an escaped character, falls back to parsing.
+		constexpr auto prefix = std::string_view(R"({"usr":")");
+		if (line.starts_with(prefix)) {
+			auto const usr = line.substr(prefix.size());
+			auto const end = usr.find_first_of(R"("\)");
+			if (end != std::string_view::npos and usr[end] == '"') {
+				return std::string(usr.substr(0, end));
+			}
+		}
+
+		auto value = json::parse(llvm::StringRef(line.data(), line.size()));
+		if (not value) {
+			llvm::consumeError(value.takeError());
+			return std::nullopt;
+		}
+
+		auto const entity = value->getAsObject();
+		if (entity == nullptr) {
+			return std::nullopt;
+		}
+
+		auto const usr = entity->getString("usr");
+		if (not usr.has_value()) {
+			return std::nullopt;
+		}
+
+		return usr->str();
+	}
+
+	auto merge_entities(
+	  std::span<std::string const> const inputs,
+	  llvm::raw_ostream& output,
+	  merge_options const& options) -> std::expected<merge_result, std::string>
+	{
+		auto const fan_in = std::max(options.fan_in, std::size_t{2});
+		auto result = merge_result();
+		if (options.shards <= 1) {
+			auto reported = llvm::StringSet<>();
+			auto merged = merge_files(inputs, output, shard{}, fan_in, reported, result);
+			if (not merged) {
+				return std::unexpected(std::move(merged).error());
+			}
+
+			return result;
+		}
+
+		// Each shard is merged into its own file. The shards have no USRs in common, so combining
+		// them is a plain merge that only puts the shards' entities back in order. The shards run at
+		// the same time, so they share ``fan_in`` between them.
+		auto const shard_fan_in = std::max(fan_in / options.shards, std::size_t{2});
+		auto shard_results = std::vector<merge_result>(options.shards);
+		auto shard_files = std::vector<std::expected<std::string, std::string>>(options.shards);
+		{
+			auto workers = std::vector<std::jthread>();
+			workers.reserve(options.shards);
+			for (auto i = 0U; i < options.shards; ++i) {
+				workers.emplace_back([&, i] {
+					shard_files[i] = merge_to_temporary([&](llvm::raw_ostream& os) {
+						auto reported = llvm::StringSet<>();
+						return merge_files(
+						  inputs,
+						  os,
+						  shard{.index = i, .count = options.shards},
+						  shard_fan_in,
+						  reported,
+						  shard_results[i]);
+					});
+				});
+			}
+		}
+
+		auto merged_shards = temporary_files();
+		for (auto const& file : shard_files) {
+			if (file.has_value()) {
+				merged_shards.add(*file);
+			}
+		}
+
+		for (auto i = 0U; i < options.shards; ++i) {
+			if (not shard_files[i]) {
+				return std::unexpected(std::move(shard_files[i]).error());
+			}
+
+			result.duplicates += shard_results[i].duplicates;
+			result.conflicts += shard_results[i].conflicts;
+			result.diagnostics += shard_results[i].diagnostics;
+		}
+
+		auto combined = merge_result();
+		auto reported = llvm::StringSet<>();
+		auto merged = merge_files(merged_shards.paths(), output, shard{}, fan_in, reported, combined);
+		if (not merged) {
+			return std::unexpected(std::move(merged).error());
+		}
+
+		result.entities = combined.entities;
+		return result;
+	}
+} // namespace driver
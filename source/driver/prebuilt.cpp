@@ -0,0 +1,242 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/DiagnosticIDs.h>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/FileSystemOptions.h>
+#include <clang/Serialization/ASTReader.h>
+#include <clang/Serialization/InMemoryModuleCache.h>
+#include <clang/Serialization/PCHContainerOperations.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Chrono.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <schreiber/prebuilt.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace driver {
+	namespace stdr = std::ranges;
+	namespace tooling = clang::tooling;
+
+	namespace {
+		/// Looks for an input file that's changed since an AST file was built.
+		class input_checker : public clang::ASTReaderListener {
+		public:
+			explicit input_checker(llvm::sys::TimePoint<> const built) noexcept
+			: built_(built)
+			{}
+
+			auto needsInputFileVisitation() -> bool override
+			{
+				return true;
+			}
+
+			// System headers rarely change, and there are far more of them than project headers.
+			auto needsSystemInputFileVisitation() -> bool override
+			{
+				return false;
+			}
+
+			auto visitInputFile(llvm::StringRef const filename, bool, bool const is_overridden, bool)
+			  -> bool override
+			{
+				if (is_overridden) {
+					return true;
+				}
+
+				auto status = llvm::sys::fs::file_status();
+				if (llvm::sys::fs::status(filename, status) or status.getLastModificationTime() > built_) {
+					changed_ = true;
+					return false;
+				}
+
+				return true;
+			}
+
+			[[nodiscard]] auto changed() const noexcept -> bool
+			{
+				return changed_;
+			}
+		private:
+			llvm::sys::TimePoint<> built_;
+			bool changed_ = false;
+		};
+
+		[[nodiscard]] auto make_absolute(llvm::StringRef const directory, llvm::StringRef const path)
+		  -> std::string
+		{
+			auto result = llvm::SmallString<256>(path);
+			llvm::sys::fs::make_absolute(directory, result);
+			llvm::sys::path::remove_dots(result, /*remove_dot_dot=*/true);
+			return result.str().str();
+		}
+	} // namespace
+
+	auto is_stale(std::string const& ast_file) -> bool
+	{
+		auto status = llvm::sys::fs::file_status();
+		if (llvm::sys::fs::status(ast_file, status)) {
+			return true;
+		}
+
+		auto const files = llvm::makeIntrusiveRefCnt<clang::FileManager>(clang::FileSystemOptions());
+		auto const module_cache = llvm::makeIntrusiveRefCnt<clang::InMemoryModuleCache>();
+		auto const container_reader = clang::RawPCHContainerReader();
+		auto checker = input_checker(status.getLastModificationTime());
+
+		// An AST file that can't be read at all, such as one from a different version of Clang, is
+		// as unusable as a stale one.
+		if (clang::ASTReader::readASTFileControlBlock(
+		      ast_file,
+		      *files,
+		      *module_cache,
+		      container_reader,
+		      /*FindModuleFileExtensions=*/false,
+		      checker,
+		      /*ValidateDiagnosticOptions=*/false))
+		{
+			return true;
+		}
+
+		return checker.changed();
+	}
+
+	auto prebuilt_files::inspect(std::string const& path) -> ast_file
+	{
+		{
+			auto const lock = std::scoped_lock(mutex_);
+			if (auto const i = ast_files_.find(path); i != ast_files_.end()) {
+				return i->second;
+			}
+		}
+
+		// Checking an AST file stats everything it was built from, so it's done without holding the
+		// lock. Two translation units might both check the same file, but they'll agree.
+		auto result = ast_file{.stale = is_stale(path)};
+		if (result.stale and llvm::sys::fs::exists(path)) {
+			auto const files = llvm::makeIntrusiveRefCnt<clang::FileManager>(clang::FileSystemOptions());
+			auto ignore = clang::IgnoringDiagConsumer();
+			auto diagnostics = clang::DiagnosticsEngine(
+			  llvm::makeIntrusiveRefCnt<clang::DiagnosticIDs>(),
+			  llvm::makeIntrusiveRefCnt<clang::DiagnosticOptions>(),
+			  &ignore,
+			  /*ShouldOwnClient=*/false);
+			result.original_source = clang::ASTReader::getOriginalSourceFile(
+			  path,
+			  *files,
+			  clang::RawPCHContainerReader(),
+			  diagnostics);
+		}
+
+		auto const lock = std::scoped_lock(mutex_);
+		return ast_files_.try_emplace(path, std::move(result)).first->second;
+	}
+
+	auto prebuilt_files::adjust(
+	  tooling::CommandLineArguments const& arguments,
+	  llvm::StringRef const directory,
+	  std::string& diagnostics) -> tooling::CommandLineArguments
+	{
+		constexpr auto module_file_flag = std::string_view("-fmodule-file=");
+
+		// C++20 modules can't be replaced with their sources, so a stale module interface can only be
+		// dropped if there's somewhere else to find the module.
+		auto const has_module_path = stdr::any_of(arguments, [](std::string const& argument) {
+			return argument.starts_with("-fprebuilt-module-path");
+		});
+
+		auto result = tooling::CommandLineArguments();
+		result.reserve(arguments.size());
+		for (auto i = std::size_t{0}; i < arguments.size(); ++i) {
+			auto const& argument = arguments[i];
+			if (argument == "-include-pch") {
+				// CMake passes precompiled headers straight to the frontend, as
+				// ``-Xclang -include-pch -Xclang <file>``.
+				auto const through_frontend = not result.empty() and result.back() == "-Xclang";
+				auto const path_index = through_frontend ? i + 2 : i + 1;
+				if (path_index >= arguments.size()) {
+					result.push_back(argument);
+					continue;
+				}
+
+				auto const path = make_absolute(directory, arguments[path_index]);
+				auto const file = inspect(path);
+				if (not file.stale) {
+					result.insert(result.end(), arguments.begin() + i, arguments.begin() + path_index + 1);
+					i = path_index;
+					continue;
+				}
+
+				if (through_frontend) {
+					result.pop_back();
+				}
+
+				i = path_index;
+
+				// CMake also includes the header itself, which is skipped when the precompiled header
+				// is loaded.
+				if (file.original_source.empty()
+				    or stdr::find(arguments, file.original_source) != arguments.end())
+				{
+					diagnostics += "warning: '" + path + "' is out of date; ignoring it\n";
+					continue;
+				}
+
+				diagnostics += "warning: '" + path + "' is out of date; parsing '" + file.original_source
+				             + "' instead\n";
+				result.push_back("-include");
+				result.push_back(file.original_source);
+				continue;
+			}
+
+			if (argument.starts_with(module_file_flag)) {
+				// The flag's value is either a path, or a module name and a path separated by '='.
+				auto const value = llvm::StringRef(argument).drop_front(module_file_flag.size());
+				auto const path =
+				  make_absolute(directory, value.contains('=') ? value.split('=').second : value);
+				if (inspect(path).stale) {
+					if (not has_module_path) {
+						diagnostics += "error: '" + path
+						             + "' is out of date, and modules can't be parsed from their sources "
+						               "instead; rebuild it\n";
+						result.push_back(argument);
+						continue;
+					}
+
+					diagnostics += "warning: '" + path
+					             + "' is out of date; ignoring it, so its module is found through "
+					               "'-fprebuilt-module-path' instead\n";
+					continue;
+				}
+			}
+
+			result.push_back(argument);
+		}
+
+		return result;
+	}
+
+	auto prebuilt_files::is_claimed(std::string_view const file) const -> bool
+	{
+		auto const lock = std::scoped_lock(mutex_);
+		return claimed_.contains(file);
+	}
+
+	void prebuilt_files::claim(std::span<std::string const> const files)
+	{
+		auto const lock = std::scoped_lock(mutex_);
+		claimed_.insert(files.begin(), files.end());
+	}
+} // namespace driver
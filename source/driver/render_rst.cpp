@@ -0,0 +1,647 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+#include <ranges>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/render_rst.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace stdr = std::ranges;
+
+	using info::detached_entity;
+	using info::detached_parameter;
+	using info::detached_text;
+
+	namespace {
+		constexpr auto indent = std::string_view("   ");
+		constexpr auto hash_marker = std::string_view(".. schreiber-page-hash: ");
+
+		/// Appends ``text`` one line at a time, indenting every line but the first by ``prefix``.
+		void append_hanging(std::string& output, std::string_view text, std::string_view const prefix)
+		{
+			for (auto first = true; not text.empty(); first = false) {
+				auto const end = text.find('\n');
+				auto const line = text.substr(0, end);
+				if (not first and not line.empty()) {
+					output += prefix;
+				}
+
+				output += line;
+				output += '\n';
+				text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+			}
+		}
+
+		void
+		append_field(std::string& output, std::string_view const field, std::string_view const text)
+		{
+			output += indent;
+			output += ':';
+			output += field;
+			output += ':';
+			if (text.empty()) {
+				output += '\n';
+				return;
+			}
+
+			output += ' ';
+			append_hanging(output, text, "      ");
+		}
+
+		void append_parameters(
+		  std::string& output,
+		  std::string_view const field,
+		  std::vector<detached_parameter> const& parameters)
+		{
+			auto name = std::string();
+			for (auto const& parameter : parameters) {
+				// Parameters are already named in the declaration, so they're only listed again when
+				// there's something to say about them.
+				if (parameter.description.empty()) {
+					continue;
+				}
+
+				name.assign(field);
+				name += ' ';
+				name += parameter.name;
+				append_field(output, name, parameter.description);
+			}
+		}
+
+		/// Appends the ``template<...>`` that introduces a template with ``parameters``, so that
+		/// Sphinx indexes it as a template rather than as a plain class.
+		void
+		append_template_head(std::string& output, std::vector<detached_parameter> const& parameters)
+		{
+			output += "template<";
+			auto separator = std::string_view();
+			for (auto const& parameter : parameters) {
+				output += separator;
+				output += parameter.type;
+				if (not parameter.name.empty()) {
+					output += ' ';
+					output += parameter.name;
+				}
+
+				separator = ", ";
+			}
+			output += "> ";
+		}
+
+		void append_list(
+		  std::string& output,
+		  std::string_view const field,
+		  std::vector<detached_text> const& items)
+		{
+			if (items.empty()) {
+				return;
+			}
+
+			append_field(output, field, "");
+			for (auto const& item : items) {
+				output += "      - ";
+				append_hanging(output, item.description, "        ");
+			}
+		}
+
+		void append_literals(
+		  std::string& output,
+		  std::string_view const field,
+		  std::vector<info::interned_string> const& names)
+		{
+			if (names.empty()) {
+				return;
+			}
+
+			output += indent;
+			output += ':';
+			output += field;
+			output += ':';
+			for (auto separator = std::string_view(" "); auto const& name : names) {
+				output += separator;
+				output += "``";
+				output += name.view();
+				output += "``";
+				separator = ", ";
+			}
+
+			output += '\n';
+		}
+
+		/// Returns where the parameter list starts in a function type such as ``int (char) const``.
+		[[nodiscard]] auto parameter_list(std::string_view const type) -> std::size_t
+		{
+			auto depth = 0;
+			for (auto i = std::size_t{0}; i < type.size(); ++i) {
+				switch (type[i]) {
+				case '<':
+					++depth;
+					break;
+				case '>':
+					--depth;
+					break;
+				case '(':
+					if (depth == 0) {
+						return i;
+					}
+					break;
+				default:
+					break;
+				}
+			}
+
+			return std::string_view::npos;
+		}
+
+		/// Returns the namespace that ``qualified_name`` is declared in.
+		[[nodiscard]] auto namespace_of(std::string_view const qualified_name) -> std::string_view
+		{
+			auto const end = qualified_name.rfind("::");
+			return end == std::string_view::npos ? std::string_view() : qualified_name.substr(0, end);
+		}
+
+		/// Turns a namespace or header into a file name that Sphinx is happy with.
+		[[nodiscard]] auto page_name(std::string_view const key, std::string_view const fallback)
+		  -> std::string
+		{
+			auto result = std::string();
+			for (auto const c : key) {
+				if (llvm::isAlnum(c) or c == '_') {
+					result += c;
+				}
+				else if (not result.empty() and result.back() != '-') {
+					result += '-';
+				}
+			}
+
+			while (not result.empty() and result.back() == '-') {
+				result.pop_back();
+			}
+
+			return result.empty() ? std::string(fallback) : result;
+		}
+
+		/// Maps the USR of each entity that another entity inherits its documentation from to that
+		/// entity.
+		using inherited_map = absl::flat_hash_map<std::string_view, detached_entity const*>;
+
+		[[nodiscard]] auto map_inherited(std::span<detached_entity const* const> const entities)
+		  -> inherited_map
+		{
+			auto result = inherited_map();
+			for (auto const* const entity : entities) {
+				if (not entity->inherits_from.empty()) {
+					result.try_emplace(entity->inherits_from, nullptr);
+				}
+			}
+
+			if (result.empty()) {
+				return result;
+			}
+
+			for (auto const* const entity : entities) {
+				if (auto const i = result.find(entity->usr); i != result.end()) {
+					i->second = entity;
+				}
+			}
+
+			return result;
+		}
+
+		/// Returns the entity whose documentation is rendered for ``entity``. An entity whose base
+		/// member wasn't extracted is rendered without documentation.
+		[[nodiscard]] auto
+		documentation_of(detached_entity const& entity, inherited_map const& inherited)
+		  -> detached_entity const*
+		{
+			if (entity.inherits_from.empty()) {
+				return &entity;
+			}
+
+			auto const i = inherited.find(entity.inherits_from);
+			return i != inherited.end() ? i->second : nullptr;
+		}
+
+		struct page {
+			std::string key;
+			std::string name;
+			std::vector<detached_entity const*> entities;
+			std::uint64_t hash = 0;
+		};
+
+		/// Hashes everything that's rendered on a page without rendering it. Inherited documentation
+		/// is hashed by its entity's ``content_hash``, so the page changes along with the base member.
+		[[nodiscard]] auto page_hash(page const& p, inherited_map const& inherited) -> std::uint64_t
+		{
+			auto signature = std::string(p.key);
+			for (auto const* const entity : p.entities) {
+				if (auto const* const documented = documentation_of(*entity, inherited);
+				    documented != nullptr and documented != entity)
+				{
+					signature += '\0';
+					signature += llvm::utohexstr(documented->content_hash);
+				}
+
+				signature += '\0';
+				signature += entity->usr;
+				signature += '\0';
+				signature += entity->qualified_name;
+				signature += '\0';
+				signature += entity->type;
+				signature += '\0';
+				signature += llvm::utohexstr(entity->content_hash);
+			}
+
+			return llvm::xxh3_64bits(signature);
+		}
+
+		[[nodiscard]] auto group_pages(
+		  std::span<detached_entity const* const> const entities,
+		  page_grouping const grouping,
+		  inherited_map const& inherited) -> std::vector<page>
+		{
+			auto pages = absl::flat_hash_map<std::string, page>();
+			auto const add = [&pages](std::string_view const key, detached_entity const* const entity) {
+				auto& p = pages[std::string(key)];
+				p.entities.push_back(entity);
+			};
+
+			for (auto const* const entity : entities) {
+				if (grouping == page_grouping::by_namespace) {
+					add(namespace_of(entity->qualified_name), entity);
+					continue;
+				}
+
+				if (entity->headers.empty()) {
+					add("", entity);
+				}
+
+				for (auto const& header : entity->headers) {
+					add(header.view(), entity);
+				}
+			}
+
+			auto result = std::vector<page>();
+			result.reserve(pages.size());
+			for (auto& [key, p] : pages) {
+				p.key = key;
+				result.push_back(std::move(p));
+			}
+
+			stdr::sort(result, {}, &page::key);
+
+			auto const fallback = grouping == page_grouping::by_namespace ? "global" : "other";
+			auto names = absl::flat_hash_map<std::string, int>();
+			names["index"] = 1;
+			for (auto& p : result) {
+				p.name = page_name(p.key, fallback);
+				if (auto const count = ++names[p.name]; count > 1) {
+					p.name += '-' + std::to_string(count);
+				}
+
+				stdr::stable_sort(p.entities, [](detached_entity const* x, detached_entity const* y) {
+					return std::tie(x->qualified_name, x->usr) < std::tie(y->qualified_name, y->usr);
+				});
+				p.hash = page_hash(p, inherited);
+			}
+
+			return result;
+		}
+
+		void append_title(std::string& output, std::string_view const title)
+		{
+			output += title;
+			output += '\n';
+			output.append(title.size(), '=');
+			output += "\n\n";
+		}
+
+		void render_page(
+		  std::string& output,
+		  page const& p,
+		  page_grouping const grouping,
+		  inherited_map const& inherited)
+		{
+			auto title = std::string();
+			if (p.key.empty()) {
+				title = grouping == page_grouping::by_namespace ? "Global namespace" : "Other declarations";
+			}
+			else {
+				title = "``" + p.key + "``";
+			}
+
+			append_title(output, title);
+			for (auto const* const entity : p.entities) {
+				render_entity(output, *entity, documentation_of(*entity, inherited));
+			}
+		}
+
+		/// Returns the hash that ``path`` was rendered with, or an empty string if it wasn't rendered
+		/// by ``render_pages``.
+		[[nodiscard]] auto read_page_hash(std::string const& path) -> std::string
+		{
+			auto file = std::ifstream(path);
+			auto line = std::string();
+			if (not std::getline(file, line) or not line.starts_with(hash_marker)) {
+				return {};
+			}
+
+			return line.substr(hash_marker.size());
+		}
+
+		[[nodiscard]] auto is_current(std::string const& path, std::uint64_t const hash) -> bool
+		{
+			return read_page_hash(path) == llvm::utohexstr(hash);
+		}
+
+		[[nodiscard]] auto write_page(std::string const& path, std::string const& text)
+		  -> std::expected<void, std::string>
+		{
+			auto error = std::error_code();
+			auto os = llvm::raw_fd_ostream(path, error);
+			if (error) {
+				return std::unexpected("unable to open '" + path + "': " + error.message());
+			}
+
+			// A page is written with a single call rather than through the stream's small buffer.
+			os.SetUnbuffered();
+			os << text;
+			os.close();
+			if (os.has_error()) {
+				auto const message = os.error().message();
+				os.clear_error();
+				return std::unexpected("unable to write '" + path + "': " + message);
+			}
+
+			return {};
+		}
+
+		/// Renders each out-of-date page into a reused buffer and writes it in one go.
+		class page_writer {
+		public:
+			page_writer(
+			  std::string_view const directory,
+			  page_grouping const grouping,
+			  inherited_map const& inherited)
+			: directory_(directory)
+			, grouping_(grouping)
+			, inherited_(&inherited)
+			{}
+
+			/// Returns ``true`` if the page was written, and ``false`` if it was already current.
+			[[nodiscard]] auto write(page const& p) -> std::expected<bool, std::string>
+			{
+				auto path = llvm::SmallString<256>(directory_);
+				llvm::sys::path::append(path, p.name + ".rst");
+				if (is_current(path.str().str(), p.hash)) {
+					return false;
+				}
+
+				buffer_.clear();
+				buffer_ += hash_marker;
+				buffer_ += llvm::utohexstr(p.hash);
+				buffer_ += "\n\n";
+				render_page(buffer_, p, grouping_, *inherited_);
+				if (auto written = write_page(path.str().str(), buffer_); not written) {
+					return std::unexpected(std::move(written).error());
+				}
+
+				return true;
+			}
+		private:
+			std::string_view directory_;
+			page_grouping grouping_;
+			inherited_map const* inherited_;
+			std::string buffer_;
+		};
+
+		/// Removes the pages in ``directory`` that were rendered before, but aren't rendered any
+		/// more, such as the page for a namespace that's gone. Files without a page hash weren't
+		/// rendered by ``render_pages``, so they're left alone.
+		///
+		/// \returns The number of pages that were removed.
+		[[nodiscard]] auto
+		remove_stale_pages(std::string_view const directory, std::span<page const> const pages)
+		  -> std::expected<std::size_t, std::string>
+		{
+			auto current = llvm::StringSet<>();
+			current.insert("index.rst");
+			for (auto const& p : pages) {
+				current.insert(p.name + ".rst");
+			}
+
+			auto removed = std::size_t{0};
+			auto error = std::error_code();
+			for (auto i = llvm::sys::fs::directory_iterator(directory, error);
+			     i != llvm::sys::fs::directory_iterator() and not error;
+			     i.increment(error))
+			{
+				auto const& path = i->path();
+				auto const name = llvm::sys::path::filename(path);
+				if (llvm::sys::path::extension(name) != ".rst" or current.contains(name)
+				    or read_page_hash(path).empty())
+				{
+					continue;
+				}
+
+				if (auto const remove_error = llvm::sys::fs::remove(path)) {
+					return std::unexpected("unable to remove '" + path + "': " + remove_error.message());
+				}
+
+				++removed;
+			}
+
+			if (error) {
+				return std::unexpected(
+				  "unable to read '" + std::string(directory) + "': " + error.message());
+			}
+
+			return removed;
+		}
+	} // namespace
+
+	void render_entity(std::string& output, detached_entity const& entity)
+	{
+		render_entity(output, entity, &entity);
+	}
+
+	void render_entity(
+	  std::string& output,
+	  detached_entity const& entity,
+	  detached_entity const* const documented)
+	{
+		if (entity.kind == detached_entity::entity_kind::record
+		    or entity.kind == detached_entity::entity_kind::class_template)
+		{
+			output += ".. cpp:";
+			output += entity.type;
+			output += ":: ";
+			if (not entity.template_parameters.empty()) {
+				append_template_head(output, entity.template_parameters);
+			}
+
+			output += entity.qualified_name;
+		}
+		else if (auto const i = parameter_list(entity.type); i != std::string_view::npos) {
+			output += ".. cpp:function:: ";
+			auto return_type = entity.type.substr(0, i);
+			while (return_type.ends_with(' ')) {
+				return_type.remove_suffix(1);
+			}
+
+			output += return_type;
+			output += ' ';
+			output += entity.qualified_name;
+			output += entity.type.substr(i);
+		}
+		else {
+			output += ".. cpp:function:: ";
+			output += entity.qualified_name;
+		}
+
+		output += "\n\n";
+
+		// Only the declaration is the entity's own when it inherits its documentation.
+		static auto const undocumented = detached_entity();
+		auto const& docs = documented != nullptr ? *documented : undocumented;
+		if (not docs.documentation.description.empty()) {
+			output += indent;
+			append_hanging(output, docs.documentation.description, indent);
+			output += '\n';
+		}
+
+		auto const fields_begin = output.size();
+		append_parameters(output, "tparam", docs.template_parameters);
+		append_parameters(output, "param", docs.parameters);
+		if (docs.returns.has_value()) {
+			append_field(output, "returns", docs.returns->description);
+		}
+
+		auto throws = std::string();
+		for (auto const& exception : docs.throws) {
+			throws.assign("throws ");
+			throws += exception.type;
+			append_field(output, throws, exception.description);
+		}
+
+		append_list(output, "Preconditions", docs.preconditions);
+		append_list(output, "Postconditions", docs.postconditions);
+		append_list(output, "Exits via", docs.exits_via);
+		append_literals(output, "Headers", entity.headers);
+		append_literals(output, "Modules", entity.modules);
+		if (output.size() != fields_begin) {
+			output += '\n';
+		}
+	}
+
+	auto render_pages(
+	  std::span<detached_entity const* const> const entities,
+	  std::string_view const directory,
+	  render_options const& options) -> std::expected<render_result, std::string>
+	{
+		if (auto const error = llvm::sys::fs::create_directories(directory)) {
+			return std::unexpected(
+			  "unable to create '" + std::string(directory) + "': " + error.message());
+		}
+
+		auto const inherited = map_inherited(entities);
+		auto const pages = group_pages(entities, options.grouping, inherited);
+		auto written = std::atomic<std::size_t>(0);
+		auto errors = std::vector<std::string>(pages.size());
+		{
+			auto next = std::atomic<std::size_t>(0);
+			auto const worker = [&] {
+				auto writer = page_writer(directory, options.grouping, inherited);
+				for (auto i = next++; i < pages.size(); i = next++) {
+					auto const result = writer.write(pages[i]);
+					if (not result) {
+						errors[i] = result.error();
+					}
+					else if (*result) {
+						++written;
+					}
+				}
+			};
+
+			auto const jobs =
+			  std::clamp<std::size_t>(options.jobs, 1, std::max<std::size_t>(pages.size(), 1));
+			auto workers = std::vector<std::jthread>();
+			workers.reserve(jobs);
+			for (auto i = std::size_t{0}; i < jobs; ++i) {
+				workers.emplace_back(worker);
+			}
+		}
+
+		auto const error = stdr::find_if(errors, [](std::string const& e) { return not e.empty(); });
+		if (error != errors.end()) {
+			return std::unexpected(*error);
+		}
+
+		auto const removed = remove_stale_pages(directory, pages);
+		if (not removed) {
+			return std::unexpected(removed.error());
+		}
+
+		auto result = render_result{
+		  .pages_written = written,
+		  .pages_unchanged = pages.size() - written,
+		  .pages_removed = *removed,
+		};
+
+		// The index only changes when pages are added or removed.
+		auto names = std::string();
+		for (auto const& p : pages) {
+			names += p.name;
+			names += '\n';
+		}
+
+		auto const index_hash = llvm::xxh3_64bits(names);
+		auto path = llvm::SmallString<256>(directory);
+		llvm::sys::path::append(path, "index.rst");
+		if (is_current(path.str().str(), index_hash)) {
+			++result.pages_unchanged;
+			return result;
+		}
+
+		auto text = std::string(hash_marker) + llvm::utohexstr(index_hash) + "\n\n";
+		append_title(text, "API reference");
+		text += ".. toctree::\n";
+		text += indent;
+		text += ":maxdepth: 1\n\n";
+		for (auto const& p : pages) {
+			text += indent;
+			text += p.name;
+			text += '\n';
+		}
+
+		if (auto const index_written = write_page(path.str().str(), text); not index_written) {
+			return std::unexpected(index_written.error());
+		}
+
+		++result.pages_written;
+		return result;
+	}
+} // namespace driver
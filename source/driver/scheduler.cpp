@@ -0,0 +1,237 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <expected>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <schreiber/scheduler.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace stdr = std::ranges;
+	namespace tooling = clang::tooling;
+
+	using std::chrono::milliseconds;
+
+	auto timing_history::load(std::string const& path) -> std::expected<timing_history, std::string>
+	{
+		auto result = timing_history();
+		auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+		if (not buffer) {
+			if (buffer.getError() == std::errc::no_such_file_or_directory) {
+				return result;
+			}
+
+			return std::unexpected("unable to read '" + path + "': " + buffer.getError().message());
+		}
+
+		auto lines = llvm::SmallVector<llvm::StringRef>();
+		(*buffer)->getBuffer().split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+		for (auto const line : lines) {
+			auto const [count, file] = line.split('\t');
+			auto elapsed = milliseconds::rep();
+			auto const [end, error] = std::from_chars(count.begin(), count.end(), elapsed);
+			if (error != std::errc() or end != count.end() or file.empty()) {
+				return std::unexpected("'" + path + "' isn't a timing history");
+			}
+
+			result.durations_.insert_or_assign(file.str(), milliseconds(elapsed));
+		}
+
+		return result;
+	}
+
+	auto timing_history::save(std::string const& path) const -> std::expected<void, std::string>
+	{
+		auto sorted = std::vector<std::pair<std::string_view, milliseconds>>(
+		  durations_.begin(),
+		  durations_.end());
+		stdr::sort(sorted);
+
+		auto error = std::error_code();
+		auto os = llvm::raw_fd_ostream(path, error, llvm::sys::fs::OF_Text);
+		if (error) {
+			return std::unexpected("unable to write '" + path + "': " + error.message());
+		}
+
+		for (auto const& [file, elapsed] : sorted) {
+			os << elapsed.count() << '\t' << file << '\n';
+		}
+
+		return {};
+	}
+
+	auto timing_history::find(std::string_view const file) const -> std::optional<milliseconds>
+	{
+		auto const i = durations_.find(std::string(file));
+		return i != durations_.end() ? std::optional(i->second) : std::nullopt;
+	}
+
+	void timing_history::record(std::string_view const file, milliseconds const elapsed)
+	{
+		auto const [i, inserted] = durations_.try_emplace(std::string(file), elapsed);
+		if (not inserted) {
+			i->second = (i->second + elapsed) / 2;
+		}
+	}
+
+	auto timing_history::size() const noexcept -> std::size_t
+	{
+		return durations_.size();
+	}
+
+	auto main_file_path(tooling::CompileCommand const& command) -> std::string
+	{
+		auto path = llvm::SmallString<256>(command.Directory);
+		llvm::sys::path::append(path, command.Filename);
+		llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/false);
+		return path.str().str();
+	}
+
+	namespace {
+		/// Roughly how many bytes of source each ``#include`` in a main file is worth. Most of a
+		/// translation unit's cost is in its headers, so this dominates the main file's own size.
+		constexpr auto include_weight = 32.0 * 1024;
+
+		/// Estimates the cost of a translation unit that has no history, from its main file alone.
+		[[nodiscard]] auto estimate_cost(std::string const& path) -> double
+		{
+			auto const buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+			if (not buffer) {
+				return 0;
+			}
+
+			auto const text = (*buffer)->getBuffer();
+			auto includes = std::size_t{0};
+			for (auto position = text.find("#include"); position != llvm::StringRef::npos;
+			     position = text.find("#include", position + 1))
+			{
+				++includes;
+			}
+
+			return static_cast<double>(text.size()) + include_weight * static_cast<double>(includes);
+		}
+	} // namespace
+
+	auto estimate_costs(std::span<tooling::CompileCommand const> const commands, timing_history const* history)
+	  -> std::vector<double>
+	{
+		auto costs = std::vector<double>(commands.size());
+		auto estimates = std::vector<std::optional<double>>(commands.size());
+		auto measured = 0.0;
+		auto estimated = 0.0;
+		for (auto i = std::size_t{0}; i < commands.size(); ++i) {
+			auto const path = main_file_path(commands[i]);
+			auto const elapsed = history != nullptr ? history->find(path) : std::nullopt;
+			if (elapsed.has_value()) {
+				costs[i] = static_cast<double>(elapsed->count());
+				if (auto const estimate = estimate_cost(path); estimate > 0) {
+					measured += costs[i];
+					estimated += estimate;
+				}
+			}
+			else {
+				estimates[i] = estimate_cost(path);
+			}
+		}
+
+		// The estimates are in bytes and the history is in milliseconds, so we use the translation
+		// units that have both to convert between them.
+		auto const scale = estimated > 0 ? measured / estimated : 1.0;
+		for (auto i = std::size_t{0}; i < commands.size(); ++i) {
+			if (estimates[i].has_value()) {
+				costs[i] = *estimates[i] * scale;
+			}
+		}
+
+		return costs;
+	}
+
+	auto longest_first(std::span<double const> const costs) -> std::vector<std::size_t>
+	{
+		auto order = std::vector<std::size_t>(costs.size());
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		stdr::stable_sort(order, stdr::greater(), [costs](std::size_t const i) { return costs[i]; });
+		return order;
+	}
+
+	work_queue::work_queue(std::span<double const> const costs, std::size_t const workers)
+	: costs_(costs.begin(), costs.end())
+	, worker_count_(std::max(workers, std::size_t{1}))
+	, deques_(std::make_unique<worker_deque[]>(worker_count_))
+	{
+		auto const order = longest_first(costs_);
+		for (auto i = std::size_t{0}; i < order.size(); ++i) {
+			auto& deque = deques_[i % worker_count_];
+			deque.jobs.push_back(order[i]);
+			deque.remaining += costs_[order[i]];
+		}
+	}
+
+	auto work_queue::pop_front(worker_deque& deque) -> std::optional<std::size_t>
+	{
+		auto const lock = std::scoped_lock(deque.mutex);
+		if (deque.jobs.empty()) {
+			return std::nullopt;
+		}
+
+		auto const job = deque.jobs.front();
+		deque.jobs.pop_front();
+		deque.remaining -= costs_[job];
+		return job;
+	}
+
+	auto work_queue::pop(std::size_t const worker) -> std::optional<std::size_t>
+	{
+		if (auto const job = pop_front(deques_[worker % worker_count_])) {
+			return job;
+		}
+
+		// Jobs are never added, so a victim that's emptied between choosing it and locking it just
+		// means looking again.
+		while (true) {
+			auto victim = static_cast<worker_deque*>(nullptr);
+			auto most = 0.0;
+			for (auto i = std::size_t{0}; i < worker_count_; ++i) {
+				auto& deque = deques_[i];
+				auto const lock = std::scoped_lock(deque.mutex);
+				if (deque.jobs.empty()) {
+					continue;
+				}
+
+				if (victim == nullptr or deque.remaining > most) {
+					victim = &deque;
+					most = deque.remaining;
+				}
+			}
+
+			if (victim == nullptr) {
+				return std::nullopt;
+			}
+
+			if (auto const job = pop_front(*victim)) {
+				return job;
+			}
+		}
+	}
+} // namespace driver
@@ -0,0 +1,641 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <ranges>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/import_index.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <schreiber/serialise.hpp>
+#include <schreiber/string_interner.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace json = llvm::json;
+	namespace stdr = std::ranges;
+
+	using info::detached_entity;
+	using info::detached_exception;
+	using info::detached_location;
+	using info::detached_parameter;
+	using info::detached_reference;
+	using info::detached_text;
+	using info::detached_translation_unit;
+
+	namespace {
+		[[nodiscard]] auto to_json(std::string_view const s) -> json::Value
+		{
+			auto const ref = llvm::StringRef(s.data(), s.size());
+			return json::isUTF8(ref) ? json::Value(ref) : json::Value(json::fixUTF8(ref));
+		}
+
+		void write(json::OStream& writer, detached_location const& location)
+		{
+			writer.object([&] {
+				writer.attribute("file", to_json(location.file));
+				writer.attribute("line", location.line);
+				writer.attribute("column", location.column);
+			});
+		}
+
+		void write(json::OStream& writer, detached_text const& text)
+		{
+			writer.object([&] {
+				writer.attribute("description", to_json(text.description));
+				writer.attributeBegin("location");
+				write(writer, text.location);
+				writer.attributeEnd();
+			});
+		}
+
+		void write(json::OStream& writer, detached_parameter const& parameter)
+		{
+			writer.object([&] {
+				writer.attribute("name", to_json(parameter.name));
+				writer.attribute("type", to_json(parameter.type));
+				writer.attribute("description", to_json(parameter.description));
+				writer.attributeBegin("location");
+				write(writer, parameter.location);
+				writer.attributeEnd();
+			});
+		}
+
+		void write(json::OStream& writer, detached_exception const& exception)
+		{
+			writer.object([&] {
+				writer.attribute("type", to_json(exception.type));
+				writer.attribute("type_usr", to_json(exception.type_usr));
+				writer.attribute("description", to_json(exception.description));
+				writer.attributeBegin("location");
+				write(writer, exception.location);
+				writer.attributeEnd();
+			});
+		}
+
+		void write(json::OStream& writer, detached_reference const& reference)
+		{
+			writer.object([&] {
+				writer.attribute("name", to_json(reference.name));
+				writer.attribute("usr", to_json(reference.usr));
+			});
+		}
+
+		template<class T>
+		void write(json::OStream& writer, llvm::StringRef const key, std::vector<T> const& values)
+		{
+			writer.attributeArray(key, [&] {
+				for (auto const& value : values) {
+					if constexpr (std::same_as<T, info::interned_string>) {
+						writer.value(to_json(value.view()));
+					}
+					else {
+						write(writer, value);
+					}
+				}
+			});
+		}
+
+		[[nodiscard]] auto to_string(detached_entity::entity_kind const kind) -> llvm::StringRef
+		{
+			switch (kind) {
+			case detached_entity::entity_kind::function:
+				return "function";
+			case detached_entity::entity_kind::function_template:
+				return "function_template";
+			case detached_entity::entity_kind::record:
+				return "record";
+			case detached_entity::entity_kind::class_template:
+				return "class_template";
+			}
+		}
+
+		[[nodiscard]] auto to_string(translation_unit_result::status_t const status) -> llvm::StringRef
+		{
+			switch (status) {
+			case translation_unit_result::status_t::ok:
+				return "ok";
+			case translation_unit_result::status_t::failed:
+				return "failed";
+			case translation_unit_result::status_t::crashed:
+				return "crashed";
+			case translation_unit_result::status_t::timed_out:
+				return "timed_out";
+			}
+		}
+
+		// JSON numbers can't hold every 64-bit integer, so hashes are written as hexadecimal strings.
+		[[nodiscard]] auto to_hex(std::uint64_t const hash) -> std::string
+		{
+			return llvm::utohexstr(hash, /*LowerCase=*/true, /*Width=*/16);
+		}
+
+		[[nodiscard]] auto read_hash(json::Object const& object) -> std::optional<std::uint64_t>
+		{
+			auto const value = object.getString("hash");
+			auto hash = std::uint64_t{0};
+			if (not value.has_value() or value->getAsInteger(16, hash)) {
+				return std::nullopt;
+			}
+
+			return hash;
+		}
+
+		[[nodiscard]] auto
+		read_string(json::Object const& object, llvm::StringRef const key, detached_translation_unit& unit)
+		  -> std::string_view
+		{
+			auto const value = object.getString(key);
+			return value.has_value() ? unit.intern(*value) : std::string_view();
+		}
+
+		[[nodiscard]] auto read_location(json::Object const* const object, detached_translation_unit& unit)
+		  -> detached_location
+		{
+			if (object == nullptr) {
+				return {};
+			}
+
+			return detached_location{
+			  .file = read_string(*object, "file", unit),
+			  .line = static_cast<unsigned>(object->getInteger("line").value_or(0)),
+			  .column = static_cast<unsigned>(object->getInteger("column").value_or(0)),
+			};
+		}
+
+		[[nodiscard]] auto read_text(json::Object const& object, detached_translation_unit& unit)
+		  -> detached_text
+		{
+			return detached_text{
+			  .description = read_string(object, "description", unit),
+			  .location = read_location(object.getObject("location"), unit),
+			};
+		}
+
+		[[nodiscard]] auto read_parameter(json::Object const& object, detached_translation_unit& unit)
+		  -> detached_parameter
+		{
+			return detached_parameter{
+			  .name = read_string(object, "name", unit),
+			  .type = read_string(object, "type", unit),
+			  .description = read_string(object, "description", unit),
+			  .location = read_location(object.getObject("location"), unit),
+			};
+		}
+
+		[[nodiscard]] auto read_exception(json::Object const& object, detached_translation_unit& unit)
+		  -> detached_exception
+		{
+			return detached_exception{
+			  .type = read_string(object, "type", unit),
+			  .type_usr = read_string(object, "type_usr", unit),
+			  .description = read_string(object, "description", unit),
+			  .location = read_location(object.getObject("location"), unit),
+			};
+		}
+
+		[[nodiscard]] auto read_reference(json::Object const& object, detached_translation_unit& unit)
+		  -> detached_reference
+		{
+			return detached_reference{
+			  .name = read_string(object, "name", unit),
+			  .usr = read_string(object, "usr", unit),
+			};
+		}
+
+		template<class T>
+		[[nodiscard]] auto read_array(
+		  json::Object const& object,
+		  llvm::StringRef const key,
+		  detached_translation_unit& unit,
+		  std::vector<T>& result) -> std::expected<void, std::string>
+		{
+			auto const array = object.getArray(key);
+			if (array == nullptr) {
+				return {};
+			}
+
+			result.reserve(array->size());
+			for (auto const& value : *array) {
+				if constexpr (std::same_as<T, info::interned_string>) {
+					auto const s = value.getAsString();
+					if (not s.has_value()) {
+						return std::unexpected("expected '" + key.str() + "' to be an array of strings");
+					}
+					result.push_back(unit.interner().intern(*s));
+				}
+				else {
+					auto const element = value.getAsObject();
+					if (element == nullptr) {
+						return std::unexpected("expected '" + key.str() + "' to be an array of objects");
+					}
+
+					if constexpr (std::same_as<T, detached_parameter>) {
+						result.push_back(read_parameter(*element, unit));
+					}
+					else if constexpr (std::same_as<T, detached_exception>) {
+						result.push_back(read_exception(*element, unit));
+					}
+					else if constexpr (std::same_as<T, detached_reference>) {
+						result.push_back(read_reference(*element, unit));
+					}
+					else {
+						result.push_back(read_text(*element, unit));
+					}
+				}
+			}
+
+			return {};
+		}
+	} // namespace
+
+	void serialise(json::OStream& writer, detached_entity const& entity)
+	{
+		writer.object([&] {
+			writer.attribute("usr", to_json(entity.usr));
+			writer.attribute("hash", to_hex(entity.content_hash));
+			writer.attribute("kind", to_string(entity.kind));
+			writer.attribute("name", to_json(entity.name));
+			writer.attribute("qualified_name", to_json(entity.qualified_name));
+			writer.attribute("type", to_json(entity.type));
+			writer.attributeBegin("location");
+			write(writer, entity.location);
+			writer.attributeEnd();
+			writer.attributeBegin("documentation");
+			write(writer, entity.documentation);
+			writer.attributeEnd();
+			write(writer, "headers", entity.headers);
+			write(writer, "modules", entity.modules);
+			write(writer, "template_parameters", entity.template_parameters);
+			write(writer, "parameters", entity.parameters);
+			if (entity.returns.has_value()) {
+				writer.attributeBegin("returns");
+				write(writer, *entity.returns);
+				writer.attributeEnd();
+			}
+			write(writer, "preconditions", entity.preconditions);
+			write(writer, "postconditions", entity.postconditions);
+			write(writer, "throws", entity.throws);
+			write(writer, "exits_via", entity.exits_via);
+			write(writer, "references", entity.references);
+			if (not entity.inherits_from.empty()) {
+				writer.attribute("inherits_from", to_json(entity.inherits_from));
+			}
+		});
+	}
+
+	auto deserialise_entity(json::Value const& value, detached_translation_unit& unit)
+	  -> std::expected<detached_entity, std::string>
+	{
+		auto const object = value.getAsObject();
+		if (object == nullptr) {
+			return std::unexpected("expected an entity to be an object");
+		}
+
+		auto const kind = object->getString("kind");
+		if (not kind.has_value()) {
+			return std::unexpected("entity is missing its 'kind'");
+		}
+
+		auto result = detached_entity{
+		  .usr = read_string(*object, "usr", unit),
+		  .name = read_string(*object, "name", unit),
+		  .qualified_name = read_string(*object, "qualified_name", unit),
+		  .type = read_string(*object, "type", unit),
+		  .location = read_location(object->getObject("location"), unit),
+		  .inherits_from = read_string(*object, "inherits_from", unit),
+		  .content_hash = read_hash(*object).value_or(0),
+		};
+
+		if (*kind == "function") {
+			result.kind = detached_entity::entity_kind::function;
+		}
+		else if (*kind == "function_template") {
+			result.kind = detached_entity::entity_kind::function_template;
+		}
+		else if (*kind == "record") {
+			result.kind = detached_entity::entity_kind::record;
+		}
+		else if (*kind == "class_template") {
+			result.kind = detached_entity::entity_kind::class_template;
+		}
+		else {
+			return std::unexpected("unknown entity kind '" + kind->str() + "'");
+		}
+
+		if (auto const documentation = object->getObject("documentation")) {
+			result.documentation = read_text(*documentation, unit);
+		}
+
+		if (auto const returns = object->getObject("returns")) {
+			result.returns = read_text(*returns, unit);
+		}
+
+		auto arrays_read = std::expected<void, std::string>();
+		auto const read = [&](llvm::StringRef const key, auto& values) {
+			if (arrays_read) {
+				arrays_read = read_array(*object, key, unit, values);
+			}
+		};
+		read("headers", result.headers);
+		read("modules", result.modules);
+		read("template_parameters", result.template_parameters);
+		read("parameters", result.parameters);
+		read("preconditions", result.preconditions);
+		read("postconditions", result.postconditions);
+		read("throws", result.throws);
+		read("exits_via", result.exits_via);
+		read("references", result.references);
+		if (not arrays_read) {
+			return std::unexpected(std::move(arrays_read).error());
+		}
+
+		return result;
+	}
+
+	void serialise(llvm::raw_ostream& os, translation_unit_result const& result)
+	{
+		{
+			auto writer = json::OStream(os);
+			writer.object([&] {
+				writer.attribute("file", to_json(result.file));
+				writer.attribute("status", to_string(result.status));
+				writer.attribute("diagnostics", to_json(result.diagnostics));
+				writer.attribute("elapsed_ms", result.elapsed.count());
+				writer.attribute("ast_bytes", static_cast<std::int64_t>(result.ast_bytes));
+				writer.attributeObject("memory", [&] {
+					for (auto i = std::size_t{0}; i < memory_stats::category_count; ++i) {
+						auto const c = static_cast<memory_stats::category>(i);
+						auto const& usage = result.memory[c];
+						if (usage == memory_stats::usage()) {
+							continue;
+						}
+
+						writer.attributeObject(to_string(c), [&] {
+							writer.attribute("count", static_cast<std::int64_t>(usage.count));
+							writer.attribute("bytes", static_cast<std::int64_t>(usage.bytes));
+							writer.attribute("peak", static_cast<std::int64_t>(usage.peak));
+						});
+					}
+				});
+				writer.attributeArray("entities", [&] {
+					for (auto const& entity : result.unit.entities()) {
+						serialise(writer, entity);
+					}
+				});
+			});
+		}
+		os << '\n';
+	}
+
+	auto deserialise_translation_unit(std::string_view const text, info::string_interner& interner)
+	  -> std::expected<translation_unit_result, std::string>
+	{
+		auto value = json::parse(llvm::StringRef(text.data(), text.size()));
+		if (not value) {
+			return std::unexpected(llvm::toString(value.takeError()));
+		}
+
+		auto const object = value->getAsObject();
+		if (object == nullptr) {
+			return std::unexpected("expected a translation unit to be an object");
+		}
+
+		auto const file = object->getString("file");
+		if (not file.has_value()) {
+			return std::unexpected("translation unit is missing its 'file'");
+		}
+
+		auto result = translation_unit_result{
+		  .file = file->str(),
+		  .diagnostics = object->getString("diagnostics").value_or("").str(),
+		  .unit = detached_translation_unit(*file, interner),
+		};
+
+		result.elapsed = std::chrono::milliseconds(object->getInteger("elapsed_ms").value_or(0));
+		result.ast_bytes = static_cast<std::size_t>(object->getInteger("ast_bytes").value_or(0));
+		if (auto const memory = object->getObject("memory")) {
+			for (auto i = std::size_t{0}; i < memory_stats::category_count; ++i) {
+				auto const c = static_cast<memory_stats::category>(i);
+				auto const usage = memory->getObject(to_string(c));
+				if (usage == nullptr) {
+					continue;
+				}
+
+				auto const read = [usage](llvm::StringRef const key) {
+					return static_cast<std::size_t>(usage->getInteger(key).value_or(0));
+				};
+				result.memory.set(
+				  c,
+				  {.count = read("count"), .bytes = read("bytes"), .peak = read("peak")});
+			}
+		}
+
+		auto const status = object->getString("status").value_or("");
+		if (status == "failed") {
+			result.status = translation_unit_result::status_t::failed;
+		}
+		else if (status == "crashed") {
+			result.status = translation_unit_result::status_t::crashed;
+		}
+		else if (status == "timed_out") {
+			result.status = translation_unit_result::status_t::timed_out;
+		}
+
+		if (auto const entities = object->getArray("entities")) {
+			for (auto const& entity : *entities) {
+				auto detached = deserialise_entity(entity, result.unit);
+				if (not detached) {
+					return std::unexpected(std::move(detached).error());
+				}
+
+				result.unit.insert(*std::move(detached));
+			}
+		}
+
+		return result;
+	}
+
+	auto unique_entities(std::span<translation_unit_result const> const results)
+	  -> std::vector<detached_entity const*>
+	{
+		auto entities = std::vector<detached_entity const*>();
+		for (auto const& result : results) {
+			for (auto const& entity : result.unit.entities()) {
+				entities.push_back(&entity);
+			}
+		}
+
+		stdr::stable_sort(entities, {}, &detached_entity::usr);
+
+		// Entities declared in headers are extracted once per translation unit that includes them,
+		// so we only keep the first one that we see.
+		auto const duplicates =
+		  stdr::unique(entities, [](detached_entity const* const x, detached_entity const* const y) {
+			  return not x->usr.empty() and x->usr == y->usr;
+		  });
+		entities.erase(duplicates.begin(), duplicates.end());
+		return entities;
+	}
+
+	void write_entities(llvm::raw_ostream& os, std::span<translation_unit_result const> const results)
+	{
+		for (auto const entity : unique_entities(results)) {
+			{
+				auto writer = json::OStream(os);
+				serialise(writer, *entity);
+			}
+			os << '\n';
+		}
+	}
+
+	void write_manifest(llvm::raw_ostream& os, std::span<translation_unit_result const> const results)
+	{
+		for (auto const entity : unique_entities(results)) {
+			if (entity->usr.empty()) {
+				continue;
+			}
+
+			{
+				auto writer = json::OStream(os);
+				writer.object([&] {
+					writer.attribute("usr", to_json(entity->usr));
+					writer.attribute("hash", to_hex(entity->content_hash));
+				});
+			}
+			os << '\n';
+		}
+	}
+
+	auto read_manifest(std::string_view const text) -> std::expected<content_manifest, std::string>
+	{
+		auto result = content_manifest();
+		auto rest = llvm::StringRef(text.data(), text.size());
+		for (auto line_number = 1; not rest.empty(); ++line_number) {
+			auto line = llvm::StringRef();
+			std::tie(line, rest) = rest.split('\n');
+			if (line.trim().empty()) {
+				continue;
+			}
+
+			auto const error = [line_number](std::string_view const message) {
+				return std::unexpected("line " + std::to_string(line_number) + " of the manifest "
+				                       + std::string(message));
+			};
+
+			auto value = json::parse(line);
+			if (not value) {
+				return error("isn't JSON: " + llvm::toString(value.takeError()));
+			}
+
+			auto const object = value->getAsObject();
+			auto const usr = object != nullptr ? object->getString("usr") : std::nullopt;
+			auto const hash = object != nullptr ? read_hash(*object) : std::nullopt;
+			if (not usr.has_value() or not hash.has_value()) {
+				return error("needs a 'usr' and a hexadecimal 'hash'");
+			}
+
+			result.insert_or_assign(usr->str(), *hash);
+		}
+
+		return result;
+	}
+
+	void write_imports(llvm::raw_ostream& os, std::span<detached_entity const* const> const entities)
+	{
+		auto index = info::import_index();
+		for (auto id = info::import_index::entity_id{0}; auto const* const entity : entities) {
+			index.add(id++, *entity);
+		}
+
+		{
+			auto writer = json::OStream(os);
+			auto const write_names = [&](llvm::StringRef const key, auto const names, auto const find) {
+				writer.attributeObject(key, [&] {
+					for (auto const name : (index.*names)()) {
+						writer.attributeArray(name.view(), [&] {
+							for (auto const id : (index.*find)(name)) {
+								writer.value(static_cast<std::int64_t>(id));
+							}
+						});
+					}
+				});
+			};
+
+			writer.object([&] {
+				write_names("headers", &info::import_index::headers, &info::import_index::header);
+				write_names("modules", &info::import_index::modules, &info::import_index::module);
+			});
+		}
+		os << '\n';
+	}
+
+	auto read_imports(std::string_view const text, info::string_interner& interner)
+	  -> std::expected<info::import_index, std::string>
+	{
+		auto value = json::parse(llvm::StringRef(text.data(), text.size()));
+		if (not value) {
+			return std::unexpected(llvm::toString(value.takeError()));
+		}
+
+		auto const object = value->getAsObject();
+		if (object == nullptr) {
+			return std::unexpected("expected the import index to be an object");
+		}
+
+		auto result = info::import_index();
+		auto const read = [&](llvm::StringRef const key,
+		                      auto const add) -> std::expected<void, std::string> {
+			auto const names = object->getObject(key);
+			if (names == nullptr) {
+				return {};
+			}
+
+			for (auto const& [name, ids] : *names) {
+				auto const array = ids.getAsArray();
+				if (array == nullptr) {
+					return std::unexpected("expected '" + name.str() + "' to list entity ids");
+				}
+
+				auto const interned = interner.intern(name.str());
+				for (auto const& id : *array) {
+					auto const n = id.getAsInteger();
+					if (not n.has_value() or *n < 0) {
+						return std::unexpected("expected '" + name.str() + "' to list entity ids");
+					}
+
+					(result.*add)(interned, static_cast<info::import_index::entity_id>(*n));
+				}
+			}
+
+			return {};
+		};
+
+		if (auto headers = read("headers", &info::import_index::add_header); not headers) {
+			return std::unexpected(std::move(headers).error());
+		}
+
+		if (auto modules = read("modules", &info::import_index::add_module); not modules) {
+			return std::unexpected(std::move(modules).error());
+		}
+
+		return result;
+	}
+} // namespace driver
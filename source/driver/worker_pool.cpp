@@ -0,0 +1,567 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <poll.h>
+#include <ranges>
+#include <schreiber/cancellation.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/memory_budget.hpp>
+#include <schreiber/prebuilt.hpp>
+#include <schreiber/scheduler.hpp>
+#include <schreiber/serialise.hpp>
+#include <schreiber/string_interner.hpp>
+#include <schreiber/worker_pool.hpp>
+#include <signal.h>
+#include <span>
+#include <string>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace driver {
+	namespace stdr = std::ranges;
+	namespace tooling = clang::tooling;
+
+	namespace {
+		[[nodiscard]] auto unwrap(std::vector<std::optional<translation_unit_result>>&& results)
+		  -> std::vector<translation_unit_result>
+		{
+			auto unwrapped = std::vector<translation_unit_result>();
+			unwrapped.reserve(results.size());
+			for (auto& result : results) {
+				unwrapped.push_back(*std::move(result));
+			}
+
+			return unwrapped;
+		}
+
+		/// The supervisor's view of a worker process.
+		struct worker {
+			pid_t pid = -1;
+
+			/// The supervisor writes the index of each job to this pipe.
+			int jobs = -1;
+
+			/// The worker writes each result to this pipe as a single line of JSON.
+			int results = -1;
+
+			/// The job that the worker is currently processing.
+			std::optional<std::size_t> job;
+
+			/// When the worker was given its current job.
+			std::chrono::steady_clock::time_point started;
+
+			/// Holds a partially read result.
+			std::string buffer;
+		};
+
+		[[nodiscard]] auto read_job(int const fd) -> std::optional<std::size_t>
+		{
+			auto index = std::uint64_t();
+			auto data = reinterpret_cast<char*>(&index);
+			auto remaining = sizeof(index);
+			while (remaining > 0) {
+				auto const n = ::read(fd, data, remaining);
+				if (n == 0 or (n < 0 and errno != EINTR)) {
+					return std::nullopt;
+				}
+
+				if (n > 0) {
+					data += n;
+					remaining -= static_cast<std::size_t>(n);
+				}
+			}
+
+			return static_cast<std::size_t>(index);
+		}
+
+		[[nodiscard]] auto write_job(int const fd, std::size_t const job) -> bool
+		{
+			auto const index = static_cast<std::uint64_t>(job);
+			auto n = ::ssize_t();
+			do {
+				n = ::write(fd, &index, sizeof(index));
+			} while (n < 0 and errno == EINTR);
+
+			// Writes smaller than PIPE_BUF are atomic, so we don't need to handle short writes.
+			return n == sizeof(index);
+		}
+
+		[[noreturn]] void work(
+		  std::span<tooling::CompileCommand const> const commands,
+		  run_options const& options,
+		  int const jobs,
+		  int const results)
+		{
+			{
+				auto os = llvm::raw_fd_ostream(results, /*shouldClose=*/true);
+				auto cache = file_cache();
+				auto prebuilt = prebuilt_files();
+				while (auto const job = read_job(jobs)) {
+					auto const cancel = cancellation_token::after(options.timeout);
+					serialise(
+					  os,
+					  extract(
+					    commands[*job],
+					    cache,
+					    {
+					      .cancel = &cancel,
+					      .changed = options.changed,
+					      .prebuilt = &prebuilt,
+					      .file_system = options.file_system,
+					    }));
+					os.flush();
+					if (options.memory_limit != 0) {
+						release_free_memory();
+					}
+				}
+			}
+
+			// The worker is a copy of the supervisor, so it mustn't run the supervisor's exit handlers.
+			std::_Exit(EXIT_SUCCESS);
+		}
+
+		[[nodiscard]] auto spawn(
+		  std::span<tooling::CompileCommand const> const commands,
+		  run_options const& options,
+		  std::span<worker const> const siblings) -> worker
+		{
+			int jobs[2];
+			int results[2];
+			if (::pipe(jobs) != 0 or ::pipe(results) != 0) {
+				llvm::report_fatal_error("unable to create a pipe for a worker process");
+			}
+
+			auto const pid = ::fork();
+			if (pid < 0) {
+				llvm::report_fatal_error("unable to fork a worker process");
+			}
+
+			if (pid == 0) {
+				// A sibling's job pipe only reaches end-of-file once every write end is closed, so the
+				// worker mustn't keep its copies open.
+				for (auto const& sibling : siblings) {
+					::close(sibling.jobs);
+					::close(sibling.results);
+				}
+
+				::close(jobs[1]);
+				::close(results[0]);
+				work(commands, options, jobs[0], results[1]);
+			}
+
+			::close(jobs[0]);
+			::close(results[1]);
+			return worker{.pid = pid, .jobs = jobs[1], .results = results[0]};
+		}
+
+		/// Returns the interner that ``options`` asks for each translation unit's strings to go into.
+		[[nodiscard]] auto interner_for(run_options const& options) -> info::string_interner&
+		{
+			return options.interner != nullptr ? *options.interner : info::string_interner::global();
+		}
+
+		[[nodiscard]] auto crashed(
+		  tooling::CompileCommand const& command,
+		  int const status,
+		  info::string_interner& interner) -> translation_unit_result
+		{
+			auto result = translation_unit_result{
+			  .file = command.Filename,
+			  .status = translation_unit_result::status_t::crashed,
+			  .unit = info::detached_translation_unit(command.Filename, interner),
+			};
+
+			auto diagnostics = llvm::raw_string_ostream(result.diagnostics);
+			diagnostics << "error: worker process crashed while processing '" << command.Filename << "'";
+			if (WIFSIGNALED(status)) {
+				diagnostics << " (signal " << WTERMSIG(status) << ')';
+			}
+			else if (WIFEXITED(status)) {
+				diagnostics << " (exit status " << WEXITSTATUS(status) << ')';
+			}
+			diagnostics << '\n';
+			return result;
+		}
+
+		[[nodiscard]] auto killed(
+		  tooling::CompileCommand const& command,
+		  std::chrono::milliseconds const timeout,
+		  info::string_interner& interner) -> translation_unit_result
+		{
+			auto result = translation_unit_result{
+			  .file = command.Filename,
+			  .status = translation_unit_result::status_t::timed_out,
+			  .unit = info::detached_translation_unit(command.Filename, interner),
+			};
+
+			auto diagnostics = llvm::raw_string_ostream(result.diagnostics);
+			diagnostics << "error: killed the worker process extracting '" << command.Filename
+			            << "' after it ignored its " << timeout.count() << " ms time budget\n";
+			return result;
+		}
+
+		[[nodiscard]] auto malformed(
+		  tooling::CompileCommand const& command,
+		  std::string const& error,
+		  info::string_interner& interner) -> translation_unit_result
+		{
+			return translation_unit_result{
+			  .file = command.Filename,
+			  .status = translation_unit_result::status_t::failed,
+			  .diagnostics =
+			    "error: unable to read the result for '" + command.Filename + "': " + error + '\n',
+			  .unit = info::detached_translation_unit(command.Filename, interner),
+			};
+		}
+
+		class supervisor {
+		public:
+			supervisor(
+			  std::span<tooling::CompileCommand const> const commands,
+			  std::span<double const> const costs,
+			  run_options const& options)
+			: commands_(commands)
+			, options_(options)
+			, results_(commands.size())
+			, budget_(options.memory_limit)
+			{
+				// Jobs are handed out from a single queue, so the most expensive job that's left always
+				// goes to the next idle worker.
+				for (auto const i : longest_first(costs)) {
+					pending_.push_back(i);
+				}
+
+				auto const count = std::min<std::size_t>(std::max(options.jobs, 1u), commands.size());
+				workers_.reserve(count);
+				for (auto i = std::size_t(0); i < count; ++i) {
+					workers_.push_back(spawn(commands_, options_, workers_));
+				}
+			}
+
+			supervisor(supervisor const&) = delete;
+			auto operator=(supervisor const&) -> supervisor& = delete;
+
+			~supervisor()
+			{
+				for (auto& worker : workers_) {
+					::close(worker.jobs);
+				}
+
+				for (auto& worker : workers_) {
+					::close(worker.results);
+					::waitpid(worker.pid, nullptr, 0);
+				}
+			}
+
+			[[nodiscard]] auto run() && -> std::vector<translation_unit_result>
+			{
+				dispatch();
+
+				auto fds = std::vector<::pollfd>();
+				while (busy() > 0 or not pending_.empty()) {
+					fds.clear();
+					for (auto const& worker : workers_) {
+						auto const fd = worker.job.has_value() ? worker.results : -1;
+						fds.push_back({.fd = fd, .events = POLLIN, .revents = 0});
+					}
+
+					if (::poll(fds.data(), fds.size(), poll_timeout()) < 0) {
+						if (errno == EINTR) {
+							continue;
+						}
+
+						llvm::report_fatal_error("unable to poll worker processes");
+					}
+
+					for (auto i = std::size_t(0); i < fds.size(); ++i) {
+						if (fds[i].revents != 0) {
+							receive(workers_[i]);
+						}
+					}
+
+					kill_overdue();
+					dispatch();
+				}
+
+				return unwrap(std::move(results_));
+			}
+		private:
+			std::span<tooling::CompileCommand const> commands_;
+			run_options options_;
+			std::vector<std::optional<translation_unit_result>> results_;
+			std::deque<std::size_t> pending_;
+			std::vector<worker> workers_;
+			memory_budget budget_;
+
+			/// How often to look at the workers' memory again while jobs are waiting for it, in
+			/// milliseconds.
+			static constexpr auto recheck_interval = 100;
+
+			/// Returns how long ``poll`` can wait before the supervisor has something else to do, in
+			/// milliseconds.
+			[[nodiscard]] auto poll_timeout() const -> int
+			{
+				auto timeout = -1;
+
+				// Jobs that are waiting for memory need to be looked at again even if no worker
+				// finishes, since the memory in use can drop for other reasons.
+				if (not pending_.empty() and busy() < workers_.size()) {
+					timeout = recheck_interval;
+				}
+
+				if (options_.timeout.count() <= 0) {
+					return timeout;
+				}
+
+				auto const now = std::chrono::steady_clock::now();
+				for (auto const& worker : workers_) {
+					if (not worker.job.has_value()) {
+						continue;
+					}
+
+					auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+					  worker.started + hard_deadline() - now);
+					auto const ms = static_cast<int>(
+					  std::max<std::chrono::milliseconds::rep>(remaining.count() + 1, 0));
+					timeout = timeout < 0 ? ms : std::min(timeout, ms);
+				}
+
+				return timeout;
+			}
+
+			/// Cancellation is only checked between declarations, so a worker that's stuck in a single
+			/// declaration (e.g. a deep template instantiation) is killed once it's had twice its
+			/// budget.
+			[[nodiscard]] auto hard_deadline() const -> std::chrono::milliseconds
+			{
+				return 2 * options_.timeout;
+			}
+
+			void kill_overdue()
+			{
+				if (options_.timeout.count() <= 0) {
+					return;
+				}
+
+				auto const now = std::chrono::steady_clock::now();
+				for (auto& worker : workers_) {
+					if (not worker.job.has_value() or now < worker.started + hard_deadline()) {
+						continue;
+					}
+
+					auto const job = *worker.job;
+					auto const elapsed =
+					  std::chrono::duration_cast<std::chrono::milliseconds>(now - worker.started);
+					::kill(worker.pid, SIGKILL);
+					(void)replace(worker);
+					results_[job] = killed(commands_[job], options_.timeout, interner_for(options_));
+					results_[job]->elapsed = elapsed;
+				}
+			}
+
+			[[nodiscard]] auto busy() const -> std::size_t
+			{
+				return static_cast<std::size_t>(
+				  stdr::count_if(workers_, [](worker const& w) { return w.job.has_value(); }));
+			}
+
+			/// Returns the memory used by the supervisor and all of its workers.
+			[[nodiscard]] auto in_use() const -> std::size_t
+			{
+				auto total = resident_set_size().value_or(0);
+				for (auto const& worker : workers_) {
+					total += resident_set_size(worker.pid).value_or(0);
+				}
+
+				return total;
+			}
+
+			/// Hands pending jobs to idle workers for as long as the memory budget allows.
+			void dispatch()
+			{
+				for (auto& worker : workers_) {
+					if (pending_.empty()) {
+						return;
+					}
+
+					if (worker.job.has_value()) {
+						continue;
+					}
+
+					auto const in_use = budget_.limit() != 0 ? this->in_use() : 0;
+					if (not budget_.admits(in_use, busy())) {
+						return;
+					}
+
+					assign(worker);
+				}
+			}
+
+			void assign(worker& w)
+			{
+				auto const job = pending_.front();
+				pending_.pop_front();
+				if (write_job(w.jobs, job)) {
+					w.job = job;
+					w.started = std::chrono::steady_clock::now();
+					return;
+				}
+
+				// The worker died before it was given this job, so the job isn't to blame.
+				pending_.push_front(job);
+				replace(w);
+				assign(w);
+			}
+
+			void receive(worker& w)
+			{
+				char data[64 * 1024];
+				auto const n = ::read(w.results, data, sizeof(data));
+				if (n < 0) {
+					if (errno != EINTR and errno != EAGAIN) {
+						finish_crashed(w);
+					}
+					return;
+				}
+
+				if (n == 0) {
+					finish_crashed(w);
+					return;
+				}
+
+				// Only the new data can hold the end of the result: searching the whole buffer after each
+				// read would be quadratic in the size of the result.
+				auto const searched = w.buffer.size();
+				w.buffer.append(data, static_cast<std::size_t>(n));
+				auto const end = w.buffer.find('\n', searched);
+				if (end == std::string::npos) {
+					return;
+				}
+
+				auto const job = *w.job;
+				auto& interner = interner_for(options_);
+				auto result =
+				  deserialise_translation_unit(std::string_view(w.buffer).substr(0, end), interner);
+				results_[job] =
+				  result ? *std::move(result) : malformed(commands_[job], result.error(), interner);
+				budget_.record(results_[job]->ast_bytes);
+				if (options_.index != nullptr) {
+					options_.index->insert(results_[job]->unit);
+				}
+
+				if (options_.search != nullptr) {
+					options_.search->add(results_[job]->unit);
+				}
+
+				w.buffer.erase(0, end + 1);
+				w.job.reset();
+			}
+
+			void finish_crashed(worker& w)
+			{
+				auto const job = *w.job;
+				auto const status = replace(w);
+				results_[job] = crashed(commands_[job], status, interner_for(options_));
+			}
+
+			/// Reaps ``w`` and forks a fresh worker in its place.
+			///
+			/// \returns The old worker's wait status.
+			auto replace(worker& w) -> int
+			{
+				::close(w.jobs);
+				::close(w.results);
+
+				auto status = 0;
+				while (::waitpid(w.pid, &status, 0) < 0 and errno == EINTR) {}
+
+				w = worker{};
+				w = spawn(commands_, options_, workers_);
+				return status;
+			}
+		};
+	} // namespace
+
+	auto run_in_process(std::span<tooling::CompileCommand const> const commands, run_options const& options)
+	  -> std::vector<translation_unit_result>
+	{
+		auto results = std::vector<std::optional<translation_unit_result>>(commands.size());
+		auto own_cache = file_cache();
+		auto& cache = options.cache != nullptr ? *options.cache : own_cache;
+		auto prebuilt = prebuilt_files();
+		auto budget = memory_budget(options.memory_limit);
+		{
+			auto const count = std::min<std::size_t>(std::max(options.jobs, 1u), commands.size());
+			auto queue = work_queue(estimate_costs(commands, options.history), count);
+			auto workers = std::vector<std::jthread>();
+			workers.reserve(count);
+			for (auto i = std::size_t(0); i < count; ++i) {
+				workers.emplace_back([&, i] {
+					while (true) {
+						budget.acquire();
+						auto const job = queue.pop(i);
+						if (not job.has_value()) {
+							budget.release(0);
+							return;
+						}
+
+						auto const cancel = cancellation_token::after(options.timeout);
+						results[*job] = extract(
+						  commands[*job],
+						  cache,
+						  {
+						    .cancel = &cancel,
+						    .changed = options.changed,
+						    .prebuilt = &prebuilt,
+						    .file_system = options.file_system,
+						    .interner = options.interner,
+						  });
+						budget.release(results[*job]->ast_bytes);
+						if (options.index != nullptr) {
+							options.index->insert(results[*job]->unit);
+						}
+
+						if (options.search != nullptr) {
+							options.search->add(results[*job]->unit);
+						}
+					}
+				});
+			}
+		}
+
+		return unwrap(std::move(results));
+	}
+
+	auto run_isolated(std::span<tooling::CompileCommand const> const commands, run_options const& options)
+	  -> std::vector<translation_unit_result>
+	{
+		if (commands.empty()) {
+			return {};
+		}
+
+		// Writing a job to a worker that has just died raises SIGPIPE, which we'd rather observe as
+		// a failed write.
+		auto const previous = ::signal(SIGPIPE, SIG_IGN);
+		auto const costs = estimate_costs(commands, options.history);
+		auto results = supervisor(commands, costs, options).run();
+		::signal(SIGPIPE, previous);
+		return results;
+	}
+} // namespace driver
@@ -0,0 +1,230 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/entity_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace info {
+	entity_index::entity_index(string_interner& interner)
+	: interner_(&interner)
+	{}
+
+	auto entity_index::intern(detached_entity entity) -> detached_entity
+	{
+		auto const intern_string = [this](std::string_view& s) { s = interner_->intern(s).view(); };
+		auto const intern_location = [&](detached_location& location) {
+			intern_string(location.file);
+		};
+		auto const intern_text = [&](detached_text& text) {
+			intern_string(text.description);
+			intern_location(text.location);
+		};
+		auto const intern_parameter = [&](detached_parameter& parameter) {
+			intern_string(parameter.name);
+			intern_string(parameter.type);
+			intern_string(parameter.description);
+			intern_location(parameter.location);
+		};
+
+		intern_string(entity.usr);
+		intern_string(entity.name);
+		intern_string(entity.qualified_name);
+		intern_string(entity.type);
+		intern_string(entity.inherits_from);
+		intern_location(entity.location);
+		intern_text(entity.documentation);
+
+		// The handles might belong to a different interner, and they're compared by address.
+		for (auto& header : entity.headers) {
+			header = interner_->intern(header.view());
+		}
+
+		for (auto& module : entity.modules) {
+			module = interner_->intern(module.view());
+		}
+
+		for (auto& parameter : entity.template_parameters) {
+			intern_parameter(parameter);
+		}
+
+		for (auto& parameter : entity.parameters) {
+			intern_parameter(parameter);
+		}
+
+		if (entity.returns.has_value()) {
+			intern_text(*entity.returns);
+		}
+
+		for (auto& exception : entity.throws) {
+			intern_string(exception.type);
+			intern_string(exception.type_usr);
+			intern_string(exception.description);
+			intern_location(exception.location);
+		}
+
+		for (auto& reference : entity.references) {
+			intern_string(reference.name);
+			intern_string(reference.usr);
+		}
+
+		for (auto* const texts :
+		     {&entity.preconditions, &entity.postconditions, &entity.exits_via})
+		{
+			for (auto& text : *texts) {
+				intern_text(text);
+			}
+		}
+
+		return entity;
+	}
+
+	auto entity_index::insert(detached_entity const& entity) -> entity_id
+	{
+		// Most of a project's entities are declared in headers, so most insertions are repeats that
+		// only need a shared lock to be rejected.
+		if (not entity.usr.empty()) {
+			auto const lock = std::shared_lock(mutex_);
+			if (auto const i = by_usr_.find(entity.usr); i != by_usr_.end()) {
+				return i->second;
+			}
+		}
+
+		auto interned = intern(entity);
+
+		auto const lock = std::unique_lock(mutex_);
+		auto const id = static_cast<entity_id>(entities_.size());
+		if (not interned.usr.empty()) {
+			auto const [i, inserted] = by_usr_.try_emplace(interned.usr, id);
+			if (not inserted) {
+				return i->second;
+			}
+		}
+
+		auto const& stored = entities_.emplace_back(std::move(interned));
+		by_qualified_name_[stored.qualified_name].push_back(id);
+		by_name_.emplace(stored.qualified_name, id);
+		by_file_[stored.location.file].push_back(id);
+		imports_.add(id, stored);
+		return id;
+	}
+
+	void entity_index::insert(detached_translation_unit const& unit)
+	{
+		for (auto const& entity : unit.entities()) {
+			insert(entity);
+		}
+	}
+
+	auto entity_index::size() const -> std::size_t
+	{
+		auto const lock = std::shared_lock(mutex_);
+		return entities_.size();
+	}
+
+	auto entity_index::get(entity_id const id) const -> detached_entity const&
+	{
+		auto const lock = std::shared_lock(mutex_);
+		assert(id < entities_.size());
+		return entities_[id];
+	}
+
+	auto entity_index::find_usr(std::string_view const usr) const -> detached_entity const*
+	{
+		auto const lock = std::shared_lock(mutex_);
+		auto const i = by_usr_.find(usr);
+		return i != by_usr_.end() ? &entities_[i->second] : nullptr;
+	}
+
+	auto entity_index::find_documentation(detached_entity const& entity) const
+	  -> detached_entity const*
+	{
+		auto const* documented = &entity;
+		while (documented != nullptr and not documented->inherits_from.empty()) {
+			documented = find_usr(documented->inherits_from);
+		}
+
+		return documented;
+	}
+
+	auto entity_index::lookup(std::span<entity_id const> const ids) const
+	  -> std::vector<detached_entity const*>
+	{
+		auto result = std::vector<detached_entity const*>();
+		result.reserve(ids.size());
+		for (auto const id : ids) {
+			result.push_back(&entities_[id]);
+		}
+
+		return result;
+	}
+
+	auto entity_index::find_qualified_name(std::string_view const qualified_name) const
+	  -> std::vector<detached_entity const*>
+	{
+		auto const lock = std::shared_lock(mutex_);
+		auto const i = by_qualified_name_.find(qualified_name);
+		return lookup(i != by_qualified_name_.end() ? i->second : std::span<entity_id const>());
+	}
+
+	auto entity_index::find_in_namespace(std::string_view const name_space) const
+	  -> std::vector<detached_entity const*>
+	{
+		auto const prefix = name_space.empty() ? std::string() : std::string(name_space) + "::";
+
+		auto const lock = std::shared_lock(mutex_);
+		auto result = std::vector<detached_entity const*>();
+		for (auto i = by_name_.lower_bound(prefix); i != by_name_.end(); ++i) {
+			if (not i->first.starts_with(prefix)) {
+				break;
+			}
+
+			result.push_back(&entities_[i->second]);
+		}
+
+		return result;
+	}
+
+	auto entity_index::find_in_file(std::string_view const file) const
+	  -> std::vector<detached_entity const*>
+	{
+		auto const lock = std::shared_lock(mutex_);
+		auto const i = by_file_.find(file);
+		return lookup(i != by_file_.end() ? i->second : std::span<entity_id const>());
+	}
+
+	auto entity_index::find_in_header(std::string_view const header) const
+	  -> std::vector<detached_entity const*>
+	{
+		// A header that was never interned can't export anything, and interning it would keep every
+		// query's string alive for as long as the interner.
+		auto const name = interner_->find(header);
+		if (name.empty()) {
+			return {};
+		}
+
+		auto const lock = std::shared_lock(mutex_);
+		return lookup(imports_.header(name));
+	}
+
+	auto entity_index::find_in_module(std::string_view const module) const
+	  -> std::vector<detached_entity const*>
+	{
+		auto const name = interner_->find(module);
+		if (name.empty()) {
+			return {};
+		}
+
+		auto const lock = std::shared_lock(mutex_);
+		return lookup(imports_.module(name));
+	}
+} // namespace info
@@ -0,0 +1,91 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <ranges>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/import_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <span>
+#include <vector>
+
+namespace info {
+	namespace stdr = std::ranges;
+
+	namespace {
+		using entity_ids = absl::flat_hash_map<interned_string, std::vector<import_index::entity_id>>;
+
+		void add_to(entity_ids& ids, interned_string const name, import_index::entity_id const id)
+		{
+			auto& list = ids[name];
+
+			// An entity can list the same header twice, and a header is often seen once per
+			// translation unit that includes it.
+			if (list.empty() or list.back() != id) {
+				list.push_back(id);
+			}
+		}
+
+		[[nodiscard]] auto find(entity_ids const& ids, interned_string const name)
+		  -> std::span<import_index::entity_id const>
+		{
+			auto const i = ids.find(name);
+			return i != ids.end() ? std::span<import_index::entity_id const>(i->second)
+			                      : std::span<import_index::entity_id const>();
+		}
+
+		[[nodiscard]] auto sorted_names(entity_ids const& ids) -> std::vector<interned_string>
+		{
+			auto result = std::vector<interned_string>();
+			result.reserve(ids.size());
+			for (auto const& [name, _] : ids) {
+				result.push_back(name);
+			}
+
+			stdr::sort(result, {}, &interned_string::view);
+			return result;
+		}
+	} // namespace
+
+	void import_index::add(entity_id const id, detached_entity const& entity)
+	{
+		for (auto const header : entity.headers) {
+			add_header(header, id);
+		}
+
+		for (auto const module : entity.modules) {
+			add_module(module, id);
+		}
+	}
+
+	void import_index::add_header(interned_string const header, entity_id const id)
+	{
+		add_to(headers_, header, id);
+	}
+
+	void import_index::add_module(interned_string const module, entity_id const id)
+	{
+		add_to(modules_, module, id);
+	}
+
+	auto import_index::header(interned_string const header) const -> std::span<entity_id const>
+	{
+		return find(headers_, header);
+	}
+
+	auto import_index::module(interned_string const module) const -> std::span<entity_id const>
+	{
+		return find(modules_, module);
+	}
+
+	auto import_index::headers() const -> std::vector<interned_string>
+	{
+		return sorted_names(headers_);
+	}
+
+	auto import_index::modules() const -> std::vector<interned_string>
+	{
+		return sorted_names(modules_);
+	}
+} // namespace info
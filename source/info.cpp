@@ -2,29 +2,64 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 #include <algorithm>
+#include <array>
 #include <cjdb/contracts.hpp>
 #include <clang/AST/Decl.h>
 #include <clang/AST/DeclBase.h>
+#include <clang/AST/DeclCXX.h>
 #include <clang/AST/DeclTemplate.h>
 #include <clang/Basic/Diagnostic.h>
 #include <clang/Basic/SourceLocation.h>
+#include <cstdint>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/xxhash.h>
 #include <schreiber/diagnostic_ids.hpp>
 #include <schreiber/info.hpp>
 #include <schreiber/parser.hpp>
+#include <schreiber/string_interner.hpp>
 #include <span>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace stdr = std::ranges;
 namespace info {
+	namespace {
+		/// Combines the hash so far with the next piece of documentation. Each piece is hashed on its
+		/// own and chained through a fixed-size block, so hashing never copies the documentation.
+		[[nodiscard]] auto chain_hash(
+		  std::uint64_t const state,
+		  std::uint64_t const tag,
+		  std::string_view const payload) noexcept -> std::uint64_t
+		{
+			auto const block = std::array<std::uint64_t, 3>{
+			  state,
+			  tag,
+			  llvm::xxh3_64bits(llvm::StringRef(payload.data(), payload.size())),
+			};
+			return llvm::xxh3_64bits(
+			  llvm::ArrayRef(reinterpret_cast<std::uint8_t const*>(block.data()), sizeof(block)));
+		}
+	} // namespace
+
 	basic_info::basic_info(kind const kind, std::string description, clang::SourceLocation const location)
 	: kind_(kind)
 	, description_(std::move(description))
 	, location_(location)
 	{}
 
+	basic_info::basic_info(
+	  kind const kind,
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: kind_(kind)
+	, description_(description)
+	, location_(location)
+	{}
+
 	auto basic_info::get_kind(basic_info const& info) noexcept -> kind
 	{
 		return info.kind_;
@@ -32,7 +67,17 @@ namespace info {
 
 	auto basic_info::description() const noexcept -> std::string_view
 	{
-		return description_;
+		if (auto const interned = std::get_if<interned_string>(&description_)) {
+			return interned->view();
+		}
+
+		return std::get<std::string>(description_);
+	}
+
+	auto basic_info::interned_description() const noexcept -> interned_string
+	{
+		auto const interned = std::get_if<interned_string>(&description_);
+		return interned != nullptr ? *interned : interned_string();
 	}
 
 	auto basic_info::location() const noexcept -> clang::SourceLocation
@@ -45,24 +90,51 @@ namespace info {
 	, decl_((CJDB_EXPECTS(decl != nullptr), decl))
 	{}
 
+	decl_info::decl_info(
+	  kind const k,
+	  clang::Decl const* const decl,
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: basic_info(k, description, location)
+	, decl_((CJDB_EXPECTS(decl != nullptr), decl))
+	{}
+
 	auto decl_info::decl() const noexcept -> clang::Decl const*
 	{
 		return decl_;
 	}
 
-	decl_info::header_info::header_info(std::string description, clang::SourceLocation const location)
-	: basic_info(basic_info::kind::header_info, std::move(description), location)
+	decl_info::header_info::header_info(interned_string const name, clang::SourceLocation const location)
+	: basic_info(basic_info::kind::header_info, name, location)
+	{}
+
+	decl_info::header_info::header_info(std::string_view const name, clang::SourceLocation const location)
+	: header_info(string_interner::global().intern(name), location)
 	{}
 
+	auto decl_info::header_info::name() const noexcept -> interned_string
+	{
+		return interned_description();
+	}
+
 	auto decl_info::header_info::classof(basic_info const* info) -> bool
 	{
 		return get_kind(*info) == kind::header_info;
 	}
 
-	decl_info::module_info::module_info(std::string description, clang::SourceLocation const location)
-	: basic_info(basic_info::kind::module_info, std::move(description), location)
+	decl_info::module_info::module_info(interned_string const name, clang::SourceLocation const location)
+	: basic_info(basic_info::kind::module_info, name, location)
+	{}
+
+	decl_info::module_info::module_info(std::string_view const name, clang::SourceLocation const location)
+	: module_info(string_interner::global().intern(name), location)
 	{}
 
+	auto decl_info::module_info::name() const noexcept -> interned_string
+	{
+		return interned_description();
+	}
+
 	auto decl_info::module_info::classof(basic_info const* info) -> bool
 	{
 		return get_kind(*info) == kind::module_info;
@@ -70,11 +142,16 @@ namespace info {
 
 	void entity_info::add_header(header_info header)
 	{
+		update_content_hash(header);
 		headers_.push_back(std::move(header));
 	}
 
 	void entity_info::add_header(std::vector<header_info> headers)
 	{
+		for (auto const& header : headers) {
+			update_content_hash(header);
+		}
+
 		headers_.insert(
 		  headers_.end(),
 		  std::move_iterator(headers.begin()),
@@ -83,11 +160,16 @@ namespace info {
 
 	void entity_info::add_module(module_info module)
 	{
+		update_content_hash(module);
 		modules_.push_back(std::move(module));
 	}
 
 	void entity_info::add_module(std::vector<module_info> modules)
 	{
+		for (auto const& module : modules) {
+			update_content_hash(module);
+		}
+
 		modules_.insert(
 		  modules_.end(),
 		  std::move_iterator(modules.begin()),
@@ -104,6 +186,35 @@ namespace info {
 		return modules_;
 	}
 
+	auto entity_info::content_hash() const noexcept -> std::uint64_t
+	{
+		return chain_hash(content_hash_, static_cast<std::uint64_t>(get_kind(*this)), description());
+	}
+
+	void
+	entity_info::update_content_hash(basic_info const& info, std::string_view const name) noexcept
+	{
+		auto const tag = static_cast<std::uint64_t>(get_kind(info));
+		if (not name.empty()) {
+			content_hash_ = chain_hash(content_hash_, tag, name);
+		}
+
+		content_hash_ = chain_hash(content_hash_, tag, info.description());
+	}
+
+	auto entity_info::classof(basic_info const* const info) -> bool
+	{
+		switch (get_kind(*info)) {
+		case kind::function_info:
+		case kind::function_template_info:
+		case kind::record_info:
+		case kind::class_template_info:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	void entity_info::store(parser::parser const&, parser::directive, basic_info* info)
 	{
 		switch (get_kind(*info)) {
@@ -125,6 +236,25 @@ namespace info {
 	: entity_info(kind::function_info, decl, std::move(description), location)
 	{}
 
+	function_info::function_info(
+	  clang::FunctionDecl const* const decl,
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: entity_info(kind::function_info, decl, description, location)
+	{}
+
+	function_info::function_info(
+	  clang::CXXMethodDecl const* const decl,
+	  clang::CXXMethodDecl const* const base)
+	: entity_info(kind::function_info, decl, interned_string(), decl->getLocation())
+	, inherits_from_((CJDB_EXPECTS(base != nullptr), base))
+	{}
+
+	auto function_info::inherits_from() const noexcept -> clang::CXXMethodDecl const*
+	{
+		return inherits_from_;
+	}
+
 	void
 	function_info::add_parameter(parser::parser const& p, parser::directive directive, parameter_info info)
 	{
@@ -141,6 +271,7 @@ namespace info {
 			p.diagnose(prior_definition->location(), clang::diag::note_previous_definition);
 		}
 
+		update_content_hash(info, llvm::cast<clang::NamedDecl>(info.decl())->getName());
 		parameters_.push_back(std::move(info));
 	}
 
@@ -184,6 +315,8 @@ namespace info {
 			p.diagnose(returns_->location(), clang::diag::note_previous_definition);
 			return;
 		}
+
+		update_content_hash(info);
 		returns_ = std::move(info);
 	}
 
@@ -195,6 +328,7 @@ namespace info {
 	void
 	function_info::add_precondition(parser::parser const&, parser::directive, precondition_info info)
 	{
+		update_content_hash(info);
 		preconditions_.push_back(std::move(info));
 	}
 
@@ -206,6 +340,7 @@ namespace info {
 	void
 	function_info::add_postcondition(parser::parser const&, parser::directive, postcondition_info info)
 	{
+		update_content_hash(info);
 		postconditions_.push_back(std::move(info));
 	}
 
@@ -216,6 +351,7 @@ namespace info {
 
 	void function_info::add_throws(parser::parser const&, parser::directive, throws_info info)
 	{
+		update_content_hash(info, info.type());
 		throws_.push_back(std::move(info));
 	}
 
@@ -226,6 +362,7 @@ namespace info {
 
 	void function_info::add_exits_via(parser::parser const&, parser::directive, exits_via_info info)
 	{
+		update_content_hash(info);
 		exits_via_.push_back(std::move(info));
 	}
 
@@ -273,6 +410,77 @@ namespace info {
 	: decl_info(kind::parameter_info, decl, std::move(description), source_location)
 	{}
 
+	record_info::record_info(
+	  clang::CXXRecordDecl const* const decl,
+	  std::string description,
+	  clang::SourceLocation const location)
+	: entity_info(kind::record_info, decl, std::move(description), location)
+	{}
+
+	record_info::record_info(
+	  clang::CXXRecordDecl const* const decl,
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: entity_info(kind::record_info, decl, description, location)
+	{}
+
+	record_info::record_info(
+	  clang::ClassTemplateDecl const* const decl,
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: entity_info(kind::class_template_info, decl, description, location)
+	{}
+
+	auto record_info::record() const noexcept -> clang::CXXRecordDecl const*
+	{
+		if (auto const class_template = llvm::dyn_cast<clang::ClassTemplateDecl>(decl())) {
+			return class_template->getTemplatedDecl();
+		}
+
+		return llvm::cast<clang::CXXRecordDecl>(decl());
+	}
+
+	void record_info::store(parser::parser const& p, parser::directive directive, basic_info* info)
+	{
+		assert(info != nullptr);
+		entity_info::store(p, directive, info);
+	}
+
+	auto record_info::classof(basic_info const* const info) -> bool
+	{
+		switch (get_kind(*info)) {
+		case kind::record_info:
+		case kind::class_template_info:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	class_template_info::class_template_info(
+	  clang::ClassTemplateDecl const* const decl,
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: record_info(decl, description, location)
+	{}
+
+	void class_template_info::add_template_parameter(template_parameter_info info)
+	{
+		update_content_hash(info, llvm::cast<clang::NamedDecl>(info.decl())->getName());
+		template_parameters_.push_back(std::move(info));
+	}
+
+	auto class_template_info::template_parameters() const noexcept
+	  -> std::span<template_parameter_info const>
+	{
+		return template_parameters_;
+	}
+
+	auto class_template_info::classof(basic_info const* const info) -> bool
+	{
+		return get_kind(*info) == kind::class_template_info;
+	}
+
 	auto parameter_info::classof(basic_info const* const decl) -> bool
 	{
 		return get_kind(*decl) == kind::parameter_info;
@@ -308,24 +516,64 @@ namespace info {
 	: basic_info(kind::return_info, std::move(description), location)
 	{}
 
+	function_info::return_info::return_info(
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: basic_info(kind::return_info, description, location)
+	{}
+
 	function_info::precondition_info::precondition_info(
 	  std::string description,
 	  clang::SourceLocation const location)
 	: basic_info(kind::precondition_info, std::move(description), location)
 	{}
 
+	function_info::precondition_info::precondition_info(
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: basic_info(kind::precondition_info, description, location)
+	{}
+
 	function_info::postcondition_info::postcondition_info(
 	  std::string description,
 	  clang::SourceLocation const location)
 	: basic_info(kind::postcondition_info, std::move(description), location)
 	{}
 
-	function_info::throws_info::throws_info(std::string description, clang::SourceLocation const location)
+	function_info::postcondition_info::postcondition_info(
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: basic_info(kind::postcondition_info, description, location)
+	{}
+
+	function_info::throws_info::throws_info(
+	  std::string type,
+	  clang::NamedDecl const* const type_decl,
+	  std::string description,
+	  clang::SourceLocation const location)
 	: basic_info(kind::throws_info, std::move(description), location)
+	, type_(std::move(type))
+	, type_decl_(type_decl)
 	{}
 
+	auto function_info::throws_info::type() const noexcept -> std::string_view
+	{
+		return type_;
+	}
+
+	auto function_info::throws_info::type_decl() const noexcept -> clang::NamedDecl const*
+	{
+		return type_decl_;
+	}
+
 	function_info::exits_via_info::exits_via_info(std::string description, clang::SourceLocation const location)
 	: basic_info(kind::exits_via_info, std::move(description), location)
 	{}
 
+	function_info::exits_via_info::exits_via_info(
+	  interned_string const description,
+	  clang::SourceLocation const location)
+	: basic_info(kind::exits_via_info, description, location)
+	{}
+
 } // namespace info
@@ -7,21 +7,29 @@
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/CommentCommandTraits.h>
 #include <clang/AST/Decl.h>
+#include <clang/AST/DeclTemplate.h>
 #include <clang/AST/RawCommentList.h>
+#include <clang/AST/Type.h>
 #include <clang/Basic/Diagnostic.h>
 #include <clang/Basic/PartialDiagnostic.h>
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Basic/SourceManager.h>
+#include <cstddef>
 #include <functional>
 #include <iterator>
 #include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/iterator_range.h>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <schreiber/diagnostic_ids.hpp>
 #include <schreiber/info.hpp>
 #include <schreiber/parser.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace parser {
 	namespace stdr = std::ranges;
@@ -34,20 +42,49 @@ namespace parser {
 		return {r.begin(), stdr::next(r.begin(), r.end())};
 	}
 
+	/// Returns the declaration of the type named ``spelling`` in ``decl``'s documentation, or
+	/// ``std::nullopt`` if it doesn't name a type. Types without a declaration, such as ``int``,
+	/// are ``nullptr``.
+	[[nodiscard]] static auto find_exception_type(
+	  parser& p,
+	  clang::FunctionDecl const* const decl,
+	  std::string_view const spelling) -> std::optional<clang::NamedDecl const*>
+	{
+		// ``first`` is empty when the name starts with ``::``, which can only be found by lookup.
+		auto const first = spelling.substr(0, spelling.find_first_of(":<*&"));
+		auto& context = decl->getASTContext();
+		if (not first.empty() and context.Idents.get(first).isKeyword(context.getLangOpts())) {
+			return std::make_optional<clang::NamedDecl const*>(nullptr);
+		}
+
+		// Template parameters aren't visible to name lookup from outside the function.
+		auto const function_template = decl->getDescribedFunctionTemplate();
+		if (function_template != nullptr and not first.empty()) {
+			for (auto const* const parameter : *function_template->getTemplateParameters()) {
+				if (parameter->getName() == first) {
+					return parameter;
+				}
+			}
+		}
+
+		if (auto const type = p.find_type(decl->getDeclContext(), spelling)) {
+			return type;
+		}
+
+		return std::nullopt;
+	}
+
 	auto make_parse_result(
 	  parser& p,
 	  clang::FunctionDecl const* decl,
 	  directive const directive,
-	  std::string description) -> std::unique_ptr<info::basic_info>
+	  info::interned_string const description) -> std::unique_ptr<info::basic_info>
 	{
 		switch (directive.token->kind) {
-		case command_info::headers:
-			return std::make_unique<info::decl_info::header_info>(std::move(description), directive.location);
-		case command_info::modules:
-			return std::make_unique<info::decl_info::module_info>(std::move(description), directive.location);
 		case command_info::param: {
 			auto name = to_string_view(
-			  absl::StripLeadingAsciiWhitespace(description) | stdv::take_while(std::not_fn(is_space)));
+			  absl::StripLeadingAsciiWhitespace(description.view())
+			  | stdv::take_while(std::not_fn(is_space)));
 			auto parameters = decl->parameters();
 			auto parameter = stdr::find_if(parameters, [name](clang::ParmVarDecl const* const p) {
 				return std::string_view{p->getName()} == name;
@@ -60,46 +97,78 @@ namespace parser {
 				return nullptr;
 			}
 
-			auto desc = description.substr(name.size());
-			absl::StripLeadingAsciiWhitespace(&desc);
-			return std::make_unique<info::parameter_info>(directive.location, *parameter, std::move(desc));
+			auto const desc = absl::StripLeadingAsciiWhitespace(description.view().substr(
+			  static_cast<std::size_t>(name.end() - description.view().begin())));
+			return std::make_unique<info::parameter_info>(
+			  directive.location,
+			  *parameter,
+			  std::string(desc));
 		}
 		case command_info::returns:
-			return std::make_unique<info::function_info::return_info>(
-			  std::move(description),
-			  directive.location);
+			return std::make_unique<info::function_info::return_info>(description, directive.location);
 		case command_info::pre:
 			return std::make_unique<info::function_info::precondition_info>(
-			  std::move(description),
+			  description,
 			  directive.location);
 		case command_info::post:
 			return std::make_unique<info::function_info::postcondition_info>(
-			  std::move(description),
+			  description,
 			  directive.location);
-		case command_info::throws:
+		case command_info::throws: {
+			if (auto const type = decl->getType()->getAs<clang::FunctionProtoType>();
+			    type != nullptr and type->isNothrow())
+			{
+				p.diagnose(directive.location, diag::err_throws_on_noexcept)
+				  << command_info::throws << decl;
+				if (auto const specifier = decl->getExceptionSpecSourceRange(); specifier.isValid()) {
+					p.diagnose(specifier.getBegin(), diag::note_noexcept_here) << decl;
+				}
+
+				return nullptr;
+			}
+
+			auto const spelling = to_string_view(
+			  absl::StripLeadingAsciiWhitespace(description.view())
+			  | stdv::take_while(std::not_fn(is_space)));
+			auto const type_decl = find_exception_type(p, decl, spelling);
+			if (not type_decl.has_value()) {
+				auto const report_loc =
+				  directive.location.getLocWithOffset(static_cast<int>(directive.text.size() + 2));
+				p.diagnose(report_loc, diag::warn_unknown_exception_type) << spelling << decl;
+				p.diagnose(report_loc, diag::note_unknown_exception_type) << command_info::throws;
+			}
+
+			auto const desc = absl::StripLeadingAsciiWhitespace(description.view().substr(
+			  static_cast<std::size_t>(spelling.end() - description.view().begin())));
 			return std::make_unique<info::function_info::throws_info>(
-			  std::move(description),
+			  std::string(spelling),
+			  type_decl.value_or(nullptr),
+			  std::string(desc),
 			  directive.location);
+		}
 		case command_info::exits_via:
 			return std::make_unique<info::function_info::exits_via_info>(
-			  std::move(description),
+			  description,
 			  directive.location);
 		default:
 			std::unreachable();
 		}
 	}
 
-	auto parser::visit(clang::FunctionDecl const* decl, directive directive, description description)
-	  -> std::expected<parse_result_t, next_directive>
+	auto parser::visit(
+	  clang::FunctionDecl const* decl,
+	  directive directive,
+	  info::interned_string const description) -> std::vector<std::unique_ptr<info::basic_info>>
 	{
-		auto result = parse_result_t{
-		  .info = make_parse_result(*this, decl, directive, std::move(description.text)),
-		  .current = directive,
-		  .next = description.next,
-		};
+		if (directive.token->kind == command_info::headers
+		    or directive.token->kind == command_info::modules)
+		{
+			return parse_imports(directive, description);
+		}
 
-		if (result.info == nullptr) {
-			return std::unexpected(description.next);
+		auto result = std::vector<std::unique_ptr<info::basic_info>>();
+		if (auto info = make_parse_result(*this, decl, directive, description); info != nullptr) {
+			result.push_back(std::move(info));
 		}
 
 		return result;
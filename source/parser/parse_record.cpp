@@ -0,0 +1,34 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <clang/AST/DeclCXX.h>
+#include <clang/Basic/Diagnostic.h>
+#include <memory>
+#include <schreiber/diagnostic_ids.hpp>
+#include <schreiber/info.hpp>
+#include <schreiber/parser.hpp>
+#include <schreiber/string_interner.hpp>
+#include <vector>
+
+namespace parser {
+	auto parser::visit(
+	  clang::CXXRecordDecl const* const decl,
+	  directive const directive,
+	  info::interned_string const description) -> std::vector<std::unique_ptr<info::basic_info>>
+	{
+		switch (directive.token->kind) {
+		case command_info::headers:
+		case command_info::modules:
+			return parse_imports(directive, description);
+		case command_info::param:
+		case command_info::returns:
+		case command_info::pre:
+		case command_info::post:
+		case command_info::throws:
+		case command_info::exits_via:
+			diagnose(directive.location, diag::err_function_directive_on_record)
+			  << directive.token->kind << decl;
+			return {};
+		}
+	}
+} // namespace parser
@@ -9,38 +9,34 @@
 #include <clang/AST/Decl.h>
 #include <clang/AST/DeclCXX.h>
 #include <clang/AST/DeclFriend.h>
+#include <clang/AST/DeclTemplate.h>
 #include <clang/Basic/Diagnostic.h>
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Basic/SourceManager.h>
-#include <expected>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Casting.h>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <ranges>
 #include <schreiber/diagnostic_ids.hpp>
 #include <schreiber/info.hpp>
 #include <schreiber/parser.hpp>
+#include <schreiber/string_interner.hpp>
 #include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace stdr = std::ranges;
 namespace stdv = std::views;
 
 namespace parser {
 	namespace {
-		struct compare_locations {
-			[[nodiscard]] bool
-			operator()(clang::Decl const* const x, clang::Decl const* const y) const noexcept
-			{
-				assert(x != nullptr);
-				assert(y != nullptr);
-
-				return x->getLocation() < y->getLocation();
-			}
-		};
-
-		std::set<clang::Decl const*, compare_locations> undocumented_declarations;
-		std::set<clang::Decl const*, compare_locations> documented_declarations;
-
 		enum class entity {
 			class_template,
 			class_,
@@ -174,48 +170,30 @@ namespace parser {
 				return prefix_with::member;
 			}
 		}
-
-		struct lexed_result_t {
-			directive directive;
-			description description;
-		};
 	} // namespace
 
-	parser::parser(clang::ASTContext& context) noexcept
+	parser::parser(clang::ASTContext& context, info::string_interner& interner) noexcept
 	: context_(context)
 	, source_manager_(context.getSourceManager())
 	, diags_(context.getDiagnostics())
+	, interner_(interner)
 	{}
 
 	parser::~parser()
 	{
-		for (auto const i : undocumented_declarations) {
+		for (auto const i : undocumented_declarations_) {
 			diagnose_undocumented_decl(llvm::dyn_cast<clang::NamedDecl>(i));
 		}
 	}
 
-	[[nodiscard]]
-	static auto scan(
-	  parser& p,
-	  std::string_view const text,
-	  line_iterator const first,
-	  line_iterator const last,
-	  clang::SourceLocation const begin_loc,
-	  bool const has_description) -> std::expected<lexed_result_t, next_directive>
+	auto parser::compare_locations::operator()(
+	  clang::Decl const* const x,
+	  clang::Decl const* const y) const noexcept -> bool
 	{
-		auto const directive = directive::extract(text, begin_loc);
-		auto description =
-		  description::extract(first, last, std::string_view(directive.text.end(), text.end()), begin_loc);
-
-		if (directive.token != nullptr) {
-			return lexed_result_t{
-			  .directive = directive,
-			  .description = std::move(description),
-			};
-		}
+		assert(x != nullptr);
+		assert(y != nullptr);
 
-		p.diagnose_unknown_directive(begin_loc, directive.text, has_description, first->Begin);
-		return std::unexpected(description.next);
+		return x->getLocation() < y->getLocation();
 	}
 
 	// Computes the offset of the first directive. This is required since CommentLine operates on a
@@ -241,69 +219,196 @@ namespace parser {
 		return begin_location.getLocWithOffset(offset_by);
 	}
 
+	auto parser::lex(clang::RawComment const& comment) -> lexed_comment const&
+	{
+		auto const begin_loc = comment.getBeginLoc();
+		auto const [cached, inserted] = comments_.try_emplace(std::pair(
+		  std::string_view(comment.getRawText(source_manager_)),
+		  source_manager_.getPresumedColumnNumber(begin_loc)));
+		if (not inserted) {
+			return cached->second;
+		}
+
+		auto& result = cached->second;
+		auto const lines = comment.getFormattedLines(source_manager_, diags_);
+		auto first = stdr::find_if(lines, starts_with_backslash, &clang::RawComment::CommentLine::Text);
+		auto const description = std::span(lines.begin(), first);
+		auto const text_description = llvm::join(description | stdv::transform(to_text), "\n");
+		result.description = interner_.intern(text_description);
+		if (lines.empty()) {
+			return result;
+		}
+
+		auto const begin_offset = source_manager_.getFileOffset(begin_loc);
+		auto const begin_line = source_manager_.getPresumedLineNumber(begin_loc);
+		auto location =
+		  initial_directive_offset(source_manager_, begin_loc, lines[0], description, text_description);
+		while (first != lines.end()) {
+			auto const text = std::string_view(first->Text);
+			assert(text.starts_with('\\'));
+
+			auto const directive = directive::extract(text, location);
+			auto const lexed = description::extract(
+			  first,
+			  lines.end(),
+			  std::string_view(directive.text.end(), text.end()),
+			  location);
+			result.directives.push_back(lexed_comment::entry{
+			  .token = directive.token,
+			  .name = interner_.intern(directive.text),
+			  .description =
+			    directive.token != nullptr ? interner_.intern(lexed.text) : info::interned_string(),
+			  .offset = static_cast<int>(source_manager_.getFileOffset(location) - begin_offset),
+			  .line = first->Begin.getLine() - begin_line,
+			  .column = first->Begin.getColumn(),
+			});
+
+			location = lexed.next.location;
+			first = lexed.next.line;
+		}
+
+		return result;
+	}
+
 	void parser::parse_directives(
 	  info::entity_info& entity,
-	  line_iterator first,
-	  line_iterator last,
-	  clang::SourceLocation begin_loc)
+	  lexed_comment const& comment,
+	  clang::SourceLocation const begin_loc)
 	{
 		auto const decl = entity.decl();
-		auto const has_description = not entity.description().empty();
-		auto parse_directive = [this, &decl](lexed_result_t const& lexed_result) {
-			if (auto const function = llvm::dyn_cast<clang::FunctionDecl>(decl)) {
-				return visit(function, lexed_result.directive, lexed_result.description);
-			}
-
-			std::unreachable();
-		};
+		auto const record = llvm::dyn_cast<info::record_info>(&entity);
+		auto const has_description = not comment.description.empty();
+		auto const comment_begin = source_manager_.getPresumedLoc(begin_loc);
+		for (auto const& entry : comment.directives) {
+			auto const current = directive{
+			  .token = entry.token,
+			  .text = entry.name.view(),
+			  .location = begin_loc.getLocWithOffset(entry.offset),
+			};
 
-		auto store_directive = [this, &entity, &decl](parse_result_t parsed_result) {
-			switch (decl->getKind()) {
-			case clang::Decl::Function:
-				entity.store(*this, parsed_result.current, parsed_result.info.get());
-				break;
-			default:
-				assert(false and "not handled");
+			if (current.token == nullptr) {
+				auto const line_begin = clang::PresumedLoc(
+				  comment_begin.getFilename(),
+				  comment_begin.getFileID(),
+				  comment_begin.getLine() + entry.line,
+				  entry.column,
+				  comment_begin.getIncludeLoc());
+				diagnose_unknown_directive(current.location, current.text, has_description, line_begin);
+				continue;
 			}
 
-			return parsed_result.next;
-		};
+			auto const infos = record != nullptr
+			                 ? visit(record->record(), current, entry.description)
+			                 : visit(llvm::cast<clang::FunctionDecl>(decl), current, entry.description);
+			for (auto const& info : infos) {
+				entity.store(*this, current, info.get());
+			}
+		}
+	}
 
-		while (first != last) {
-			auto text = std::string_view(first->Text);
-			assert(text.starts_with('\\'));
+	auto parser::parse_imports(directive const directive, info::interned_string const description)
+	  -> std::vector<std::unique_ptr<info::basic_info>>
+	{
+		auto result = std::vector<std::unique_ptr<info::basic_info>>();
+		if (directive.token->kind == command_info::headers) {
+			for (auto const& header : parse_header_info(description.view(), interner_)) {
+				result.push_back(
+				  std::make_unique<info::decl_info::header_info>(header.name(), directive.location));
+			}
+		}
+		else {
+			for (auto const& module : parse_module_info(description.view(), interner_)) {
+				result.push_back(
+				  std::make_unique<info::decl_info::module_info>(module.name(), directive.location));
+			}
+		}
 
-			auto next_line =
-			  scan(*this, text, first, last, begin_loc, has_description)
-			    .and_then(parse_directive)
-			    .transform(store_directive);
+		return result;
+	}
 
-			if (not next_line) {
-				auto const& next = next_line.error();
-				begin_loc = next.location;
-				first = next.line;
-				continue;
-			}
+	/// Describes the template parameter ``decl``. Template parameters are named in the declaration
+	/// rather than in a directive, so they don't have a description.
+	[[nodiscard]] static auto make_template_parameter(clang::NamedDecl const* const decl)
+	  -> info::template_parameter_info
+	{
+		if (auto const type = llvm::dyn_cast<clang::TemplateTypeParmDecl>(decl)) {
+			return info::template_parameter_info(decl->getLocation(), type, "");
+		}
 
-			begin_loc = next_line->location;
-			first = next_line->line;
+		if (auto const value = llvm::dyn_cast<clang::NonTypeTemplateParmDecl>(decl)) {
+			return info::template_parameter_info(decl->getLocation(), value, "");
 		}
+
+		return info::template_parameter_info(
+		  decl->getLocation(),
+		  llvm::cast<clang::TemplateTemplateParmDecl>(decl),
+		  "");
 	}
 
 	[[nodiscard]]
 	static auto
-	make_entity_info(clang::NamedDecl const* const decl, std::string description, clang::SourceLocation location)
+	make_entity_info(
+	  clang::NamedDecl const* const decl,
+	  info::interned_string const description,
+	  clang::SourceLocation const location)
 	  -> std::unique_ptr<info::entity_info>
 	{
 		auto const i = decl->getKind();
 		switch (i) {
 		case clang::Decl::Function:
-			return std::make_unique<info::function_info>(decl->getAsFunction(), std::move(description), location);
+		case clang::Decl::CXXMethod:
+		case clang::Decl::CXXConstructor:
+		case clang::Decl::CXXDestructor:
+		case clang::Decl::CXXConversion:
+			return std::make_unique<info::function_info>(decl->getAsFunction(), description, location);
+		case clang::Decl::CXXRecord:
+			return std::make_unique<info::record_info>(
+			  llvm::cast<clang::CXXRecordDecl>(decl),
+			  description,
+			  location);
+		case clang::Decl::ClassTemplate: {
+			auto const class_template = llvm::cast<clang::ClassTemplateDecl>(decl);
+			auto result =
+			  std::make_unique<info::class_template_info>(class_template, description, location);
+			for (auto const parameter : *class_template->getTemplateParameters()) {
+				result->add_template_parameter(make_template_parameter(parameter));
+			}
+
+			return result;
+		}
 		default:
-			assert(false and "not handled");
+			// Documentation for other kinds of declaration isn't supported yet.
+			return nullptr;
 		}
 	}
 
+	/// Returns the member function that ``method`` overrides whose documentation it inherits: the
+	/// first one that has a comment of its own, looking at each member that ``method`` overrides
+	/// directly before the members that those override. Destructors document their own class, so
+	/// they don't inherit anything.
+	[[nodiscard]] static auto
+	find_documented_base(clang::ASTContext& context, clang::CXXMethodDecl const* const method)
+	  -> clang::CXXMethodDecl const*
+	{
+		if (llvm::isa<clang::CXXDestructorDecl>(method)) {
+			return nullptr;
+		}
+
+		for (auto const* const base : method->overridden_methods()) {
+			if (context.getRawCommentForAnyRedecl(base) != nullptr) {
+				return base->getCanonicalDecl();
+			}
+		}
+
+		for (auto const* const base : method->overridden_methods()) {
+			if (auto const documented = find_documented_base(context, base)) {
+				return documented;
+			}
+		}
+
+		return nullptr;
+	}
+
 	auto parser::parse(clang::NamedDecl const* const decl) -> std::unique_ptr<info::decl_info>
 	{
 		auto decl_context = decl->getDeclContext();
@@ -312,33 +417,37 @@ namespace parser {
 		}
 
 		auto const raw_comment = context_.getRawCommentForDeclNoCache(decl);
+		if (auto const method = llvm::dyn_cast<clang::CXXMethodDecl>(decl);
+		    raw_comment == nullptr and method != nullptr and method->isCanonicalDecl()
+		    and context_.getRawCommentForAnyRedecl(method) == nullptr)
+		{
+			// The base member's documentation is referred to rather than copied.
+			if (auto const base = find_documented_base(context_, method)) {
+				undocumented_declarations_.erase(method);
+				documented_declarations_.insert(method);
+				return std::make_unique<info::function_info>(method, base);
+			}
+		}
+
 		if (raw_comment == nullptr) {
 			if (auto const canonical = decl->getCanonicalDecl();
-			    not documented_declarations.contains(canonical))
+			    not documented_declarations_.contains(canonical))
 			{
-				undocumented_declarations.insert(canonical);
+				undocumented_declarations_.insert(canonical);
 			}
 			return nullptr;
 		}
 
-		undocumented_declarations.erase(decl->getCanonicalDecl());
-		documented_declarations.insert(decl->getCanonicalDecl());
+		undocumented_declarations_.erase(decl->getCanonicalDecl());
+		documented_declarations_.insert(decl->getCanonicalDecl());
 
-		auto const lines = raw_comment->getFormattedLines(source_manager_, diags_);
-
-		auto const description = std::span(
-		  lines.begin(),
-		  stdr::find_if(lines, starts_with_backslash, &clang::RawComment::CommentLine::Text));
-		auto text_description = llvm::join(description | stdv::transform(to_text), "\n");
-		auto const directive_location = initial_directive_offset(
-		  source_manager_,
-		  raw_comment->getBeginLoc(),
-		  lines[0],
-		  description,
-		  text_description);
+		auto const& lexed = lex(*raw_comment);
+		auto result = make_entity_info(decl, lexed.description, raw_comment->getBeginLoc());
+		if (result == nullptr) {
+			return nullptr;
+		}
 
-		auto result = make_entity_info(decl, std::move(text_description), raw_comment->getBeginLoc());
-		parse_directives(*result, description.end(), lines.end(), directive_location);
+		parse_directives(*result, lexed, raw_comment->getBeginLoc());
 		return result;
 	}
 
@@ -461,6 +570,97 @@ namespace parser {
 		return diags_.Report(loc, diag_id);
 	}
 
+	/// Returns the scope that ``decl`` opens, so that the next part of a qualified name can be looked
+	/// up in it.
+	[[nodiscard]] static auto as_scope(clang::NamedDecl const* const decl)
+	  -> clang::DeclContext const*
+	{
+		if (auto const alias = llvm::dyn_cast<clang::NamespaceAliasDecl>(decl)) {
+			return alias->getNamespace();
+		}
+
+		if (auto const name_space = llvm::dyn_cast<clang::NamespaceDecl>(decl)) {
+			return name_space;
+		}
+
+		if (auto const typedef_name = llvm::dyn_cast<clang::TypedefNameDecl>(decl)) {
+			return typedef_name->getUnderlyingType()->getAsCXXRecordDecl();
+		}
+
+		if (auto const class_template = llvm::dyn_cast<clang::ClassTemplateDecl>(decl)) {
+			return class_template->getTemplatedDecl();
+		}
+
+		return llvm::dyn_cast<clang::TagDecl>(decl);
+	}
+
+	/// Returns the declaration named ``name`` in ``scope`` that can be part of a type's name, or
+	/// ``nullptr`` if there isn't one. Only ``scope`` itself is searched, along with any inline
+	/// namespaces in it.
+	[[nodiscard]] static auto lookup_in(
+	  clang::ASTContext& context,
+	  clang::DeclContext const* const scope,
+	  llvm::StringRef const name) -> clang::NamedDecl const*
+	{
+		auto const declaration_name = clang::DeclarationName(&context.Idents.get(name));
+		for (auto const* const found : scope->getRedeclContext()->lookup(declaration_name)) {
+			auto const* const decl = found->getUnderlyingDecl();
+			if (llvm::isa<
+			      clang::TypeDecl,
+			      clang::NamespaceDecl,
+			      clang::NamespaceAliasDecl,
+			      clang::ClassTemplateDecl,
+			      clang::TypeAliasTemplateDecl>(decl))
+			{
+				return decl;
+			}
+		}
+
+		return nullptr;
+	}
+
+	auto parser::find_type(clang::DeclContext const* const scope, std::string_view const spelling)
+	  -> clang::NamedDecl const*
+	{
+		auto const [cached, inserted] = types_.try_emplace({scope, std::string(spelling)}, nullptr);
+		if (not inserted) {
+			return cached->second;
+		}
+
+		auto name = llvm::StringRef(spelling.data(), spelling.size());
+		name = name.take_until([](char const c) { return llvm::StringRef("<*&").contains(c); });
+		auto const global = name.consume_front("::");
+
+		auto components = llvm::SmallVector<llvm::StringRef>();
+		name.split(components, "::");
+		if (stdr::any_of(components, &llvm::StringRef::empty)) {
+			return nullptr;
+		}
+
+		// Only the first component is looked up in the enclosing scopes. The rest must be members of
+		// whatever the component before them names.
+		auto const* decl = static_cast<clang::NamedDecl const*>(nullptr);
+		for (auto const* s = global ? context_.getTranslationUnitDecl() : scope; s != nullptr;
+		     s = s->getParent())
+		{
+			if ((decl = lookup_in(context_, s, components.front())) != nullptr) {
+				break;
+			}
+		}
+
+		for (auto const component : stdv::drop(components, 1)) {
+			auto const* const next_scope = decl == nullptr ? nullptr : as_scope(decl);
+			decl = next_scope == nullptr ? nullptr : lookup_in(context_, next_scope, component);
+		}
+
+		if (decl != nullptr and llvm::isa<clang::NamespaceDecl, clang::NamespaceAliasDecl>(decl)) {
+			decl = nullptr;
+		}
+
+		cached->second = decl;
+		return decl;
+	}
+
 	auto to_text(clang::RawComment::CommentLine const& line) noexcept -> std::string_view
 	{
 		return line.Text;
@@ -520,23 +720,26 @@ namespace parser {
 	}
 
 	template<class T>
-	static auto parse_exported_by(std::string_view const description) -> std::vector<T>
+	static auto parse_exported_by(std::string_view const description, info::string_interner& interner)
+	  -> std::vector<T>
 	{
 		return stdv::split(description, ',') //
-		     | stdv::transform([](auto const h) {
+		     | stdv::transform([&interner](auto const h) {
 			       auto exporter = std::string_view(h.begin(), h.end());
-			       return T(std::string(absl::StripAsciiWhitespace(exporter)), {});
+			       return T(interner.intern(absl::StripAsciiWhitespace(exporter)), {});
 		       })
 		     | stdr::to<std::vector>();
 	}
 
-	auto parse_module_info(std::string_view const text) -> std::vector<info::decl_info::module_info>
+	auto parse_module_info(std::string_view const text, info::string_interner& interner)
+	  -> std::vector<info::decl_info::module_info>
 	{
-		return parse_exported_by<info::decl_info::module_info>(text);
+		return parse_exported_by<info::decl_info::module_info>(text, interner);
 	}
 
-	auto parse_header_info(std::string_view const text) -> std::vector<info::decl_info::header_info>
+	auto parse_header_info(std::string_view const text, info::string_interner& interner)
+	  -> std::vector<info::decl_info::header_info>
 	{
-		return parse_exported_by<info::decl_info::header_info>(text);
+		return parse_exported_by<info::decl_info::header_info>(text, interner);
 	}
 } // namespace parser
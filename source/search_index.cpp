@@ -0,0 +1,479 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <iterator>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/search_index.hpp>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace info {
+	namespace stdr = std::ranges;
+
+	using document_id = search_index::document_id;
+
+	namespace {
+		// The file starts with a header of six little-endian words: two for the magic number, then the
+		// number of documents, the number of terms, and the sizes of the postings and the strings.
+		// Next comes a (string offset, string size) pair for each document's USR, then a (string
+		// offset, string size, postings offset, document count) quadruple for each term, in term
+		// order. The postings and the strings make up the rest of the file.
+		constexpr auto magic = std::string_view("SCHRSRC1");
+		constexpr auto header_size = std::size_t{24};
+		constexpr auto document_entry_size = std::size_t{8};
+		constexpr auto term_entry_size = std::size_t{16};
+
+		[[nodiscard]] auto is_word_character(char const c) -> bool
+		{
+			auto const u = static_cast<unsigned char>(c);
+			return (u >= 'a' and u <= 'z') or (u >= 'A' and u <= 'Z') or (u >= '0' and u <= '9')
+			    or u == '_' or u >= 0x80;
+		}
+
+		[[nodiscard]] auto read32(char const* const base, std::size_t const i) -> std::uint32_t
+		{
+			return llvm::support::endian::read32le(base + i * sizeof(std::uint32_t));
+		}
+
+		void write32(llvm::raw_ostream& os, std::uint32_t const value)
+		{
+			char buffer[sizeof(value)];
+			llvm::support::endian::write32le(buffer, value);
+			os.write(buffer, sizeof(buffer));
+		}
+
+		/// Returns the sorted, deduplicated words in every description of ``entity``.
+		[[nodiscard]] auto entity_terms(detached_entity const& entity) -> std::vector<std::string>
+		{
+			auto result = std::vector<std::string>();
+			auto const add = [&result](std::string_view const description) {
+				auto terms = search_terms(description);
+				result.insert(
+				  result.end(),
+				  std::make_move_iterator(terms.begin()),
+				  std::make_move_iterator(terms.end()));
+			};
+
+			add(entity.documentation.description);
+			for (auto const* const parameters : {&entity.template_parameters, &entity.parameters}) {
+				for (auto const& parameter : *parameters) {
+					add(parameter.description);
+				}
+			}
+
+			if (entity.returns.has_value()) {
+				add(entity.returns->description);
+			}
+
+			for (auto const* const texts :
+			     {&entity.preconditions, &entity.postconditions, &entity.exits_via})
+			{
+				for (auto const& text : *texts) {
+					add(text.description);
+				}
+			}
+
+			for (auto const& exception : entity.throws) {
+				add(exception.type);
+				add(exception.description);
+			}
+
+			stdr::sort(result);
+			auto const duplicates = stdr::unique(result);
+			result.erase(duplicates.begin(), duplicates.end());
+			return result;
+		}
+
+		[[nodiscard]] auto
+		intersect(std::vector<document_id> const& x, std::vector<document_id> const& y)
+		  -> std::vector<document_id>
+		{
+			auto result = std::vector<document_id>();
+			stdr::set_intersection(x, y, std::back_inserter(result));
+			return result;
+		}
+
+		[[nodiscard]] auto
+		subtract(std::vector<document_id> const& x, std::vector<document_id> const& y)
+		  -> std::vector<document_id>
+		{
+			auto result = std::vector<document_id>();
+			stdr::set_difference(x, y, std::back_inserter(result));
+			return result;
+		}
+
+		[[nodiscard]] auto
+		unite(std::vector<document_id> const& x, std::vector<document_id> const& y)
+		  -> std::vector<document_id>
+		{
+			auto result = std::vector<document_id>();
+			stdr::set_union(x, y, std::back_inserter(result));
+			return result;
+		}
+	} // namespace
+
+	auto search_terms(std::string_view text) -> std::vector<std::string>
+	{
+		auto result = std::vector<std::string>();
+		while (not text.empty()) {
+			auto const begin = stdr::find_if(text, is_word_character);
+			auto const end = std::find_if_not(begin, text.end(), is_word_character);
+			if (begin == end) {
+				break;
+			}
+
+			auto& term = result.emplace_back(begin, end);
+			stdr::transform(term, term.begin(), [](char const c) {
+				return c >= 'A' and c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+			});
+			text.remove_prefix(static_cast<std::size_t>(end - text.begin()));
+		}
+
+		return result;
+	}
+
+	void search_index_builder::add(detached_translation_unit const& unit)
+	{
+		// Most of a project's entities are declared in headers, so most of them will have been added
+		// by an earlier translation unit, and only need a shared lock to be skipped.
+		auto pending = std::vector<detached_entity const*>();
+		{
+			auto const lock = std::shared_lock(mutex_);
+			for (auto const& entity : unit.entities()) {
+				if (not entity.usr.empty() and not documents_.contains(std::string(entity.usr))) {
+					pending.push_back(&entity);
+				}
+			}
+		}
+
+		auto terms = std::vector<std::vector<std::string>>();
+		terms.reserve(pending.size());
+		for (auto const* const entity : pending) {
+			terms.push_back(entity_terms(*entity));
+		}
+
+		auto const lock = std::unique_lock(mutex_);
+		for (auto i = std::size_t{0}; i < pending.size(); ++i) {
+			auto const id = static_cast<std::uint32_t>(documents_.size());
+			auto const [_, inserted] = documents_.try_emplace(std::string(pending[i]->usr), id);
+			if (not inserted) {
+				continue;
+			}
+
+			for (auto& term : terms[i]) {
+				postings_[std::move(term)].push_back(id);
+			}
+		}
+	}
+
+	auto search_index_builder::size() const -> std::size_t
+	{
+		auto const lock = std::shared_lock(mutex_);
+		return documents_.size();
+	}
+
+	void search_index_builder::write(llvm::raw_ostream& os) const
+	{
+		auto const lock = std::shared_lock(mutex_);
+
+		// Documents were numbered as translation units finished, which depends on scheduling.
+		auto documents = std::vector<std::pair<std::string_view, std::uint32_t>>();
+		documents.reserve(documents_.size());
+		for (auto const& [usr, id] : documents_) {
+			documents.emplace_back(usr, id);
+		}
+
+		stdr::sort(documents);
+		auto renumbered = std::vector<document_id>(documents.size());
+		for (auto i = std::size_t{0}; i < documents.size(); ++i) {
+			renumbered[documents[i].second] = static_cast<document_id>(i);
+		}
+
+		using term_postings = std::pair<std::string_view, std::vector<std::uint32_t> const*>;
+		auto terms = std::vector<term_postings>();
+		terms.reserve(postings_.size());
+		for (auto const& [term, ids] : postings_) {
+			terms.emplace_back(term, &ids);
+		}
+
+		stdr::sort(terms, {}, &term_postings::first);
+
+		auto strings = std::string();
+		auto postings = std::string();
+		auto document_table = std::vector<std::uint32_t>();
+		for (auto const& [usr, _] : documents) {
+			document_table.push_back(static_cast<std::uint32_t>(strings.size()));
+			document_table.push_back(static_cast<std::uint32_t>(usr.size()));
+			strings += usr;
+		}
+
+		auto term_table = std::vector<std::uint32_t>();
+		auto ids = std::vector<document_id>();
+		for (auto const& [term, original] : terms) {
+			ids.clear();
+			for (auto const id : *original) {
+				ids.push_back(renumbered[id]);
+			}
+
+			stdr::sort(ids);
+			term_table.push_back(static_cast<std::uint32_t>(strings.size()));
+			term_table.push_back(static_cast<std::uint32_t>(term.size()));
+			term_table.push_back(static_cast<std::uint32_t>(postings.size()));
+			term_table.push_back(static_cast<std::uint32_t>(ids.size()));
+			strings += term;
+
+			auto previous = document_id{0};
+			for (auto const id : ids) {
+				std::uint8_t bytes[5];
+				auto const size = llvm::encodeULEB128(id - previous, bytes);
+				postings.append(reinterpret_cast<char const*>(bytes), size);
+				previous = id;
+			}
+		}
+
+		os << magic;
+		write32(os, static_cast<std::uint32_t>(documents.size()));
+		write32(os, static_cast<std::uint32_t>(terms.size()));
+		write32(os, static_cast<std::uint32_t>(postings.size()));
+		write32(os, static_cast<std::uint32_t>(strings.size()));
+		for (auto const word : document_table) {
+			write32(os, word);
+		}
+
+		for (auto const word : term_table) {
+			write32(os, word);
+		}
+
+		os << postings << strings;
+	}
+
+	search_index::search_index(std::unique_ptr<llvm::MemoryBuffer> buffer)
+	: buffer_(std::move(buffer))
+	{}
+
+	auto search_index::load(std::string const& path) -> std::expected<search_index, std::string>
+	{
+		auto buffer = llvm::MemoryBuffer::getFile(
+		  path,
+		  /*IsText=*/false,
+		  /*RequiresNullTerminator=*/false);
+		if (not buffer) {
+			return std::unexpected("unable to read '" + path + "': " + buffer.getError().message());
+		}
+
+		auto result = parse(std::move(*buffer));
+		if (not result) {
+			return std::unexpected("'" + path + "' " + result.error());
+		}
+
+		return result;
+	}
+
+	auto search_index::parse(std::unique_ptr<llvm::MemoryBuffer> buffer)
+	  -> std::expected<search_index, std::string>
+	{
+		auto const data = buffer->getBuffer();
+		if (data.size() < header_size or not data.starts_with(magic)) {
+			return std::unexpected("isn't a search index");
+		}
+
+		auto result = search_index(std::move(buffer));
+		auto const* const header = data.data() + magic.size();
+		result.document_count_ = read32(header, 0);
+		result.term_count_ = read32(header, 1);
+		auto const postings_size = std::size_t{read32(header, 2)};
+		auto const strings_size = std::size_t{read32(header, 3)};
+
+		auto const documents_size = std::size_t{result.document_count_} * document_entry_size;
+		auto const terms_size = std::size_t{result.term_count_} * term_entry_size;
+		if (header_size + documents_size + terms_size + postings_size + strings_size != data.size()) {
+			return std::unexpected("is truncated");
+		}
+
+		result.documents_ = data.data() + header_size;
+		result.terms_ = result.documents_ + documents_size;
+		result.postings_ = std::string_view(result.terms_ + terms_size, postings_size);
+		result.strings_ = std::string_view(result.postings_.data() + postings_size, strings_size);
+
+		// Checking every entry up front means that lookups never need to.
+		auto const is_string = [&](char const* const table, std::size_t const i) {
+			auto const offset = std::size_t{read32(table, i)};
+			return offset <= strings_size and read32(table, i + 1) <= strings_size - offset;
+		};
+
+		for (auto i = std::size_t{0}; i < result.document_count_; ++i) {
+			if (not is_string(result.documents_, 2 * i)) {
+				return std::unexpected("has a document outside of its string table");
+			}
+		}
+
+		for (auto i = std::size_t{0}; i < result.term_count_; ++i) {
+			if (not is_string(result.terms_, 4 * i) or read32(result.terms_, 4 * i + 2) > postings_size)
+			{
+				return std::unexpected("has a term outside of its tables");
+			}
+		}
+
+		return result;
+	}
+
+	auto search_index::size() const noexcept -> std::size_t
+	{
+		return document_count_;
+	}
+
+	auto search_index::usr(document_id const id) const -> std::string_view
+	{
+		assert(id < document_count_);
+		return strings_.substr(read32(documents_, 2 * id), read32(documents_, 2 * id + 1));
+	}
+
+	auto search_index::term(std::uint32_t const i) const -> std::string_view
+	{
+		return strings_.substr(read32(terms_, 4 * i), read32(terms_, 4 * i + 1));
+	}
+
+	auto search_index::lower_bound(std::string_view const term) const -> std::uint32_t
+	{
+		auto const terms = std::views::iota(std::uint32_t{0}, term_count_);
+		auto const i = stdr::lower_bound(terms, term, {}, [this](std::uint32_t const i) {
+			return this->term(i);
+		});
+		return static_cast<std::uint32_t>(i - terms.begin());
+	}
+
+	auto search_index::decode(std::uint32_t const i) const -> std::vector<document_id>
+	{
+		auto const count = read32(terms_, 4 * i + 3);
+		auto const* const begin = reinterpret_cast<std::uint8_t const*>(postings_.data());
+		auto const* const end = begin + postings_.size();
+		auto const* p = begin + read32(terms_, 4 * i + 2);
+
+		auto result = std::vector<document_id>();
+		result.reserve(count);
+		auto id = std::uint64_t{0};
+		for (auto n = std::uint32_t{0}; n < count; ++n) {
+			auto length = 0U;
+			char const* error = nullptr;
+			id += llvm::decodeULEB128(p, &length, end, &error);
+			if (error != nullptr or id >= document_count_) {
+				break;
+			}
+
+			result.push_back(static_cast<document_id>(id));
+			p += length;
+		}
+
+		return result;
+	}
+
+	auto search_index::find(std::string_view const term) const -> std::vector<document_id>
+	{
+		auto const i = lower_bound(term);
+		return i < term_count_ and this->term(i) == term ? decode(i) : std::vector<document_id>();
+	}
+
+	auto search_index::find_prefix(std::string_view const prefix) const -> std::vector<document_id>
+	{
+		auto result = std::vector<document_id>();
+		for (auto i = lower_bound(prefix); i < term_count_ and term(i).starts_with(prefix); ++i) {
+			auto const ids = decode(i);
+			result.insert(result.end(), ids.begin(), ids.end());
+		}
+
+		stdr::sort(result);
+		auto const duplicates = stdr::unique(result);
+		result.erase(duplicates.begin(), duplicates.end());
+		return result;
+	}
+
+	auto search_index::search(std::string_view query) const -> std::vector<document_id>
+	{
+		auto const everything = [this] {
+			auto result = std::vector<document_id>(document_count_);
+			std::iota(result.begin(), result.end(), document_id{0});
+			return result;
+		};
+
+		// A word like ``std::vector`` is several terms, and matches documents that contain all of
+		// them. Only the last of them can be a prefix.
+		auto const match = [&](std::string_view word) {
+			auto const prefix = word.ends_with('*');
+			if (prefix) {
+				word.remove_suffix(1);
+			}
+
+			auto const terms = search_terms(word);
+			if (terms.empty()) {
+				return std::optional<std::vector<document_id>>();
+			}
+
+			auto result = prefix ? find_prefix(terms.back()) : find(terms.back());
+			for (auto i = std::size_t{0}; i + 1 < terms.size(); ++i) {
+				result = intersect(result, find(terms[i]));
+			}
+
+			return std::optional(std::move(result));
+		};
+
+		auto result = std::vector<document_id>();
+		auto included = std::optional<std::vector<document_id>>();
+		auto excluded = std::vector<document_id>();
+		auto any = false;
+		auto const finish_alternative = [&] {
+			if (any) {
+				result = unite(result, subtract(included ? *included : everything(), excluded));
+			}
+
+			included.reset();
+			excluded.clear();
+			any = false;
+		};
+
+		while (not query.empty()) {
+			auto const begin = query.find_first_not_of(" \t\n");
+			if (begin == std::string_view::npos) {
+				break;
+			}
+
+			query.remove_prefix(begin);
+			auto const word = query.substr(0, query.find_first_of(" \t\n"));
+			query.remove_prefix(word.size());
+
+			if (word == "OR") {
+				finish_alternative();
+			}
+			else if (word.starts_with('-')) {
+				if (auto const ids = match(word.substr(1))) {
+					excluded = unite(excluded, *ids);
+					any = true;
+				}
+			}
+			else if (auto ids = match(word)) {
+				included = included ? intersect(*included, *ids) : *std::move(ids);
+				any = true;
+			}
+		}
+
+		finish_alternative();
+		return result;
+	}
+} // namespace info
@@ -0,0 +1,79 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/hash/hash.h>
+#include <cstddef>
+#include <llvm/ADT/StringRef.h>
+#include <mutex>
+#include <numeric>
+#include <schreiber/string_interner.hpp>
+#include <shared_mutex>
+#include <string_view>
+
+namespace info {
+	auto string_interner::intern(std::string_view const s) -> interned_string
+	{
+		if (s.empty()) {
+			return {};
+		}
+
+		auto& shard = shards_[absl::Hash<std::string_view>()(s) % shard_count];
+		{
+			auto const lock = std::shared_lock(shard.mutex);
+			if (auto const i = shard.strings.find(s); i != shard.strings.end()) {
+				return {i->data(), i->size()};
+			}
+		}
+
+		auto const lock = std::unique_lock(shard.mutex);
+		if (auto const i = shard.strings.find(s); i != shard.strings.end()) {
+			return {i->data(), i->size()};
+		}
+
+		auto const stored = shard.saver.save(llvm::StringRef(s.data(), s.size()));
+		shard.strings.emplace(stored.data(), stored.size());
+		return {stored.data(), stored.size()};
+	}
+
+	auto string_interner::find(std::string_view const s) const -> interned_string
+	{
+		if (s.empty()) {
+			return {};
+		}
+
+		auto const& shard = shards_[absl::Hash<std::string_view>()(s) % shard_count];
+		auto const lock = std::shared_lock(shard.mutex);
+		auto const i = shard.strings.find(s);
+		return i != shard.strings.end() ? interned_string(i->data(), i->size()) : interned_string();
+	}
+
+	auto string_interner::size() const -> std::size_t
+	{
+		return std::accumulate(
+		  shards_.begin(),
+		  shards_.end(),
+		  std::size_t{0},
+		  [](std::size_t const n, shard const& s) {
+			  auto const lock = std::shared_lock(s.mutex);
+			  return n + s.strings.size();
+		  });
+	}
+
+	auto string_interner::allocated_bytes() const -> std::size_t
+	{
+		return std::accumulate(
+		  shards_.begin(),
+		  shards_.end(),
+		  std::size_t{0},
+		  [](std::size_t const n, shard const& s) {
+			  auto const lock = std::shared_lock(s.mutex);
+			  return n + s.allocator.getTotalMemory();
+		  });
+	}
+
+	auto string_interner::global() -> string_interner&
+	{
+		static auto interner = string_interner();
+		return interner;
+	}
+} // namespace info
@@ -0,0 +1,115 @@
+# Copyright (c) Google LLC.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+#
+import fcntl
+import hashlib
+import os
+import re
+import shlex
+import subprocess
+
+import lit.formats
+import lit.TestRunner
+
+
+class BatchedVerifyTest(lit.formats.ShTest):
+    """A shell test format that verifies every test that runs ``%{verify} %s`` with one
+    ``verify-diagnostics --batch`` process, so that clang is set up once per run rather than once
+    per test.
+
+    Each test still runs its own RUN lines, but ``%{verify} %s`` reads the test's share of the
+    batch's output, with the test's path reported as ``input.cc``, as ``verify-diagnostics`` does
+    for a single file. Tests that don't compile are run on their own, so that their output and exit
+    status are exactly what they'd be without batching.
+    """
+
+    command = '%{verify} %s'
+    marker = 'verify-diagnostics: '
+
+    def __init__(self, execute_external=False):
+        super().__init__(execute_external)
+        self.tests = None
+
+    def execute(self, test, litConfig):
+        output = None if litConfig.noExecute else self.batch_output(test)
+        if output is None:
+            return super().execute(test, litConfig)
+
+        return lit.TestRunner.executeShTest(
+            test,
+            litConfig,
+            self.execute_external,
+            extra_substitutions=[(re.escape(self.command), f'cat {shlex.quote(output)}')])
+
+    def batched_tests(self, source_root):
+        """Returns the tests whose RUN lines can read their output from the batch."""
+        if self.tests is None:
+            self.tests = []
+            for directory, _, files in os.walk(source_root):
+                for file in files:
+                    path = os.path.join(directory, file)
+                    if not file.endswith('.cc'):
+                        continue
+                    with open(path) as f:
+                        if f'RUN: {self.command} ' in f.read():
+                            self.tests.append(path)
+            self.tests.sort()
+        return self.tests
+
+    def batch_output(self, test):
+        """Returns the path to ``test``'s share of the batch's output, running the batch if no other
+        test has run it yet, or ``None`` if ``test`` needs to run on its own."""
+        path = test.getSourcePath()
+        tests = self.batched_tests(test.suite.source_root)
+        if path not in tests:
+            return None
+
+        verify = next(b for a, b in test.config.substitutions if a == '%{verify}')
+
+        # lit runs tests in several processes, so the batch's output is shared through the file
+        # system. It's keyed on everything that it depends on, so that it's rerun when any of it
+        # changes.
+        key = hashlib.sha256()
+        for file in [verify] + tests:
+            key.update(f'{file}:{os.stat(file).st_mtime_ns}\n'.encode())
+        directory = os.path.join(test.suite.exec_root, 'verify-batch', key.hexdigest()[:16])
+        os.makedirs(directory, exist_ok=True)
+
+        with open(os.path.join(directory, 'lock'), 'w') as lock:
+            fcntl.flock(lock, fcntl.LOCK_EX)
+            done = os.path.join(directory, 'done')
+            if not os.path.exists(done):
+                self.run_batch(verify, tests, directory)
+                open(done, 'w').close()
+
+        output = self.output_path(directory, path)
+        return output if os.path.exists(output) else None
+
+    def run_batch(self, verify, tests, directory):
+        """Verifies ``tests`` in one process, and splits its output into a file per test."""
+        result = subprocess.run(
+            [verify, '--batch'] + tests,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.PIPE,
+            text=True)
+
+        sections = {}
+        current = None
+        for line in result.stderr.splitlines(keepends=True):
+            if line.startswith(self.marker):
+                current = line[len(self.marker):].rstrip('\n')
+                sections[current] = []
+            elif current is not None:
+                sections[current].append(line)
+
+        for path, lines in sections.items():
+            output = ''.join(lines)
+            if f'Error while processing {path}.' in output:
+                continue
+
+            with open(self.output_path(directory, path), 'w') as file:
+                file.write(output.replace(path, 'input.cc'))
+
+    @staticmethod
+    def output_path(directory, path):
+        return os.path.join(directory, hashlib.sha256(path.encode()).hexdigest()[:16] + '.txt')
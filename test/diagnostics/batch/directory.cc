@@ -0,0 +1,20 @@
+// clang-format off
+// RUN: rm -rf %t && mkdir -p %t/nested
+// RUN: cp %S/../functions/repeated_return.cc %t/
+// RUN: cp %S/../functions/unknown_parameter.cc %t/nested/
+// RUN: echo 'int broken = ;' > %t/broken.cc
+// RUN: echo 'this file is ignored' > %t/ignored.txt
+// RUN: not %{verify} --batch %t 2>&1 | \
+// RUN: FileCheck %s --match-full-lines
+
+// CHECK: verify-diagnostics: {{.*}}broken.cc
+// CHECK: {{.*}}broken.cc:1:14: error: expected expression
+// CHECK: Error while processing {{.*}}broken.cc.
+// CHECK: verify-diagnostics: {{.*}}unknown_parameter.cc
+// CHECK: {{.*}}unknown_parameter.cc:6:12: error: documented parameter 'denominator' does not map to a parameter in this declaration of 'div'
+// CHECK: {{.*}}unknown_parameter.cc:6:12: note: the word immediately after '\param' must name one of the parameters in the function declaration
+// CHECK: verify-diagnostics: {{.*}}repeated_return.cc
+// CHECK: {{.*}}repeated_return.cc:6:5: error: repeated '\returns' directive for function 'cube'
+// CHECK: {{.*}}repeated_return.cc:5:5: note: previous definition is here
+// CHECK: {{.*}}repeated_return.cc:7:5: error: repeated '\returns' directive for function 'cube'
+// CHECK: {{.*}}repeated_return.cc:5:5: note: previous definition is here
@@ -0,0 +1,22 @@
+// clang-format off
+// RUN: %{verify} %s 2>&1 | \
+// RUN: FileCheck %s --match-full-lines --implicit-check-not=error --implicit-check-not=warning --implicit-check-not=note --allow-empty
+
+/// A pirate ship.
+struct ship {
+	/// Sails to ``port``.
+	virtual void sail(int port);
+
+	/// Sinks the ship.
+	virtual ~ship();
+};
+
+/// A two-masted ship.
+struct brig : ship {
+	void sail(int port) override;
+
+	/// Sinks the brig.
+	~brig() override;
+};
+
+void brig::sail(int) {}
@@ -0,0 +1,8 @@
+// clang-format off
+// RUN: %{verify} %s 2>&1 | \
+// RUN: FileCheck %s --match-full-lines --implicit-check-not=error --implicit-check-not=warning --implicit-check-not=note
+
+/// \throws int Never.
+void stop() noexcept;
+// CHECK: input.cc:5:5: error: '\throws' directive for 'stop', which is declared as non-throwing
+// CHECK: input.cc:6:13: note: 'stop' is declared as non-throwing here
@@ -0,0 +1,15 @@
+// clang-format off
+// RUN: %{verify} %s 2>&1 | \
+// RUN: FileCheck %s --match-full-lines --implicit-check-not=error --implicit-check-not=warning --implicit-check-not=note
+
+namespace app {
+	/// Reports a failure to load a file.
+	struct error {};
+} // namespace app
+
+/// \throws app::error If the file can't be opened.
+/// \throws Mistake If the file is empty.
+/// \throws int If the file is too large.
+void load(char const* path);
+// CHECK: input.cc:11:13: warning: documented exception type 'Mistake' does not name a type that is visible from 'load'
+// CHECK: input.cc:11:13: note: the word immediately after '\throws' must name the type of the exception
@@ -0,0 +1,17 @@
+// clang-format off
+// RUN: %{verify} %s 2>&1 | \
+// RUN: FileCheck %s --match-full-lines --implicit-check-not=error --implicit-check-not=warning --implicit-check-not=note
+
+/// A pirate ship.
+/// \param crew How many pirates are aboard.
+/// \returns Nothing at all.
+/// \headers <ship.hpp>
+struct ship {};
+// CHECK: input.cc:6:5: error: '\param' directive for 'ship', which is not a function
+// CHECK: input.cc:7:5: error: '\returns' directive for 'ship', which is not a function
+
+/// A ship that carries ``Cargo``.
+/// \throws int Never.
+template<class Cargo>
+class galleon {};
+// CHECK: input.cc:14:5: error: '\throws' directive for 'galleon', which is not a function
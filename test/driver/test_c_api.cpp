@@ -0,0 +1,165 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <memory>
+#include <schreiber/schreiber.h>
+#include <string_view>
+
+namespace {
+	[[nodiscard]] auto view(schreiber_string const s) -> std::string_view
+	{
+		return {s.data, s.size};
+	}
+
+	constexpr auto path = std::string_view("/schreiber-c-api/pirates.cc");
+	constexpr auto source = std::string_view(R"(
+		namespace crew {
+			struct mutiny {};
+
+			/// Counts the crew's treasure.
+			/// \param chests How many chests were found.
+			/// \pre ``chests`` isn't negative.
+			/// \throws mutiny If the crew disagrees.
+			/// \returns The number of doubloons.
+			int count(int chests);
+
+			/// Splits the treasure that crew::count() found.
+			/// \param doubloons The number of doubloons.
+			void split(int doubloons);
+		})");
+
+	struct session_deleter {
+		void operator()(schreiber_session* const session) const noexcept
+		{
+			schreiber_session_destroy(session);
+		}
+	};
+
+	TEST_CASE("buffers are extracted without being saved")
+	{
+		auto const session = std::unique_ptr<schreiber_session, session_deleter>(
+		  schreiber_session_create());
+		REQUIRE(session != nullptr);
+		CHECK(schreiber_api_version() == SCHREIBER_API_VERSION);
+
+		REQUIRE(
+		  schreiber_session_add_buffer(session.get(), path.data(), source.data(), source.size())
+		  == SCHREIBER_OK);
+		auto const arguments = std::array{"clang++", "-std=c++23", path.data()};
+		REQUIRE(
+		  schreiber_session_add_file(
+		    session.get(),
+		    "/schreiber-c-api",
+		    path.data(),
+		    arguments.data(),
+		    arguments.size())
+		  == SCHREIBER_OK);
+		REQUIRE(schreiber_session_run(session.get(), 1) == SCHREIBER_OK);
+
+		REQUIRE(schreiber_session_translation_unit_count(session.get()) == 1);
+		auto const* const unit = schreiber_session_translation_unit(session.get(), 0);
+		CHECK(view(schreiber_translation_unit_file(unit)) == path);
+		CHECK(schreiber_translation_unit_get_status(unit) == SCHREIBER_TRANSLATION_UNIT_OK);
+		REQUIRE(schreiber_translation_unit_entity_count(unit) == 2);
+
+		auto const* const count = schreiber_translation_unit_entity(unit, 0);
+		CHECK(schreiber_entity_get_kind(count) == SCHREIBER_ENTITY_FUNCTION);
+		CHECK(view(schreiber_entity_qualified_name(count)) == "crew::count");
+		CHECK(view(schreiber_entity_documentation(count).description) == "Counts the crew's treasure.");
+		CHECK(schreiber_entity_location(count).line == 10);
+
+		REQUIRE(schreiber_entity_directive_count(count, SCHREIBER_DIRECTIVE_PARAMETER) == 1);
+		auto const parameter = schreiber_entity_directive(count, SCHREIBER_DIRECTIVE_PARAMETER, 0);
+		CHECK(view(parameter.name) == "chests");
+		CHECK(view(parameter.type) == "int");
+		CHECK(view(parameter.description) == "How many chests were found.");
+		CHECK(schreiber_entity_directive_count(count, SCHREIBER_DIRECTIVE_PRECONDITION) == 1);
+
+		REQUIRE(schreiber_entity_directive_count(count, SCHREIBER_DIRECTIVE_THROWS) == 1);
+		auto const throws = schreiber_entity_directive(count, SCHREIBER_DIRECTIVE_THROWS, 0);
+		CHECK(view(throws.type) == "mutiny");
+		CHECK(view(throws.usr) == "c:@N@crew@S@mutiny");
+
+		auto returns = schreiber_directive();
+		REQUIRE(schreiber_entity_returns(count, &returns) != 0);
+		CHECK(view(returns.description) == "The number of doubloons.");
+
+		auto const* const split = schreiber_translation_unit_entity(unit, 1);
+		CHECK(schreiber_entity_returns(split, &returns) == 0);
+		REQUIRE(schreiber_entity_directive_count(split, SCHREIBER_DIRECTIVE_REFERENCE) == 1);
+		auto const reference = schreiber_entity_directive(split, SCHREIBER_DIRECTIVE_REFERENCE, 0);
+		CHECK(view(reference.name) == "crew::count");
+		CHECK(view(reference.usr) == view(schreiber_entity_usr(count)));
+	}
+
+	TEST_CASE("records and inherited documentation are extracted")
+	{
+		auto const session = std::unique_ptr<schreiber_session, session_deleter>(
+		  schreiber_session_create());
+		constexpr auto fleet = std::string_view("/schreiber-c-api/fleet.cc");
+		constexpr auto contents = std::string_view(R"(
+			/// A ship.
+			struct ship {
+				/// Sails to ``port``.
+				virtual void sail(int port);
+			};
+
+			/// A two-masted ship.
+			struct brig : ship {
+				void sail(int port) override;
+			};)");
+		REQUIRE(
+		  schreiber_session_add_buffer(session.get(), fleet.data(), contents.data(), contents.size())
+		  == SCHREIBER_OK);
+		REQUIRE(
+		  schreiber_session_add_file(session.get(), "/schreiber-c-api", fleet.data(), nullptr, 0)
+		  == SCHREIBER_OK);
+		REQUIRE(schreiber_session_run(session.get(), 1) == SCHREIBER_OK);
+
+		auto const* const unit = schreiber_session_translation_unit(session.get(), 0);
+		REQUIRE(schreiber_translation_unit_entity_count(unit) == 4);
+		auto const* const ship = schreiber_translation_unit_entity(unit, 0);
+		CHECK(schreiber_entity_get_kind(ship) == SCHREIBER_ENTITY_RECORD);
+		CHECK(view(schreiber_entity_type(ship)) == "struct");
+		CHECK(view(schreiber_entity_inherits_from(ship)).empty());
+
+		auto const* const sail = schreiber_translation_unit_entity(unit, 1);
+		auto const* const brig_sail = schreiber_translation_unit_entity(unit, 3);
+		CHECK(view(schreiber_entity_qualified_name(brig_sail)) == "brig::sail");
+		CHECK(view(schreiber_entity_inherits_from(brig_sail)) == view(schreiber_entity_usr(sail)));
+		CHECK(view(schreiber_entity_documentation(brig_sail).description).empty());
+	}
+
+	TEST_CASE("buffers need an absolute path")
+	{
+		auto const session = std::unique_ptr<schreiber_session, session_deleter>(
+		  schreiber_session_create());
+		CHECK(
+		  schreiber_session_add_buffer(session.get(), "pirates.cc", source.data(), source.size())
+		  == SCHREIBER_INVALID_ARGUMENT);
+		CHECK(view(schreiber_session_last_error(session.get())) == "buffers need an absolute path");
+	}
+
+	TEST_CASE("translation units that don't compile are reported, but kept")
+	{
+		auto const session = std::unique_ptr<schreiber_session, session_deleter>(
+		  schreiber_session_create());
+		constexpr auto broken = std::string_view("/schreiber-c-api/broken.cc");
+		constexpr auto contents = std::string_view("int main() { return }");
+		REQUIRE(
+		  schreiber_session_add_buffer(session.get(), broken.data(), contents.data(), contents.size())
+		  == SCHREIBER_OK);
+		REQUIRE(
+		  schreiber_session_add_file(session.get(), "/schreiber-c-api", broken.data(), nullptr, 0)
+		  == SCHREIBER_OK);
+		CHECK(schreiber_session_run(session.get(), 1) == SCHREIBER_FAILED);
+
+		REQUIRE(schreiber_session_translation_unit_count(session.get()) == 1);
+		auto const* const unit = schreiber_session_translation_unit(session.get(), 0);
+		CHECK(schreiber_translation_unit_get_status(unit) == SCHREIBER_TRANSLATION_UNIT_FAILED);
+		CHECK(view(schreiber_translation_unit_diagnostics(unit)).contains("error"));
+	}
+} // namespace
@@ -0,0 +1,33 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <schreiber/cancellation.hpp>
+#include <thread>
+
+namespace {
+	using namespace std::chrono_literals;
+
+	TEST_CASE("tokens without a deadline are only cancelled explicitly")
+	{
+		auto const unlimited = driver::cancellation_token::after(0ms);
+		CHECK(not unlimited.is_cancelled());
+
+		auto token = driver::cancellation_token();
+		CHECK(not token.is_cancelled());
+		token.cancel();
+		CHECK(token.is_cancelled());
+	}
+
+	TEST_CASE("tokens are cancelled once their deadline passes")
+	{
+		auto const expired = driver::cancellation_token(driver::cancellation_token::clock::now());
+		CHECK(expired.is_cancelled());
+
+		auto const token = driver::cancellation_token::after(20ms);
+		CHECK(not token.is_cancelled());
+		std::this_thread::sleep_for(30ms);
+		CHECK(token.is_cancelled());
+	}
+} // namespace
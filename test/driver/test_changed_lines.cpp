@@ -0,0 +1,89 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <schreiber/changed_lines.hpp>
+#include <string_view>
+#include <vector>
+
+namespace {
+	using driver::changed_lines;
+	using driver::line_range;
+
+	[[nodiscard]] auto ranges(changed_lines const& changes, std::string_view const file)
+	  -> std::vector<line_range>
+	{
+		auto const found = changes.find(file);
+		return {found.begin(), found.end()};
+	}
+
+	TEST_CASE("hunks without context are mapped to the new file's lines")
+	{
+		constexpr auto diff = std::string_view(
+		  "diff --git a/include/a.hpp b/include/a.hpp\n"
+		  "index 0123456..789abcd 100644\n"
+		  "--- a/include/a.hpp\n"
+		  "+++ b/include/a.hpp\n"
+		  "@@ -3 +3,2 @@ namespace a {\n"
+		  "-\t/// Old.\n"
+		  "+\t/// New.\n"
+		  "+\t///\n"
+		  "@@ -20,0 +22 @@ namespace a {\n"
+		  "+\tvoid g();\n"
+		  "@@ -30,2 +31,0 @@ namespace a {\n"
+		  "-\t/// Removed.\n"
+		  "-\tvoid h();\n");
+
+		auto const changes = changed_lines::parse(diff, "/src");
+		REQUIRE(changes.has_value());
+		CHECK(changes->files() == std::vector<std::string_view>{"/src/include/a.hpp"});
+		CHECK(
+		  ranges(*changes, "/src/include/a.hpp")
+		  == std::vector<line_range>{{2, 4}, {22, 22}, {31, 32}});
+	}
+
+	TEST_CASE("context lines aren't counted as changes")
+	{
+		constexpr auto diff = std::string_view(
+		  "--- a/a.cpp\n"
+		  "+++ b/a.cpp\n"
+		  "@@ -1,3 +1,3 @@\n"
+		  " int x;\n"
+		  "-int y;\n"
+		  "+long y;\n"
+		  " int z;\n");
+
+		auto const changes = changed_lines::parse(diff, "/src");
+		REQUIRE(changes.has_value());
+		CHECK(ranges(*changes, "/src/a.cpp") == std::vector<line_range>{{1, 2}});
+		CHECK(changes->overlaps("/src/a.cpp", {2, 2}));
+		CHECK(not changes->overlaps("/src/a.cpp", {3, 10}));
+		CHECK(not changes->overlaps("/src/b.cpp", {1, 10}));
+	}
+
+	TEST_CASE("deleted files are ignored")
+	{
+		constexpr auto diff = std::string_view(
+		  "--- a/gone.hpp\n"
+		  "+++ /dev/null\n"
+		  "@@ -1,2 +0,0 @@\n"
+		  "-+++ b/not-a-header.hpp\n"
+		  "-@@ -1 +1 @@\n"
+		  "--- /dev/null\n"
+		  "+++ b/new.hpp\n"
+		  "@@ -0,0 +1 @@\n"
+		  "+void f();\n");
+
+		auto const changes = changed_lines::parse(diff, "/src");
+		REQUIRE(changes.has_value());
+		CHECK(changes->files() == std::vector<std::string_view>{"/src/new.hpp"});
+		CHECK(ranges(*changes, "/src/new.hpp") == std::vector<line_range>{{1, 1}});
+	}
+
+	TEST_CASE("malformed diffs are rejected")
+	{
+		CHECK(not changed_lines::parse("@@ -1 +1 @@\n-a\n+b\n", "/src").has_value());
+		CHECK(not changed_lines::parse("+++ b/a.cpp\n@@ -1 +x @@\n", "/src").has_value());
+		CHECK(not changed_lines::parse("+++ b/a.cpp\n@@ -1,2 +1,2 @@\n-a\n", "/src").has_value());
+	}
+} // namespace
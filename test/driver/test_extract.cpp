@@ -0,0 +1,148 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclGroup.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Frontend/MultiplexConsumer.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <memory>
+#include <schreiber/cancellation.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+	/// Cancels ``token`` once the declaration named ``name`` has been parsed, as though the
+	/// translation unit's deadline had passed right after it.
+	class cancel_after final : public clang::ASTConsumer {
+	public:
+		cancel_after(driver::cancellation_token& token, std::string_view const name) noexcept
+		: token_(&token)
+		, name_(name)
+		{}
+
+		auto HandleTopLevelDecl(clang::DeclGroupRef const decls) -> bool override
+		{
+			for (auto const decl : decls) {
+				if (auto const named = llvm::dyn_cast<clang::NamedDecl>(decl);
+				    named != nullptr and named->getName() == name_)
+				{
+					token_->cancel();
+				}
+			}
+
+			return true;
+		}
+	private:
+		driver::cancellation_token* token_;
+		std::string_view name_;
+	};
+
+	class cancelling_action final : public clang::ASTFrontendAction {
+	public:
+		cancelling_action(
+		  driver::translation_unit_result& result,
+		  driver::cancellation_token& token,
+		  std::string_view const name) noexcept
+		: result_(&result)
+		, token_(&token)
+		, name_(name)
+		{}
+	protected:
+		auto CreateASTConsumer(clang::CompilerInstance&, llvm::StringRef)
+		  -> std::unique_ptr<clang::ASTConsumer> override
+		{
+			auto consumers = std::vector<std::unique_ptr<clang::ASTConsumer>>();
+			consumers.push_back(std::make_unique<cancel_after>(*token_, name_));
+			consumers.push_back(std::make_unique<driver::extract_consumer>(
+			  *result_,
+			  driver::extract_options{.cancel = token_}));
+			return std::make_unique<clang::MultiplexConsumer>(std::move(consumers));
+		}
+	private:
+		driver::translation_unit_result* result_;
+		driver::cancellation_token* token_;
+		std::string_view name_;
+	};
+
+	[[nodiscard]] auto has_entity(
+	  driver::translation_unit_result const& result,
+	  std::string_view const name) -> bool
+	{
+		return std::ranges::any_of(result.unit.entities(), [name](auto const& entity) {
+			return entity.qualified_name == name;
+		});
+	}
+
+	TEST_CASE("translation units that are cancelled while parsing keep what was parsed")
+	{
+		auto result = driver::translation_unit_result();
+		auto token = driver::cancellation_token();
+		REQUIRE(clang::tooling::runToolOnCodeWithArgs(
+		  std::make_unique<cancelling_action>(result, token, "mutiny"),
+		  R"(
+				namespace crew {
+					/// Counts the crew.
+					int count();
+				}
+
+				/// Raised when the crew disagrees.
+				struct mutiny {};
+
+				/// Splits the treasure.
+				void split();
+			)",
+		  std::vector<std::string>{"-std=c++23"}));
+
+		CHECK(token.is_cancelled());
+		CHECK(has_entity(result, "crew::count"));
+		CHECK(has_entity(result, "mutiny"));
+		CHECK(not has_entity(result, "split"));
+	}
+
+	TEST_CASE("files that are cached aren't counted by each translation unit")
+	{
+		// The header is far larger than the buffers that the compiler makes for itself, so it can't
+		// hide among them.
+		auto const header = "/// Counts the crew.\nint count();\n" + std::string(1 << 20, '\n');
+		auto const memory = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+		memory->addFile("/crew/crew.hpp", 0, llvm::MemoryBuffer::getMemBuffer(header));
+		memory->addFile("/crew/input.cc", 0, llvm::MemoryBuffer::getMemBuffer("#include <crew.hpp>"));
+		auto const file_system =
+		  llvm::makeIntrusiveRefCnt<llvm::vfs::OverlayFileSystem>(llvm::vfs::getRealFileSystem());
+		file_system->pushOverlay(memory);
+
+		auto cache = driver::file_cache();
+		auto const command = clang::tooling::CompileCommand(
+		  "/crew",
+		  "/crew/input.cc",
+		  {"clang++", "-std=c++23", "-I/crew", "/crew/input.cc"},
+		  "");
+		auto const result = driver::extract(command, cache, {.file_system = file_system.get()});
+		REQUIRE(result.status == driver::translation_unit_result::status_t::ok);
+		CHECK(has_entity(result, "count"));
+
+		using category = driver::memory_stats::category;
+		CHECK(result.memory[category::source_buffers].bytes < header.size());
+
+		auto total = driver::memory_stats();
+		total += result.memory;
+		total.record(cache);
+		CHECK(total[category::cached_files].bytes >= header.size());
+	}
+} // namespace
@@ -0,0 +1,119 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <memory>
+#include <schreiber/file_cache.hpp>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+	namespace vfs = llvm::vfs;
+
+	/// Counts the requests that reach the real file system.
+	class counting_file_system final : public vfs::ProxyFileSystem {
+	public:
+		explicit counting_file_system(llvm::IntrusiveRefCntPtr<vfs::FileSystem> underlying)
+		: ProxyFileSystem(std::move(underlying))
+		{}
+
+		auto status(llvm::Twine const& path) -> llvm::ErrorOr<vfs::Status> override
+		{
+			++stats;
+			return ProxyFileSystem::status(path);
+		}
+
+		auto openFileForRead(llvm::Twine const& path)
+		  -> llvm::ErrorOr<std::unique_ptr<vfs::File>> override
+		{
+			++opens;
+			return ProxyFileSystem::openFileForRead(path);
+		}
+
+		std::atomic<int> stats = 0;
+		std::atomic<int> opens = 0;
+	};
+
+	[[nodiscard]] auto make_file_system() -> llvm::IntrusiveRefCntPtr<counting_file_system>
+	{
+		auto memory = llvm::makeIntrusiveRefCnt<vfs::InMemoryFileSystem>();
+		memory->addFile("/project/include/header.hpp", 0, llvm::MemoryBuffer::getMemBuffer("int x;"));
+		memory->addFile("/project/a.cc", 0, llvm::MemoryBuffer::getMemBuffer("#include <header.hpp>"));
+		return llvm::makeIntrusiveRefCnt<counting_file_system>(memory);
+	}
+
+	TEST_CASE("files are only stat'ed and read once")
+	{
+		auto const real = make_file_system();
+		auto cache = driver::file_cache();
+
+		auto const first = driver::make_caching_file_system(cache, real);
+		REQUIRE(not first->setCurrentWorkingDirectory("/project"));
+		auto const second = driver::make_caching_file_system(cache, real);
+		REQUIRE(not second->setCurrentWorkingDirectory("/project/include"));
+
+		// Changing directory stats the new working directory.
+		auto const stats = real->stats.load();
+		auto const relative = first->status("include/header.hpp");
+		REQUIRE(relative);
+		CHECK(relative->getName() == "include/header.hpp");
+		CHECK(relative->getSize() == 6);
+
+		auto const absolute = second->status("/project/include/./header.hpp");
+		REQUIRE(absolute);
+		CHECK(absolute->getName() == "/project/include/./header.hpp");
+		CHECK(real->stats == stats + 1);
+
+		CHECK(not first->status("missing.hpp"));
+		CHECK(not second->status("/project/missing.hpp"));
+		CHECK(real->stats == stats + 2);
+
+		for (auto const& file_system : {first, second}) {
+			auto file = file_system->openFileForRead("/project/include/header.hpp");
+			REQUIRE(file);
+			auto const buffer = (*file)->getBuffer("header.hpp");
+			REQUIRE(buffer);
+			CHECK((*buffer)->getBuffer() == "int x;");
+			CHECK(cache.holds((*buffer)->getBuffer()));
+		}
+		CHECK(real->opens == 1);
+		CHECK(cache.size() == 4);
+		CHECK(cache.content_bytes() == 6);
+		CHECK(not cache.holds(std::string("int x;")));
+	}
+
+	TEST_CASE("the cache can be shared between threads")
+	{
+		auto const real = make_file_system();
+		auto cache = driver::file_cache();
+		auto failures = std::atomic<int>(0);
+		{
+			auto workers = std::vector<std::jthread>();
+			for (auto i = 0; i < 8; ++i) {
+				workers.emplace_back([&] {
+					auto const file_system = driver::make_caching_file_system(cache, real);
+					for (auto j = 0; j < 100; ++j) {
+						if (not file_system->status("/project/a.cc")
+						    or not file_system->openFileForRead("/project/include/header.hpp"))
+						{
+							++failures;
+						}
+					}
+				});
+			}
+		}
+
+		CHECK(failures == 0);
+		CHECK(cache.size() == 2);
+		CHECK(real->stats <= 8);
+		CHECK(real->opens <= 8);
+	}
+} // namespace
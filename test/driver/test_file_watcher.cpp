@@ -0,0 +1,59 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/file_watcher.hpp>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+	void write_file(std::string const& path, std::string_view const contents)
+	{
+		auto error = std::error_code();
+		auto os = llvm::raw_fd_ostream(path, error);
+		REQUIRE(not error);
+		os << contents;
+	}
+
+	TEST_CASE("a burst of changes is reported as one batch")
+	{
+		auto directory = llvm::SmallString<256>();
+		REQUIRE(not llvm::sys::fs::createUniqueDirectory("test-file-watcher", directory));
+		auto const root = std::string(directory.str());
+
+		auto watcher = driver::file_watcher::create();
+		REQUIRE(watcher.has_value());
+		REQUIRE(watcher->watch(root).has_value());
+		REQUIRE(watcher->watch(root).has_value());
+		CHECK(watcher->directories() == 1);
+
+		write_file(root + "/ship.hpp", "struct ship;");
+		write_file(root + "/ship.hpp", "struct ship {};");
+		write_file(root + "/crew.hpp", "struct crew;");
+
+		auto const changed = watcher->wait(std::chrono::milliseconds(50));
+		REQUIRE(changed.has_value());
+		CHECK(*changed == std::vector<std::string>{root + "/crew.hpp", root + "/ship.hpp"});
+
+		REQUIRE(not llvm::sys::fs::remove(root + "/crew.hpp"));
+		auto const removed = watcher->wait(std::chrono::milliseconds(50));
+		REQUIRE(removed.has_value());
+		CHECK(*removed == std::vector<std::string>{root + "/crew.hpp"});
+
+		llvm::sys::fs::remove_directories(root);
+	}
+
+	TEST_CASE("directories that don't exist can't be watched")
+	{
+		auto watcher = driver::file_watcher::create();
+		REQUIRE(watcher.has_value());
+		CHECK(not watcher->watch("/schreiber/test/file-watcher/missing").has_value());
+		CHECK(watcher->directories() == 0);
+	}
+} // namespace
@@ -0,0 +1,95 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <schreiber/include_graph.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	[[nodiscard]] auto make_graph() -> driver::include_graph
+	{
+		auto graph = driver::include_graph();
+		graph.add(std::vector<std::string>{"/src/a.cpp", "/src/include/a.hpp", "/usr/include/vector"});
+		graph.add(std::vector<std::string>{"/src/b.cpp", "/src/include/b.hpp"});
+		graph.add(std::vector<std::string>{
+		  "/src/all.cpp",
+		  "/src/include/a.hpp",
+		  "/src/include/b.hpp",
+		  "/src/include/c.hpp",
+		});
+		graph.add(std::vector<std::string>{"/src/c.cpp", "/src/include/c.hpp"});
+		return graph;
+	}
+
+	TEST_CASE("translation units are found through the files that they reach")
+	{
+		auto const graph = make_graph();
+		REQUIRE(graph.translation_units() == 4);
+
+		auto const including = graph.including("/src/include/a.hpp");
+		CHECK(
+		  std::vector<std::size_t>(including.begin(), including.end())
+		  == std::vector<std::size_t>{0, 2});
+		CHECK(graph.including("/src/include/d.hpp").empty());
+
+		auto const changed = std::vector<std::string_view>{"/src/include/b.hpp", "/src/c.cpp"};
+		CHECK(graph.including_any(changed) == std::vector<std::size_t>{1, 2, 3});
+	}
+
+	TEST_CASE("only files under a directory are listed")
+	{
+		CHECK(
+		  make_graph().files_under("/src/include")
+		  == std::vector<std::string_view>{
+		    "/src/include/a.hpp",
+		    "/src/include/b.hpp",
+		    "/src/include/c.hpp",
+		  });
+	}
+
+	TEST_CASE("the cover prefers translation units that reach many headers cheaply")
+	{
+		auto const graph = make_graph();
+		auto const headers = graph.files_under("/src/include");
+		CHECK(graph.cover(headers, std::vector<double>{10, 10, 15, 10}) == std::vector<std::size_t>{2});
+
+		// When the translation unit that reaches everything is expensive, the cheaper ones win.
+		CHECK(
+		  graph.cover(headers, std::vector<double>{10, 10, 100, 10})
+		  == std::vector<std::size_t>{0, 1, 3});
+	}
+
+	TEST_CASE("a translation unit's files can be replaced")
+	{
+		auto graph = make_graph();
+		graph.replace(0, std::vector<std::string>{"/src/a.cpp", "/src/include/d.hpp"});
+		CHECK(graph.translation_units() == 4);
+
+		auto const including = graph.including("/src/include/a.hpp");
+		CHECK(
+		  std::vector<std::size_t>(including.begin(), including.end())
+		  == std::vector<std::size_t>{2});
+		CHECK(graph.including("/src/include/d.hpp").size() == 1);
+		CHECK(graph.files(0) == std::vector<std::string_view>{"/src/a.cpp", "/src/include/d.hpp"});
+
+		// Nothing reaches vector any more, so it isn't listed.
+		CHECK(graph.files_under("/usr").empty());
+
+		graph.replace(3, std::vector<std::string>{"/src/c.cpp", "/src/include/a.hpp"});
+		auto const reaching = graph.including("/src/include/a.hpp");
+		CHECK(
+		  std::vector<std::size_t>(reaching.begin(), reaching.end())
+		  == std::vector<std::size_t>{2, 3});
+	}
+
+	TEST_CASE("files that no translation unit reaches don't need covering")
+	{
+		auto const graph = make_graph();
+		auto const files = std::vector<std::string_view>{"/src/include/c.hpp", "/src/include/d.hpp"};
+		CHECK(graph.cover(files, std::vector<double>{1, 1, 5, 1}) == std::vector<std::size_t>{3});
+		CHECK(graph.cover({}, std::vector<double>{1, 1, 5, 1}).empty());
+	}
+} // namespace
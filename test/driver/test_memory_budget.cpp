@@ -0,0 +1,71 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
+#include <schreiber/memory_budget.hpp>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+	constexpr auto mib = std::size_t{1024 * 1024};
+
+	TEST_CASE("the resident set size can be read")
+	{
+		auto const self = driver::resident_set_size();
+		REQUIRE(self.has_value());
+		CHECK(*self > 0);
+		CHECK(driver::resident_set_size(::getpid()).has_value());
+	}
+
+	TEST_CASE("translation units are admitted while they fit in the budget")
+	{
+		auto budget = driver::memory_budget(1024 * mib);
+		CHECK(budget.admits(1000 * mib, 3));
+
+		budget.record(100 * mib);
+		CHECK(budget.admits(800 * mib, 3));
+		CHECK(not budget.admits(900 * mib, 3));
+	}
+
+	TEST_CASE("a translation unit is always admitted when none are in flight")
+	{
+		auto budget = driver::memory_budget(mib);
+		budget.record(100 * mib);
+		CHECK(budget.admits(2000 * mib, 0));
+		CHECK(not budget.admits(2000 * mib, 1));
+	}
+
+	TEST_CASE("a budget of zero is unlimited")
+	{
+		auto budget = driver::memory_budget(0);
+		budget.record(100 * mib);
+		CHECK(budget.admits(2000 * mib, 100));
+	}
+
+	TEST_CASE("acquiring waits for memory to be released")
+	{
+		// Nothing fits alongside the test process itself, so only one translation unit can be in
+		// flight at a time.
+		auto budget = driver::memory_budget(1);
+		budget.acquire();
+
+		auto acquired = std::atomic<bool>(false);
+		auto waiter = std::jthread([&budget, &acquired] {
+			budget.acquire();
+			acquired = true;
+		});
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		CHECK(not acquired);
+
+		budget.release(mib);
+		waiter.join();
+		CHECK(acquired);
+
+		budget.release(mib);
+		CHECK(budget.limit() == 1);
+	}
+} // namespace
@@ -0,0 +1,113 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+
+namespace {
+	using category = driver::memory_stats::category;
+	using info::detached_entity;
+
+	TEST_CASE("detached entities are counted with their arrays")
+	{
+		auto interner = info::string_interner();
+		auto unit = info::detached_translation_unit("input.cc", interner);
+		unit.insert(detached_entity{.usr = unit.intern("c:@F@f#")});
+		unit.insert(detached_entity{
+		  .usr = unit.intern("c:@F@g#I#"),
+		  .parameters = {{.name = unit.intern("x")}},
+		});
+
+		auto stats = driver::memory_stats();
+		stats.record(unit);
+
+		auto const& usage = stats[category::detached_entities];
+		CHECK(usage.count == 2);
+		CHECK(usage.bytes >= 2 * sizeof(detached_entity) + sizeof(info::detached_parameter));
+		CHECK(usage.peak == usage.bytes);
+		CHECK(stats[category::function_info] == driver::memory_stats::usage());
+	}
+
+	TEST_CASE("runs add up their translation units' usage")
+	{
+		auto first = driver::memory_stats();
+		first.set(category::ast, {.bytes = 100, .peak = 100});
+		first.set(category::function_info, {.count = 4, .bytes = 40, .peak = 20});
+		first.record_diagnostics(16);
+
+		auto second = driver::memory_stats();
+		second.set(category::ast, {.bytes = 300, .peak = 300});
+		second.set(category::function_info, {.count = 1, .bytes = 10, .peak = 10});
+
+		auto total = driver::memory_stats();
+		total += first;
+		total += second;
+
+		// Translation units are destroyed once they've been detached, so the peaks don't add up.
+		CHECK(total[category::ast] == driver::memory_stats::usage{.bytes = 400, .peak = 300});
+		CHECK(
+		  total[category::function_info]
+		  == driver::memory_stats::usage{.count = 5, .bytes = 50, .peak = 20});
+		CHECK(total[category::diagnostics] == driver::memory_stats::usage{.bytes = 16, .peak = 16});
+	}
+
+	TEST_CASE("interned strings are counted once for the whole interner")
+	{
+		auto interner = info::string_interner();
+		(void)interner.intern("std::vector");
+		(void)interner.intern("std::string");
+		(void)interner.intern("std::vector");
+
+		auto stats = driver::memory_stats();
+		stats.record(interner);
+		stats.record(interner);
+
+		auto const& usage = stats[category::interned_strings];
+		CHECK(usage.count == 2);
+		CHECK(usage.bytes == interner.allocated_bytes());
+		CHECK(usage.peak == usage.bytes);
+	}
+
+	TEST_CASE("cached files are counted once for the whole cache")
+	{
+		auto memory = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+		memory->addFile("/project/header.hpp", 0, llvm::MemoryBuffer::getMemBuffer("int x;"));
+		auto cache = driver::file_cache();
+		REQUIRE(cache.contents("/project/header.hpp", *memory));
+
+		auto stats = driver::memory_stats();
+		stats.record(cache);
+		stats.record(cache);
+
+		CHECK(
+		  stats[category::cached_files]
+		  == driver::memory_stats::usage{.count = 1, .bytes = 6, .peak = 6});
+	}
+
+	TEST_CASE("reports only list the categories that were used")
+	{
+		auto stats = driver::memory_stats();
+		stats.set(category::throws_info, {.count = 2, .bytes = 96, .peak = 48});
+
+		auto text = std::string();
+		{
+			auto os = llvm::raw_string_ostream(text);
+			driver::write_stats(os, "'input.cc'", stats);
+		}
+
+		CHECK(text.starts_with("'input.cc':\n"));
+		CHECK(text.find("category") != std::string::npos);
+		CHECK(text.find("throws_info") != std::string::npos);
+		CHECK(text.find("96") != std::string::npos);
+		CHECK(text.find("function_info") == std::string::npos);
+		CHECK(text.find("ast") == std::string::npos);
+	}
+} // namespace
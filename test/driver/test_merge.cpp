@@ -0,0 +1,175 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <schreiber/merge.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+	[[nodiscard]] auto entity(std::string_view const usr, std::string_view const description)
+	  -> std::string
+	{
+		return R"({"usr":")" + std::string(usr) + R"(","qualified_name":"ns::)" + std::string(usr)
+		     + R"(","documentation":{"description":")" + std::string(description)
+		     + R"(","location":{"file":"a.hpp","line":)" + std::to_string(description.size()) + "}}}";
+	}
+
+	/// Writes each input to a temporary file that's removed at the end of the test.
+	class inputs {
+	public:
+		explicit inputs(std::vector<std::vector<std::string>> const& files)
+		{
+			for (auto const& lines : files) {
+				auto path = llvm::SmallString<256>();
+				auto fd = 0;
+				REQUIRE(not llvm::sys::fs::createTemporaryFile("test-merge", "json", fd, path));
+
+				auto os = llvm::raw_fd_ostream(fd, /*shouldClose=*/true);
+				for (auto const& line : lines) {
+					os << line << '\n';
+				}
+
+				paths_.push_back(path.str().str());
+			}
+		}
+
+		inputs(inputs const&) = delete;
+		auto operator=(inputs const&) -> inputs& = delete;
+
+		~inputs()
+		{
+			for (auto const& path : paths_) {
+				llvm::sys::fs::remove(path);
+			}
+		}
+
+		[[nodiscard]] auto paths() const noexcept -> std::vector<std::string> const&
+		{
+			return paths_;
+		}
+	private:
+		std::vector<std::string> paths_;
+	};
+
+	[[nodiscard]] auto merge(inputs const& files, driver::merge_options const& options = {})
+	  -> std::pair<std::string, driver::merge_result>
+	{
+		auto text = std::string();
+		auto os = llvm::raw_string_ostream(text);
+		auto result = driver::merge_entities(files.paths(), os, options);
+		REQUIRE(result.has_value());
+		return {text, *std::move(result)};
+	}
+
+	TEST_CASE("the USR is read from the start of an entity")
+	{
+		CHECK(driver::entity_usr(entity("c:@F@f#", "")) == "c:@F@f#");
+		CHECK(driver::entity_usr(R"({"usr":"c:@S@\"quoted\"","kind":"class"})") == R"(c:@S@"quoted")");
+		CHECK(driver::entity_usr(R"({"kind":"class","usr":"c:@S@s"})") == "c:@S@s");
+		CHECK(driver::entity_usr(R"({"usr":"c:@F@f)") == std::nullopt);
+		CHECK(driver::entity_usr(R"({"kind":"class"})") == std::nullopt);
+		CHECK(driver::entity_usr("not json") == std::nullopt);
+	}
+
+	TEST_CASE("entities from different translation units are merged in USR order")
+	{
+		auto const files = inputs({
+		  {entity("a", ""), entity("c", "C.")},
+		  {entity("b", "B."), entity("c", "C.")},
+		  {},
+		});
+		auto const [text, result] = merge(files);
+		CHECK(text == entity("a", "") + '\n' + entity("b", "B.") + '\n' + entity("c", "C.") + '\n');
+		CHECK(result.entities == 3);
+		CHECK(result.duplicates == 1);
+		CHECK(result.conflicts == 0);
+		CHECK(result.diagnostics.empty());
+	}
+
+	TEST_CASE("entities without a USR are never merged")
+	{
+		auto const files = inputs({{entity("", "One.")}, {entity("", "One."), entity("a", "")}});
+		auto const [text, result] = merge(files);
+		CHECK(
+		  text == entity("", "One.") + '\n' + entity("", "One.") + '\n' + entity("a", "") + '\n');
+		CHECK(result.duplicates == 0);
+	}
+
+	TEST_CASE("the most documented redeclaration is kept")
+	{
+		auto const files = inputs({
+		  {entity("f", "")},
+		  {entity("f", "Declared.")},
+		  {entity("f", "Defined.")},
+		});
+		auto const [text, result] = merge(files);
+		CHECK(text == entity("f", "Declared.") + '\n');
+		CHECK(result.duplicates == 2);
+		CHECK(result.conflicts == 1);
+		CHECK(
+		  result.diagnostics
+		  == "warning: 'ns::f' is documented differently at a.hpp:9 and a.hpp:8; keeping the one at "
+		     "a.hpp:9\n");
+	}
+
+	TEST_CASE("sharding and batching don't change the output")
+	{
+		auto files = std::vector<std::vector<std::string>>(7);
+		for (auto i = 0; i < 200; ++i) {
+			auto const usr = "c:@F@f" + std::to_string(1000 + i);
+			files[static_cast<std::size_t>(i % 7)].push_back(entity(usr, "Text."));
+			files[static_cast<std::size_t>(i % 3)].push_back(entity(usr, i % 5 == 0 ? "Other." : ""));
+		}
+
+		for (auto& lines : files) {
+			std::ranges::sort(lines);
+		}
+
+		auto const written = inputs(files);
+		auto const [expected, expected_result] = merge(written);
+		CHECK(expected_result.entities == 200);
+		CHECK(expected_result.conflicts == 40);
+
+		auto const [sharded, sharded_result] = merge(written, {.shards = 4, .fan_in = 3});
+		CHECK(sharded == expected);
+		CHECK(sharded_result.entities == expected_result.entities);
+		CHECK(sharded_result.duplicates == expected_result.duplicates);
+		CHECK(sharded_result.conflicts == expected_result.conflicts);
+	}
+
+	TEST_CASE("conflicts are only reported once when inputs are merged in batches")
+	{
+		auto const files = inputs({
+		  {entity("f", "One.")},
+		  {entity("f", "Two..")},
+		  {entity("f", "Three...")},
+		});
+		auto const [text, result] = merge(files, {.fan_in = 2});
+		CHECK(text == entity("f", "One.") + '\n');
+		CHECK(result.duplicates == 2);
+		CHECK(result.conflicts == 1);
+		CHECK(std::ranges::count(result.diagnostics, '\n') == 1);
+	}
+
+	TEST_CASE("unsorted and unreadable inputs are errors")
+	{
+		auto const unsorted = inputs({{entity("b", ""), entity("a", "")}});
+		auto text = std::string();
+		auto os = llvm::raw_string_ostream(text);
+		auto const result = driver::merge_entities(unsorted.paths(), os, {.shards = 2});
+		REQUIRE(not result.has_value());
+		CHECK(result.error().find("isn't sorted by USR at line 2") != std::string::npos);
+
+		auto const missing = std::vector<std::string>{"/nonexistent/input.json"};
+		CHECK(not driver::merge_entities(missing, os).has_value());
+	}
+} // namespace
@@ -0,0 +1,75 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <schreiber/prebuilt.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+	using clang::tooling::CommandLineArguments;
+
+	TEST_CASE("missing AST files are stale")
+	{
+		CHECK(driver::is_stale("/schreiber/does-not-exist.pch"));
+	}
+
+	TEST_CASE("stale AST files are removed from the command line")
+	{
+		auto prebuilt = driver::prebuilt_files();
+		auto diagnostics = std::string();
+		auto const arguments = CommandLineArguments{
+		  "clang++",
+		  "-Xclang",
+		  "-include-pch",
+		  "-Xclang",
+		  "missing.pch",
+		  "-fmodule-file=m=missing.pcm",
+		  "-fprebuilt-module-path=modules",
+		  "-include-pch",
+		  "missing.pch",
+		  "-fsyntax-only",
+		  "a.cpp",
+		};
+
+		CHECK(
+		  prebuilt.adjust(arguments, "/schreiber", diagnostics)
+		  == CommandLineArguments{
+		    "clang++",
+		    "-fprebuilt-module-path=modules",
+		    "-fsyntax-only",
+		    "a.cpp",
+		  });
+		CHECK(diagnostics.find("'/schreiber/missing.pch' is out of date") != std::string::npos);
+		CHECK(diagnostics.find("'/schreiber/missing.pcm' is out of date") != std::string::npos);
+	}
+
+	TEST_CASE("stale module interfaces are kept if the module can't be found elsewhere")
+	{
+		auto prebuilt = driver::prebuilt_files();
+		auto diagnostics = std::string();
+		auto const arguments = CommandLineArguments{"clang++", "-fmodule-file=missing.pcm", "a.cpp"};
+		CHECK(prebuilt.adjust(arguments, "/schreiber", diagnostics) == arguments);
+		CHECK(diagnostics.starts_with("error: '/schreiber/missing.pcm' is out of date"));
+	}
+
+	TEST_CASE("commands without AST files are unchanged")
+	{
+		auto prebuilt = driver::prebuilt_files();
+		auto diagnostics = std::string();
+		auto const arguments = CommandLineArguments{"clang++", "-include", "a.hpp", "a.cpp"};
+		CHECK(prebuilt.adjust(arguments, "/schreiber", diagnostics) == arguments);
+		CHECK(diagnostics.empty());
+	}
+
+	TEST_CASE("files are claimed once a translation unit has extracted them")
+	{
+		auto prebuilt = driver::prebuilt_files();
+		CHECK(not prebuilt.is_claimed("/schreiber/a.hpp"));
+
+		prebuilt.claim(std::vector<std::string>{"/schreiber/a.hpp"});
+		CHECK(prebuilt.is_claimed("/schreiber/a.hpp"));
+		CHECK(not prebuilt.is_claimed("/schreiber/b.hpp"));
+	}
+} // namespace
@@ -0,0 +1,224 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <fstream>
+#include <iterator>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/render_rst.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+	using info::detached_entity;
+
+	[[nodiscard]] auto read_file(llvm::SmallString<256> const& directory, char const* const name)
+	  -> std::string
+	{
+		auto path = directory;
+		llvm::sys::path::append(path, name);
+		auto file = std::ifstream(path.str().str());
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	[[nodiscard]] auto square(info::string_interner& interner) -> detached_entity
+	{
+		return detached_entity{
+		  .usr = "c:@N@math@F@square#d#",
+		  .name = "square",
+		  .qualified_name = "math::square",
+		  .type = "double (double) noexcept",
+		  .documentation = {.description = "Returns ``x * x``.\nNever negative."},
+		  .headers = {interner.intern("<math.hpp>")},
+		  .parameters = {{.name = "x", .description = "The value to square."}},
+		  .returns = info::detached_text{.description = "``x * x``"},
+		  .preconditions = {{.description = "``x`` isn't NaN."}},
+		  .content_hash = 1,
+		};
+	}
+
+	TEST_CASE("an entity is rendered as a Sphinx function directive")
+	{
+		auto interner = info::string_interner();
+		auto text = std::string();
+		driver::render_entity(text, square(interner));
+		CHECK(
+		  text
+		  == ".. cpp:function:: double math::square(double) noexcept\n"
+		     "\n"
+		     "   Returns ``x * x``.\n"
+		     "   Never negative.\n"
+		     "\n"
+		     "   :param x: The value to square.\n"
+		     "   :returns: ``x * x``\n"
+		     "   :Preconditions:\n"
+		     "      - ``x`` isn't NaN.\n"
+		     "   :Headers: ``<math.hpp>``\n"
+		     "\n");
+
+		text.clear();
+		driver::render_entity(text, detached_entity{.qualified_name = "f", .type = "void ()"});
+		CHECK(text == ".. cpp:function:: void f()\n\n");
+
+		text.clear();
+		driver::render_entity(
+		  text,
+		  detached_entity{
+		    .qualified_name = "at",
+		    .type = "int (int)",
+		    .throws = {{.type = "std::out_of_range", .description = "If ``i`` is too large."}},
+		  });
+		CHECK(
+		  text
+		  == ".. cpp:function:: int at(int)\n"
+		     "\n"
+		     "   :throws std::out_of_range: If ``i`` is too large.\n"
+		     "\n");
+	}
+
+	TEST_CASE("records are rendered as Sphinx class directives")
+	{
+		auto text = std::string();
+		driver::render_entity(
+		  text,
+		  detached_entity{
+		    .kind = detached_entity::entity_kind::record,
+		    .qualified_name = "fleet::ship",
+		    .type = "struct",
+		    .documentation = {.description = "A ship."},
+		  });
+		CHECK(text == ".. cpp:struct:: fleet::ship\n\n   A ship.\n\n");
+
+		text.clear();
+		driver::render_entity(
+		  text,
+		  detached_entity{
+		    .kind = detached_entity::entity_kind::class_template,
+		    .qualified_name = "fleet::galleon",
+		    .type = "class",
+		    .documentation = {.description = "A ship that carries ``Cargo``."},
+		    .template_parameters = {
+		      {.name = "Cargo", .type = "class"},
+		      {.name = "Masts", .type = "int"},
+		      {.type = "typename..."},
+		    },
+		  });
+		CHECK(
+		  text
+		  == ".. cpp:class:: template<class Cargo, int Masts, typename...> fleet::galleon\n"
+		     "\n"
+		     "   A ship that carries ``Cargo``.\n"
+		     "\n");
+	}
+
+	TEST_CASE("inherited documentation is rendered from the base member")
+	{
+		auto directory = llvm::SmallString<256>();
+		REQUIRE(not llvm::sys::fs::createUniqueDirectory("test-render-rst", directory));
+
+		auto entities = std::vector<detached_entity>{
+		  detached_entity{
+		    .usr = "c:@S@ship@F@sail#I#",
+		    .qualified_name = "ship::sail",
+		    .type = "void (int)",
+		    .documentation = {.description = "Sails to ``port``."},
+		    .parameters = {{.name = "port", .description = "Where to go."}},
+		    .content_hash = 1,
+		  },
+		  detached_entity{
+		    .usr = "c:@S@brig@F@sail#I#",
+		    .qualified_name = "brig::sail",
+		    .type = "void (int)",
+		    .inherits_from = "c:@S@ship@F@sail#I#",
+		  },
+		};
+		auto const pointers = std::vector<detached_entity const*>{&entities[0], &entities[1]};
+
+		auto result = driver::render_pages(pointers, directory.str());
+		REQUIRE(result.has_value());
+		auto const page = read_file(directory, "brig.rst");
+		CHECK(
+		  page.find(".. cpp:function:: void brig::sail(int)\n"
+		            "\n"
+		            "   Sails to ``port``.\n"
+		            "\n"
+		            "   :param port: Where to go.\n")
+		  != std::string::npos);
+
+		// The page changes along with the documentation that it inherits.
+		entities[0].content_hash = 2;
+		result = driver::render_pages(pointers, directory.str());
+		REQUIRE(result.has_value());
+		CHECK(result->pages_written == 2);
+
+		llvm::sys::fs::remove_directories(directory);
+	}
+
+	TEST_CASE("pages are only rewritten when their entities change")
+	{
+		auto directory = llvm::SmallString<256>();
+		REQUIRE(not llvm::sys::fs::createUniqueDirectory("test-render-rst", directory));
+
+		auto interner = info::string_interner();
+		auto entities = std::vector<detached_entity>{
+		  square(interner),
+		  detached_entity{.usr = "c:@F@main#", .qualified_name = "main", .type = "int ()"},
+		  detached_entity{.usr = "c:@N@math@F@cube#", .qualified_name = "math::cube", .type = "int ()"},
+		};
+		auto pointers = std::vector<detached_entity const*>();
+		for (auto const& entity : entities) {
+			pointers.push_back(&entity);
+		}
+
+		auto path = directory;
+		llvm::sys::path::append(path, "conf.rst");
+		{
+			auto conf = std::ofstream(path.str().str());
+			conf << "Written by hand.\n";
+		}
+
+		auto const options = driver::render_options{.jobs = 4};
+		auto result = driver::render_pages(pointers, directory.str(), options);
+		REQUIRE(result.has_value());
+		CHECK(result->pages_written == 3);
+		CHECK(result->pages_unchanged == 0);
+		CHECK(result->pages_removed == 0);
+
+		auto const math = read_file(directory, "math.rst");
+		CHECK(math.find("``math``\n========\n") != std::string::npos);
+		CHECK(math.find("math::cube") < math.find("math::square"));
+		CHECK(read_file(directory, "global.rst").find("Global namespace\n") != std::string::npos);
+		CHECK(read_file(directory, "index.rst").find("   global\n   math\n") != std::string::npos);
+
+		result = driver::render_pages(pointers, directory.str(), options);
+		REQUIRE(result.has_value());
+		CHECK(result->pages_written == 0);
+		CHECK(result->pages_unchanged == 3);
+
+		entities[0].content_hash = 2;
+		result = driver::render_pages(pointers, directory.str(), options);
+		REQUIRE(result.has_value());
+		CHECK(result->pages_written == 1);
+		CHECK(result->pages_unchanged == 2);
+
+		result = driver::render_pages(
+		  pointers,
+		  directory.str(),
+		  {.grouping = driver::page_grouping::by_header});
+		REQUIRE(result.has_value());
+		CHECK(read_file(directory, "math-hpp.rst").find("math::square") != std::string::npos);
+		CHECK(read_file(directory, "other.rst").find("math::cube") != std::string::npos);
+
+		// The namespace pages aren't rendered any more, but files that weren't rendered are kept.
+		CHECK(result->pages_removed == 2);
+		CHECK(not llvm::sys::fs::exists(directory.str().str() + "/math.rst"));
+		CHECK(not llvm::sys::fs::exists(directory.str().str() + "/global.rst"));
+		CHECK(read_file(directory, "conf.rst") == "Written by hand.\n");
+
+		llvm::sys::fs::remove_directories(directory);
+	}
+} // namespace
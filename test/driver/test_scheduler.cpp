@@ -0,0 +1,86 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <optional>
+#include <schreiber/scheduler.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	using std::chrono::milliseconds;
+
+	TEST_CASE("jobs are ordered from most to least expensive")
+	{
+		auto const costs = std::vector<double>{1, 10, 5, 7, 5};
+		CHECK(driver::longest_first(costs) == std::vector<std::size_t>{1, 3, 2, 4, 0});
+	}
+
+	TEST_CASE("idle workers steal the most expensive job left")
+	{
+		auto const costs = std::vector<double>{1, 10, 5, 7, 3};
+		auto queue = driver::work_queue(costs, 2);
+
+		// Worker 0 is dealt jobs 1, 2 and 0, and worker 1 is dealt jobs 3 and 4.
+		CHECK(queue.pop(0) == 1);
+		CHECK(queue.pop(1) == 3);
+		CHECK(queue.pop(1) == 4);
+		CHECK(queue.pop(1) == 2);
+		CHECK(queue.pop(0) == 0);
+		CHECK(queue.pop(0) == std::nullopt);
+		CHECK(queue.pop(1) == std::nullopt);
+	}
+
+	TEST_CASE("every job is handed out exactly once")
+	{
+		auto const costs = std::vector<double>(1000, 1.0);
+		auto queue = driver::work_queue(costs, 8);
+		auto seen = std::vector<std::atomic<int>>(costs.size());
+		{
+			auto workers = std::vector<std::jthread>();
+			for (auto i = std::size_t{0}; i < 8; ++i) {
+				workers.emplace_back([&, i] {
+					while (auto const job = queue.pop(i)) {
+						++seen[*job];
+					}
+				});
+			}
+		}
+
+		for (auto const& count : seen) {
+			CHECK(count == 1);
+		}
+	}
+
+	TEST_CASE("timing histories survive a round trip")
+	{
+		auto path = llvm::SmallString<128>();
+		REQUIRE(not llvm::sys::fs::createTemporaryFile("schreiber", "history", path));
+		auto const file = path.str().str();
+
+		auto history = driver::timing_history();
+		history.record("/project/a.cc", milliseconds(100));
+		history.record("/project/a.cc", milliseconds(300));
+		history.record("/project/b c.cc", milliseconds(5));
+		CHECK(history.find("/project/a.cc") == milliseconds(200));
+		CHECK(history.find("/project/c.cc") == std::nullopt);
+		REQUIRE(history.save(file));
+
+		auto const loaded = driver::timing_history::load(file);
+		REQUIRE(loaded);
+		CHECK(loaded->size() == 2);
+		CHECK(loaded->find("/project/a.cc") == milliseconds(200));
+		CHECK(loaded->find("/project/b c.cc") == milliseconds(5));
+
+		llvm::sys::fs::remove(file);
+		auto const missing = driver::timing_history::load(file);
+		REQUIRE(missing);
+		CHECK(missing->size() == 0);
+	}
+} // namespace
@@ -0,0 +1,241 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/import_index.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <schreiber/serialise.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+	using info::detached_entity;
+	using status_t = driver::translation_unit_result::status_t;
+
+	[[nodiscard]] auto make_result(std::string const& file) -> driver::translation_unit_result
+	{
+		return driver::translation_unit_result{
+		  .file = file,
+		  .status = status_t::failed,
+		  .diagnostics = "input.cc:1:1: warning: \"quoted\"\n",
+		  .unit = info::detached_translation_unit(file),
+		};
+	}
+
+	TEST_CASE("translation units survive a round trip")
+	{
+		auto original = make_result("input.cc");
+		auto& unit = original.unit;
+		unit.insert(detached_entity{
+		  .kind = detached_entity::entity_kind::function_template,
+		  .usr = unit.intern("c:@N@ranges@FT@>1#Tfind#t0.0#S1_#I#"),
+		  .name = unit.intern("find"),
+		  .qualified_name = unit.intern("ranges::find"),
+		  .type = unit.intern("T (T, T, int)"),
+		  .location = {.file = unit.main_file(), .line = 11, .column = 5},
+		  .documentation = {.description = unit.intern("Finds `value`."), .location = {.line = 3}},
+		  .headers = {unit.interner().intern("<ranges>")},
+		  .parameters = {{.name = unit.intern("value"), .type = unit.intern("int")}},
+		  .returns = info::detached_text{.description = unit.intern("An iterator.")},
+		  .throws = {{
+		    .type = unit.intern("std::out_of_range"),
+		    .type_usr = unit.intern("c:@N@std@S@out_of_range"),
+		    .description = unit.intern("If `value` is out of range."),
+		  }},
+		  .references = {{
+		    .name = unit.intern("ranges::end"),
+		    .usr = unit.intern("c:@N@ranges@F@end#"),
+		  }},
+		  .content_hash = 0xfedc'ba98'7654'3210,
+		});
+
+		using category = driver::memory_stats::category;
+		original.memory.set(category::function_info, {.count = 3, .bytes = 600, .peak = 200});
+		original.memory.set(category::ast, {.bytes = 1 << 20, .peak = 1 << 20});
+
+		auto text = std::string();
+		{
+			auto os = llvm::raw_string_ostream(text);
+			driver::serialise(os, original);
+		}
+		REQUIRE(text.ends_with('\n'));
+		CHECK(text.find('\n') == text.size() - 1);
+
+		auto const result = driver::deserialise_translation_unit(text);
+		REQUIRE(result.has_value());
+		CHECK(result->file == "input.cc");
+		CHECK(result->status == status_t::failed);
+		CHECK(result->diagnostics == original.diagnostics);
+		CHECK(result->memory == original.memory);
+		REQUIRE(result->unit.entities().size() == 1);
+
+		auto const& entity = result->unit.entities()[0];
+		CHECK(entity.kind == detached_entity::entity_kind::function_template);
+		CHECK(entity.usr == "c:@N@ranges@FT@>1#Tfind#t0.0#S1_#I#");
+		CHECK(entity.qualified_name == "ranges::find");
+		CHECK(entity.location.file == "input.cc");
+		CHECK(entity.location.line == 11);
+		CHECK(entity.location.column == 5);
+		CHECK(entity.documentation.description == "Finds `value`.");
+		CHECK(entity.documentation.location.line == 3);
+		REQUIRE(entity.headers.size() == 1);
+		CHECK(entity.headers[0].view() == "<ranges>");
+		CHECK(entity.modules.empty());
+		REQUIRE(entity.parameters.size() == 1);
+		CHECK(entity.parameters[0].name == "value");
+		CHECK(entity.parameters[0].type == "int");
+		REQUIRE(entity.returns.has_value());
+		CHECK(entity.returns->description == "An iterator.");
+		REQUIRE(entity.throws.size() == 1);
+		CHECK(entity.throws[0].type == "std::out_of_range");
+		CHECK(entity.throws[0].type_usr == "c:@N@std@S@out_of_range");
+		CHECK(entity.throws[0].description == "If `value` is out of range.");
+		CHECK(
+		  entity.references
+		  == std::vector<info::detached_reference>{{"ranges::end", "c:@N@ranges@F@end#"}});
+		CHECK(entity.content_hash == 0xfedc'ba98'7654'3210);
+	}
+
+	TEST_CASE("records and inherited documentation survive a round trip")
+	{
+		auto original = make_result("input.cc");
+		auto& unit = original.unit;
+		unit.insert(detached_entity{
+		  .kind = detached_entity::entity_kind::class_template,
+		  .usr = unit.intern("c:@ST>1#T@galleon"),
+		  .type = unit.intern("class"),
+		});
+		unit.insert(detached_entity{
+		  .usr = unit.intern("c:@S@brig@F@sail#I#"),
+		  .inherits_from = unit.intern("c:@S@ship@F@sail#I#"),
+		});
+
+		auto text = std::string();
+		{
+			auto os = llvm::raw_string_ostream(text);
+			driver::serialise(os, original);
+		}
+
+		auto const result = driver::deserialise_translation_unit(text);
+		REQUIRE(result.has_value());
+		auto const entities = result->unit.entities();
+		REQUIRE(entities.size() == 2);
+		CHECK(entities[0].kind == detached_entity::entity_kind::class_template);
+		CHECK(entities[0].type == "class");
+		CHECK(entities[0].inherits_from.empty());
+		CHECK(entities[1].kind == detached_entity::entity_kind::function);
+		CHECK(entities[1].inherits_from == "c:@S@ship@F@sail#I#");
+	}
+
+	TEST_CASE("malformed translation units are rejected")
+	{
+		CHECK(not driver::deserialise_translation_unit("").has_value());
+		CHECK(not driver::deserialise_translation_unit("[]").has_value());
+		CHECK(not driver::deserialise_translation_unit(R"({"status":"ok"})").has_value());
+		CHECK(not driver::deserialise_translation_unit(
+		            R"({"file":"input.cc","entities":[{"kind":"concept"}]})")
+		            .has_value());
+	}
+
+	TEST_CASE("entities are written once, ordered by USR")
+	{
+		auto results = std::vector<driver::translation_unit_result>();
+		for (auto const* file : {"a.cc", "b.cc"}) {
+			auto& result = results.emplace_back(make_result(file));
+			for (auto const* usr : {"c:@F@g#", "c:@F@f#"}) {
+				result.unit.insert(detached_entity{
+				  .usr = result.unit.intern(usr),
+				  .location = {.file = result.unit.main_file()},
+				});
+			}
+		}
+
+		auto text = std::string();
+		{
+			auto os = llvm::raw_string_ostream(text);
+			driver::write_entities(os, results);
+		}
+
+		auto const f = text.find(R"("usr":"c:@F@f#")");
+		auto const g = text.find(R"("usr":"c:@F@g#")");
+		REQUIRE(f != std::string::npos);
+		REQUIRE(g != std::string::npos);
+		CHECK(f < g);
+		CHECK(text.find(R"("usr":"c:@F@f#")", f + 1) == std::string::npos);
+		CHECK(text.find(R"("file":"a.cc")") != std::string::npos);
+		CHECK(text.find(R"("file":"b.cc")") == std::string::npos);
+	}
+
+	TEST_CASE("the manifest maps each USR to its content hash")
+	{
+		auto results = std::vector<driver::translation_unit_result>();
+		auto& result = results.emplace_back(make_result("a.cc"));
+		result.unit.insert(detached_entity{.usr = result.unit.intern("c:@F@g#"), .content_hash = 2});
+		result.unit.insert(detached_entity{.usr = result.unit.intern("c:@F@f#"), .content_hash = 1});
+		result.unit.insert(detached_entity{.content_hash = 3});
+
+		auto text = std::string();
+		{
+			auto os = llvm::raw_string_ostream(text);
+			driver::write_manifest(os, results);
+		}
+
+		CHECK(
+		  text
+		  == R"({"usr":"c:@F@f#","hash":"0000000000000001"})" "\n"
+		     R"({"usr":"c:@F@g#","hash":"0000000000000002"})" "\n");
+
+		auto const manifest = driver::read_manifest(text);
+		REQUIRE(manifest.has_value());
+		CHECK(*manifest == driver::content_manifest{{"c:@F@f#", 1}, {"c:@F@g#", 2}});
+
+		CHECK(not driver::read_manifest(R"({"usr":"c:@F@f#"})").has_value());
+		CHECK(not driver::read_manifest(R"({"usr":"c:@F@f#","hash":"xyz"})").has_value());
+		CHECK(driver::read_manifest("\n").has_value());
+	}
+
+	TEST_CASE("the import index identifies entities by their output line")
+	{
+		auto results = std::vector<driver::translation_unit_result>();
+		auto& result = results.emplace_back(make_result("a.cc"));
+		auto& unit = result.unit;
+		auto const vector = unit.interner().intern("<vector>");
+		auto const memory = unit.interner().intern("<memory>");
+		unit.insert(detached_entity{.usr = unit.intern("c:@F@g#"), .headers = {vector, memory}});
+		unit.insert(detached_entity{
+		  .usr = unit.intern("c:@F@f#"),
+		  .headers = {vector},
+		  .modules = {unit.interner().intern("std")},
+		});
+
+		auto text = std::string();
+		{
+			auto os = llvm::raw_string_ostream(text);
+			driver::write_imports(os, driver::unique_entities(results));
+		}
+
+		CHECK(
+		  text
+		  == R"({"headers":{"<memory>":[1],"<vector>":[0,1]},"modules":{"std":[0]}})"
+		     "\n");
+
+		auto interner = info::string_interner();
+		auto const imports = driver::read_imports(text, interner);
+		REQUIRE(imports.has_value());
+
+		auto expected = info::import_index();
+		expected.add_header(interner.intern("<memory>"), 1);
+		expected.add_header(interner.intern("<vector>"), 0);
+		expected.add_header(interner.intern("<vector>"), 1);
+		expected.add_module(interner.intern("std"), 0);
+		CHECK(*imports == expected);
+
+		CHECK(not driver::read_imports("[]", interner).has_value());
+		CHECK(not driver::read_imports(R"({"headers":{"<vector>":0}})", interner).has_value());
+		CHECK(not driver::read_imports(R"({"modules":{"std":[-1]}})", interner).has_value());
+	}
+} // namespace
@@ -120,7 +120,7 @@ namespace {
 
 			SECTION("throws_info")
 			{
-				auto const throws = info::function_info::throws_info("", {});
+				auto const throws = info::function_info::throws_info("", nullptr, "", {});
 				CHECK_FALSE(info::decl_info::header_info::classof(&throws));
 				CHECK_FALSE(info::decl_info::module_info::classof(&throws));
 				CHECK_FALSE(info::function_info::classof(&throws));
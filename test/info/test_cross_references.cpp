@@ -0,0 +1,67 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <schreiber/cross_references.hpp>
+#include <schreiber/detached_info.hpp>
+#include <string_view>
+#include <vector>
+
+namespace {
+	using info::detached_entity;
+	using info::detached_reference;
+	using info::detached_text;
+
+	TEST_CASE("qualified names and calls are mentions")
+	{
+		CHECK(
+		  info::find_mentions("Copies `std::vector<T>` using ::copy and ranges::copy().")
+		  == std::vector<std::string_view>{"std::vector", "::copy", "ranges::copy"});
+		CHECK(
+		  info::find_mentions("Calls size(), then x.size() and p->size().")
+		  == std::vector<std::string_view>{"size"});
+		CHECK(info::find_mentions("A vector of 3ab() things, as in C++: a list.").empty());
+		CHECK(info::find_mentions("std::").empty());
+		CHECK(info::find_mentions("").empty());
+	}
+
+	TEST_CASE("names resolve from the innermost enclosing namespace out")
+	{
+		auto symbols = info::symbol_table();
+		symbols.add(detached_entity{.usr = "c:@F@f#", .qualified_name = "f"});
+		symbols.add(detached_entity{.usr = "c:@N@a@F@f#", .qualified_name = "a::f"});
+		symbols.add(detached_entity{.usr = "c:@N@a@F@f#I#", .qualified_name = "a::f"});
+		symbols.add(detached_entity{.usr = "c:@N@a@N@b@F@g#", .qualified_name = "a::b::g"});
+		symbols.add(detached_entity{.qualified_name = "a::h"});
+		CHECK(symbols.size() == 3);
+
+		CHECK(symbols.find("a::f") == "c:@N@a@F@f#");
+		CHECK(symbols.find("a::h").empty());
+		CHECK(symbols.resolve("f", "a::b") == "c:@N@a@F@f#");
+		CHECK(symbols.resolve("::f", "a::b") == "c:@F@f#");
+		CHECK(symbols.resolve("f", "") == "c:@F@f#");
+		CHECK(symbols.resolve("b::g", "a") == "c:@N@a@N@b@F@g#");
+		CHECK(symbols.resolve("g", "a").empty());
+		CHECK(symbols.resolve("a::b::g", "c") == "c:@N@a@N@b@F@g#");
+	}
+
+	TEST_CASE("references are collected from every description")
+	{
+		auto symbols = info::symbol_table();
+		symbols.add(detached_entity{.usr = "c:@N@a@F@f#", .qualified_name = "a::f"});
+		symbols.add(detached_entity{.usr = "c:@N@a@F@g#", .qualified_name = "a::g"});
+		symbols.add(detached_entity{.usr = "c:@N@a@F@h#", .qualified_name = "a::h"});
+
+		auto const entity = detached_entity{
+		  .usr = "c:@N@a@F@f#",
+		  .qualified_name = "a::f",
+		  .documentation = {.description = "Like g(), but calls f() and missing()."},
+		  .parameters = {{.name = "x", .description = "Passed to a::h."}},
+		  .preconditions = {detached_text{.description = "g() hasn't been called."}},
+		};
+
+		CHECK(
+		  info::resolve_references(entity, symbols)
+		  == std::vector<detached_reference>{{"g", "c:@N@a@F@g#"}, {"a::h", "c:@N@a@F@h#"}});
+	}
+} // namespace
@@ -0,0 +1,208 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/DeclTemplate.h>
+#include <clang/ASTMatchers/ASTMatchFinder.h>
+#include <clang/ASTMatchers/ASTMatchers.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/Support/Casting.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/diagnostic_ids.hpp>
+#include <schreiber/info.hpp>
+#include <schreiber/parser.hpp>
+#include <string_view>
+
+namespace {
+	namespace tooling = clang::tooling;
+
+	using clang::ast_matchers::classTemplateDecl;
+	using clang::ast_matchers::cxxMethodDecl;
+	using clang::ast_matchers::cxxRecordDecl;
+	using clang::ast_matchers::functionDecl;
+	using clang::ast_matchers::hasName;
+	using clang::ast_matchers::isImplicit;
+	using clang::ast_matchers::match;
+	using clang::ast_matchers::ofClass;
+	using clang::ast_matchers::selectFirst;
+	using clang::ast_matchers::unless;
+	using namespace std::string_view_literals;
+
+	TEST_CASE("detached entities outlive their AST")
+	{
+		auto tu = info::detached_translation_unit("input.cc");
+		{
+			auto ast = tooling::buildASTFromCodeWithArgs(
+			  R"(
+				namespace ranges {
+					/// Finds the first element equal to `value`.
+					/// \param first The beginning of the range.
+					/// \param last The end of the range.
+					/// \param value The value to look for.
+					/// \pre `[first, last)` is a valid range.
+					/// \returns An iterator to the element, or `last` if it isn't found.
+					/// \headers <ranges>
+					/// \modules std
+					int const* find(int const* first, int const* last, int value);
+				} // namespace ranges
+			  )",
+			  {"-target", "x86_64-unknown-linux-gnu", "-std=c++20"});
+			REQUIRE(ast != nullptr);
+
+			auto& context = ast->getASTContext();
+			REQUIRE(diag::add_diagnostics(context.getDiagnostics()));
+			auto const decl = selectFirst<clang::FunctionDecl>(
+			  "decl",
+			  match(functionDecl(hasName("find")).bind("decl"), context));
+			REQUIRE(decl != nullptr);
+
+			auto p = parser::parser(context);
+			auto const info = p.parse(decl);
+			auto const* const f = llvm::dyn_cast<info::function_info>(info.get());
+			REQUIRE(f != nullptr);
+
+			auto const& entity = tu.detach(*f, context.getSourceManager());
+			CHECK(entity.kind == info::detached_entity::entity_kind::function);
+			REQUIRE(tu.entities().size() == 1);
+			CHECK(&tu.entities()[0] == &entity);
+		}
+
+		auto const& entity = tu.entities()[0];
+		CHECK(tu.main_file() == "input.cc");
+		CHECK(not entity.usr.empty());
+		CHECK(entity.name == "find");
+		CHECK(entity.qualified_name == "ranges::find");
+		CHECK(entity.type == "const int *(const int *, const int *, int)");
+		CHECK(entity.location.file == "input.cc");
+		CHECK(entity.location.line == 11);
+		CHECK(entity.documentation.description == "Finds the first element equal to `value`.");
+		CHECK(entity.documentation.location.line == 3);
+
+		REQUIRE(entity.parameters.size() == 3);
+		CHECK(entity.parameters[0].name == "first");
+		CHECK(entity.parameters[0].type == "const int *");
+		CHECK(entity.parameters[0].description == "The beginning of the range.");
+		CHECK(entity.parameters[1].name == "last");
+		CHECK(entity.parameters[2].name == "value");
+		CHECK(entity.parameters[2].type == "int");
+
+		REQUIRE(entity.preconditions.size() == 1);
+		CHECK(entity.preconditions[0].description == "`[first, last)` is a valid range.");
+		REQUIRE(entity.returns.has_value());
+		CHECK(entity.returns->description == "An iterator to the element, or `last` if it isn't found.");
+
+		REQUIRE(entity.headers.size() == 1);
+		CHECK(entity.headers[0].view() == "<ranges>");
+		REQUIRE(entity.modules.size() == 1);
+		CHECK(entity.modules[0].view() == "std");
+
+		CHECK(entity.postconditions.empty());
+		CHECK(entity.throws.empty());
+		CHECK(entity.exits_via.empty());
+		CHECK(entity.template_parameters.empty());
+	}
+
+	TEST_CASE("records and inherited documentation are detached")
+	{
+		auto tu = info::detached_translation_unit("input.cc");
+		auto ast = tooling::buildASTFromCodeWithArgs(
+		  R"(
+			/// A ship.
+			/// \headers <ship.hpp>
+			struct ship {
+				/// Sails to ``port``.
+				virtual void sail(int port);
+			};
+
+			/// A two-masted ship.
+			class brig : public ship {
+			public:
+				void sail(int port) override;
+			};
+
+			/// A ship that carries ``Cargo``.
+			template<class Cargo>
+			class galleon {};
+		  )",
+		  {"-target", "x86_64-unknown-linux-gnu", "-std=c++20"});
+		REQUIRE(ast != nullptr);
+
+		auto& context = ast->getASTContext();
+		REQUIRE(diag::add_diagnostics(context.getDiagnostics()));
+		auto p = parser::parser(context);
+
+		// Detached entities are copied, since the next call to ``detach`` invalidates them.
+		auto const detach = [&](clang::NamedDecl const* const decl) -> info::detached_entity {
+			REQUIRE(decl != nullptr);
+			auto const info = p.parse(decl);
+			auto const* const entity = llvm::dyn_cast_if_present<info::entity_info>(info.get());
+			REQUIRE(entity != nullptr);
+			return tu.detach(*entity, context.getSourceManager());
+		};
+
+		auto const ship = detach(selectFirst<clang::CXXRecordDecl>(
+		  "decl",
+		  match(cxxRecordDecl(hasName("ship"), unless(isImplicit())).bind("decl"), context)));
+		CHECK(ship.kind == info::detached_entity::entity_kind::record);
+		CHECK(ship.type == "struct");
+		CHECK(ship.documentation.description == "A ship.");
+		REQUIRE(ship.headers.size() == 1);
+		CHECK(ship.headers[0].view() == "<ship.hpp>");
+
+		auto const galleon = detach(selectFirst<clang::ClassTemplateDecl>(
+		  "decl",
+		  match(classTemplateDecl(hasName("galleon")).bind("decl"), context)));
+		CHECK(galleon.kind == info::detached_entity::entity_kind::class_template);
+		CHECK(galleon.type == "class");
+		CHECK(galleon.qualified_name == "galleon");
+		REQUIRE(galleon.template_parameters.size() == 1);
+		CHECK(galleon.template_parameters[0].name == "Cargo");
+		CHECK(galleon.template_parameters[0].type == "class");
+		CHECK(galleon.template_parameters[0].description.empty());
+
+		auto const base = detach(selectFirst<clang::CXXMethodDecl>(
+		  "decl",
+		  match(cxxMethodDecl(hasName("sail"), ofClass(hasName("ship"))).bind("decl"), context)));
+		auto const derived = detach(selectFirst<clang::CXXMethodDecl>(
+		  "decl",
+		  match(cxxMethodDecl(hasName("sail"), ofClass(hasName("brig"))).bind("decl"), context)));
+		CHECK(derived.qualified_name == "brig::sail");
+		CHECK(not derived.inherits_from.empty());
+		CHECK(derived.inherits_from == base.usr);
+		CHECK(derived.documentation.description.empty());
+		CHECK(derived.type == "void (int)");
+	}
+
+	TEST_CASE("detached strings are interned")
+	{
+		auto interner = info::string_interner();
+		auto tu = info::detached_translation_unit("input.cc", interner);
+		auto const first = tu.intern("<vector>");
+		auto const second = tu.intern("<vector>"sv);
+		CHECK(first == second);
+		CHECK(first.data() == second.data());
+		CHECK(tu.intern("<ranges>").data() != first.data());
+		CHECK(interner.size() == 3);
+	}
+
+	TEST_CASE("entities from a changed file can be forgotten")
+	{
+		auto interner = info::string_interner();
+		auto tu = info::detached_translation_unit("input.cc", interner);
+		auto const header = tu.intern("ship.hpp");
+		tu.insert(info::detached_entity{.usr = tu.intern("c:@F@sail#"), .location = {.file = header}});
+		tu.insert(
+		  info::detached_entity{.usr = tu.intern("c:@F@main#"), .location = {.file = tu.main_file()}});
+		tu.insert(info::detached_entity{.usr = tu.intern("c:@F@dock#"), .location = {.file = header}});
+
+		auto const in_header = [header](info::detached_entity const& entity) {
+			return entity.location.file == header;
+		};
+		CHECK(tu.erase_if(in_header) == 2);
+		REQUIRE(tu.entities().size() == 1);
+		CHECK(tu.entities()[0].usr == "c:@F@main#");
+	}
+} // namespace
@@ -0,0 +1,36 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/DiagnosticIDs.h>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <schreiber/diagnostic_ids.hpp>
+
+namespace {
+	[[nodiscard]] auto make_engine(clang::DiagnosticConsumer& consumer) -> clang::DiagnosticsEngine
+	{
+		return clang::DiagnosticsEngine(
+		  llvm::makeIntrusiveRefCnt<clang::DiagnosticIDs>(),
+		  llvm::makeIntrusiveRefCnt<clang::DiagnosticOptions>(),
+		  &consumer,
+		  /*ShouldOwnClient=*/false);
+	}
+
+	TEST_CASE("diagnostics are given the IDs that diag::id expects")
+	{
+		auto consumer = clang::IgnoringDiagConsumer();
+		auto engine = make_engine(consumer);
+		CHECK(diag::add_diagnostics(engine));
+		CHECK(diag::add_diagnostics(engine));
+	}
+
+	TEST_CASE("diagnostics can't be added after another custom diagnostic")
+	{
+		auto consumer = clang::IgnoringDiagConsumer();
+		auto engine = make_engine(consumer);
+		(void)engine.getCustomDiagID(clang::DiagnosticsEngine::Warning, "registered first");
+		CHECK(not diag::add_diagnostics(engine));
+	}
+} // namespace
@@ -0,0 +1,178 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/entity_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+	using info::detached_entity;
+
+	[[nodiscard]] auto names(std::vector<detached_entity const*> const& entities)
+	  -> std::vector<std::string_view>
+	{
+		auto result = std::vector<std::string_view>();
+		for (auto const* const entity : entities) {
+			result.push_back(entity->usr);
+		}
+
+		return result;
+	}
+
+	/// Makes entities whose strings belong to a different interner than the index's, as they would
+	/// when they come from a worker process.
+	[[nodiscard]] auto make_entity(
+	  std::string_view const usr,
+	  std::string_view const qualified_name,
+	  std::string_view const file) -> detached_entity
+	{
+		static auto source = info::string_interner();
+		return detached_entity{
+		  .usr = source.intern(usr).view(),
+		  .qualified_name = source.intern(qualified_name).view(),
+		  .location = {.file = source.intern(file).view()},
+		};
+	}
+
+	TEST_CASE("entities can be found by USR, name, namespace, and file")
+	{
+		auto interner = info::string_interner();
+		auto index = info::entity_index(interner);
+		CHECK(index.insert(make_entity("c:@N@a@F@f#I#", "a::f", "a.hpp")) == 0);
+		CHECK(index.insert(make_entity("c:@N@a@F@f#d#", "a::f", "a.hpp")) == 1);
+		CHECK(index.insert(make_entity("c:@N@a@N@b@F@g#", "a::b::g", "b.hpp")) == 2);
+		CHECK(index.insert(make_entity("c:@N@ab@F@h#", "ab::h", "a.hpp")) == 3);
+		CHECK(index.insert(make_entity("c:@F@main#", "main", "main.cpp")) == 4);
+
+		// Headers are seen once per translation unit, but only indexed once.
+		CHECK(index.insert(make_entity("c:@N@a@F@f#I#", "a::f", "a.hpp")) == 0);
+		REQUIRE(index.size() == 5);
+
+		auto const* const f = index.find_usr("c:@N@a@F@f#d#");
+		REQUIRE(f != nullptr);
+		CHECK(f == &index.get(1));
+		CHECK(f->qualified_name == "a::f");
+		CHECK(f->qualified_name.data() == interner.intern("a::f").view().data());
+		CHECK(index.find_usr("c:@F@missing#") == nullptr);
+
+		CHECK(
+		  names(index.find_qualified_name("a::f"))
+		  == std::vector<std::string_view>{"c:@N@a@F@f#I#", "c:@N@a@F@f#d#"});
+		CHECK(index.find_qualified_name("f").empty());
+
+		CHECK(
+		  names(index.find_in_namespace("a"))
+		  == std::vector<std::string_view>{"c:@N@a@N@b@F@g#", "c:@N@a@F@f#I#", "c:@N@a@F@f#d#"});
+		CHECK(
+		  names(index.find_in_namespace("a::b")) == std::vector<std::string_view>{"c:@N@a@N@b@F@g#"});
+		CHECK(index.find_in_namespace("a::b::g").empty());
+		CHECK(index.find_in_namespace("").size() == 5);
+
+		CHECK(
+		  names(index.find_in_file("a.hpp"))
+		  == std::vector<std::string_view>{"c:@N@a@F@f#I#", "c:@N@a@F@f#d#", "c:@N@ab@F@h#"});
+		CHECK(index.find_in_file("c.hpp").empty());
+	}
+
+	TEST_CASE("entities can be found by the header or module that exports them")
+	{
+		static auto source = info::string_interner();
+		auto const make = [](std::string_view const usr, std::string_view const header) {
+			return detached_entity{
+			  .usr = source.intern(usr).view(),
+			  .headers = {source.intern(header)},
+			  .modules = {source.intern("std")},
+			};
+		};
+
+		auto interner = info::string_interner();
+		auto index = info::entity_index(interner);
+		index.insert(make("c:@N@std@F@move#", "<utility>"));
+		index.insert(make("c:@N@std@F@swap#", "<utility>"));
+		index.insert(make("c:@N@std@F@sort#", "<algorithm>"));
+		index.insert(make("c:@N@std@F@move#", "<utility>"));
+
+		CHECK(
+		  names(index.find_in_header("<utility>"))
+		  == std::vector<std::string_view>{"c:@N@std@F@move#", "c:@N@std@F@swap#"});
+		CHECK(
+		  names(index.find_in_header("<algorithm>"))
+		  == std::vector<std::string_view>{"c:@N@std@F@sort#"});
+		auto const interned = interner.size();
+		CHECK(index.find_in_header("<vector>").empty());
+		CHECK(index.find_in_module("std").size() == 3);
+		CHECK(index.find_in_module("core").empty());
+		CHECK(interner.size() == interned);
+	}
+
+	TEST_CASE("inherited documentation is looked up through the base member")
+	{
+		static auto source = info::string_interner();
+		auto interner = info::string_interner();
+		auto index = info::entity_index(interner);
+		index.insert(detached_entity{
+		  .usr = source.intern("c:@S@ship@F@sail#I#").view(),
+		  .documentation = {.description = source.intern("Sails to ``port``.").view()},
+		});
+		index.insert(detached_entity{
+		  .usr = source.intern("c:@S@brig@F@sail#I#").view(),
+		  .inherits_from = source.intern("c:@S@ship@F@sail#I#").view(),
+		});
+		index.insert(detached_entity{
+		  .usr = source.intern("c:@S@sloop@F@sail#I#").view(),
+		  .inherits_from = source.intern("c:@S@raft@F@sail#I#").view(),
+		});
+
+		auto const* const ship = index.find_usr("c:@S@ship@F@sail#I#");
+		auto const* const brig = index.find_usr("c:@S@brig@F@sail#I#");
+		REQUIRE(ship != nullptr);
+		REQUIRE(brig != nullptr);
+		CHECK(brig->inherits_from.data() == ship->usr.data());
+		CHECK(brig->documentation.description.empty());
+		CHECK(index.find_documentation(*brig) == ship);
+		CHECK(index.find_documentation(*ship) == ship);
+
+		auto const* const sloop = index.find_usr("c:@S@sloop@F@sail#I#");
+		REQUIRE(sloop != nullptr);
+		CHECK(index.find_documentation(*sloop) == nullptr);
+	}
+
+	TEST_CASE("the index can be queried while it's being built")
+	{
+		auto interner = info::string_interner();
+		auto index = info::entity_index(interner);
+		auto entities = std::vector<detached_entity>();
+		for (auto i = 0; i < 1000; ++i) {
+			auto const n = std::to_string(i);
+			entities.push_back(make_entity("c:@F@f" + n, "ns::f" + n, "file" + std::to_string(i % 10)));
+		}
+
+		{
+			auto writers = std::vector<std::jthread>();
+			for (auto t = 0; t < 4; ++t) {
+				writers.emplace_back([&] {
+					for (auto const& entity : entities) {
+						index.insert(entity);
+					}
+				});
+			}
+
+			writers.emplace_back([&] {
+				while (index.size() < entities.size()) {
+					for (auto const* const entity : index.find_in_file("file3")) {
+						CHECK(index.find_usr(entity->usr) == entity);
+					}
+				}
+			});
+		}
+
+		CHECK(index.size() == 1000);
+		CHECK(index.find_in_namespace("ns").size() == 1000);
+		CHECK(index.find_in_file("file3").size() == 100);
+	}
+} // namespace
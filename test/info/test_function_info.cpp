@@ -76,7 +76,7 @@ namespace {
 				auto info = info::function_info(decl, "", {});
 				auto const headers = header_info{"header.hpp", {}};
 				auto const modules = module_info{"module.m", {}};
-				auto const throws = throws_info{"yes", {}};
+				auto const throws = throws_info{"int", nullptr, "yes", {}};
 
 				store(info, returns);
 				store(info, headers);
@@ -109,8 +109,8 @@ namespace {
 				  {"goodbye", {}},
 				};
 				auto const throws = std::vector<throws_info>{
-				  {    "but", {}},
-				  {"not for", {}},
+				  {"int", nullptr,     "but", {}},
+				  {"int", nullptr, "not for", {}},
 				};
 				auto const exits_via = std::vector<exits_via_info>{
 				  { "very", {}},
@@ -206,6 +206,40 @@ namespace {
 		}
 	}
 
+	TEST_CASE("content hash")
+	{
+		auto ast = tooling::buildASTFromCodeWithArgs("double square(double x);", compiler_args);
+		REQUIRE(ast != nullptr);
+		auto& context = ast->getASTContext();
+		parser::parser p(context);
+		auto store = [&p](info::function_info& info, auto d) { info.store(p, {}, &d); };
+
+		auto const decl =
+		  selectFirst<clang::FunctionDecl>("decl", match(functionDecl().bind("decl"), context));
+		REQUIRE(decl != nullptr);
+
+		auto const document = [&](std::string_view const returns, clang::SourceLocation location) {
+			auto info = info::function_info(decl, "Returns ``x * x``.", location);
+			store(info, info::parameter_info(location, decl->getParamDecl(0), "The value to square."));
+			store(info, return_info(std::string(returns), location));
+			store(info, header_info("square.hpp", location));
+			return info;
+		};
+
+		auto const original = document("x * x", {});
+		CHECK(original.content_hash() == document("x * x", {}).content_hash());
+		CHECK(original.content_hash() == document("x * x", decl->getLocation()).content_hash());
+		CHECK(original.content_hash() != document("x squared", {}).content_hash());
+		CHECK(original.content_hash() != info::function_info(decl, "", {}).content_hash());
+
+		// The same text documenting a different directive is a different page.
+		auto precondition = info::function_info(decl, "Returns ``x * x``.", {});
+		store(precondition, info::parameter_info({}, decl->getParamDecl(0), "The value to square."));
+		store(precondition, precondition_info("x * x", {}));
+		store(precondition, header_info("square.hpp", {}));
+		CHECK(original.content_hash() != precondition.content_hash());
+	}
+
 	template<class T>
 	[[nodiscard]] auto make_template_param(
 	  clang::TemplateParameterList const* const params,
@@ -0,0 +1,57 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/import_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace {
+	using info::detached_entity;
+	using info::import_index;
+
+	[[nodiscard]] auto ids(std::span<import_index::entity_id const> const span)
+	  -> std::vector<import_index::entity_id>
+	{
+		return {span.begin(), span.end()};
+	}
+
+	[[nodiscard]] auto views(std::vector<info::interned_string> const& names)
+	  -> std::vector<std::string_view>
+	{
+		auto result = std::vector<std::string_view>();
+		for (auto const name : names) {
+			result.push_back(name.view());
+		}
+
+		return result;
+	}
+
+	TEST_CASE("headers and modules map to the entities that they export")
+	{
+		auto interner = info::string_interner();
+		auto const vector = interner.intern("<vector>");
+		auto const memory = interner.intern("<memory>");
+		auto const std_module = interner.intern("std");
+
+		auto index = import_index();
+		index.add(0, detached_entity{.headers = {vector}, .modules = {std_module}});
+		index.add(1, detached_entity{.headers = {memory, vector}, .modules = {std_module}});
+		index.add(2, detached_entity{.headers = {memory}});
+
+		// Repeats of the same entity are only recorded once.
+		index.add(2, detached_entity{.headers = {memory, memory}});
+
+		CHECK(ids(index.header(vector)) == std::vector<import_index::entity_id>{0, 1});
+		CHECK(ids(index.header(memory)) == std::vector<import_index::entity_id>{1, 2});
+		CHECK(ids(index.module(std_module)) == std::vector<import_index::entity_id>{0, 1});
+		CHECK(index.header(interner.intern("<map>")).empty());
+		CHECK(index.module(vector).empty());
+
+		CHECK(views(index.headers()) == std::vector<std::string_view>{"<memory>", "<vector>"});
+		CHECK(views(index.modules()) == std::vector<std::string_view>{"std"});
+	}
+} // namespace
@@ -0,0 +1,156 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <catch2/catch_test_macros.hpp>
+#include <deque>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/search_index.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+	using info::detached_entity;
+	using info::detached_text;
+
+	[[nodiscard]] auto load(info::search_index_builder const& builder) -> info::search_index
+	{
+		// The index refers to the file rather than copying it.
+		static auto files = std::deque<std::string>();
+		auto& text = files.emplace_back();
+		{
+			auto os = llvm::raw_string_ostream(text);
+			builder.write(os);
+		}
+
+		auto index = info::search_index::parse(llvm::MemoryBuffer::getMemBuffer(text, "", false));
+		REQUIRE(index.has_value());
+		return *std::move(index);
+	}
+
+	[[nodiscard]] auto usrs(info::search_index const& index, std::string_view const query)
+	  -> std::vector<std::string_view>
+	{
+		auto result = std::vector<std::string_view>();
+		for (auto const id : index.search(query)) {
+			result.push_back(index.usr(id));
+		}
+
+		return result;
+	}
+
+	TEST_CASE("text is split into lowercase words")
+	{
+		CHECK(
+		  info::search_terms("Returns `std::vector<T>`, or throws bad_alloc.")
+		  == std::vector<std::string>{"returns", "std", "vector", "t", "or", "throws", "bad_alloc"});
+		CHECK(info::search_terms("  ").empty());
+		CHECK(info::search_terms("naïve") == std::vector<std::string>{"naïve"});
+	}
+
+	TEST_CASE("documents can be found with boolean and prefix queries")
+	{
+		auto interner = info::string_interner();
+		auto unit = info::detached_translation_unit("a.cpp", interner);
+		unit.insert(detached_entity{
+		  .usr = unit.intern("c:@F@sort#"),
+		  .documentation = {.description = unit.intern("Sorts a range in place.")},
+		  .preconditions = {detached_text{.description = unit.intern("The range is bounded.")}},
+		});
+		unit.insert(detached_entity{
+		  .usr = unit.intern("c:@F@push#"),
+		  .documentation = {.description = unit.intern("Appends to a std::vector.")},
+		  .throws = {{
+		    .type = unit.intern("std::bad_alloc"),
+		    .description = unit.intern("If allocation fails."),
+		  }},
+		});
+		unit.insert(detached_entity{
+		  .usr = unit.intern("c:@F@view#"),
+		  .documentation = {.description = unit.intern("Views a vector as a span.")},
+		  .returns = detached_text{.description = unit.intern("A range over the vector.")},
+		});
+		unit.insert(detached_entity{.documentation = {.description = unit.intern("No USR.")}});
+
+		auto builder = info::search_index_builder();
+		builder.add(unit);
+		builder.add(unit);
+		CHECK(builder.size() == 3);
+
+		auto const index = load(builder);
+		REQUIRE(index.size() == 3);
+
+		// Documents are numbered in USR order.
+		CHECK(index.usr(0) == "c:@F@push#");
+		CHECK(index.usr(1) == "c:@F@sort#");
+		CHECK(index.usr(2) == "c:@F@view#");
+
+		CHECK(index.find("range") == std::vector<info::search_index::document_id>{1, 2});
+		CHECK(index.find("rang").empty());
+		CHECK(index.find_prefix("rang") == std::vector<info::search_index::document_id>{1, 2});
+		CHECK(index.find_prefix("zzz").empty());
+
+		CHECK(usrs(index, "vector") == std::vector<std::string_view>{"c:@F@push#", "c:@F@view#"});
+		CHECK(usrs(index, "VECTOR span") == std::vector<std::string_view>{"c:@F@view#"});
+		CHECK(usrs(index, "std::vector") == std::vector<std::string_view>{"c:@F@push#"});
+		CHECK(usrs(index, "vector -span") == std::vector<std::string_view>{"c:@F@push#"});
+		CHECK(usrs(index, "-vector") == std::vector<std::string_view>{"c:@F@sort#"});
+		CHECK(
+		  usrs(index, "bounded OR bad_alloc")
+		  == std::vector<std::string_view>{"c:@F@push#", "c:@F@sort#"});
+		CHECK(usrs(index, "sort*") == std::vector<std::string_view>{"c:@F@sort#"});
+		CHECK(usrs(index, "missing").empty());
+		CHECK(usrs(index, "").empty());
+	}
+
+	TEST_CASE("the index can be built from many threads")
+	{
+		auto interner = info::string_interner();
+		auto units = std::vector<info::detached_translation_unit>();
+		for (auto i = 0; i < 8; ++i) {
+			auto& unit = units.emplace_back("tu" + std::to_string(i) + ".cpp", interner);
+			for (auto j = 0; j < 100; ++j) {
+				unit.insert(detached_entity{
+				  .usr = unit.intern("c:@F@f" + std::to_string(j)),
+				  .documentation = {.description = unit.intern("word" + std::to_string(j % 10))},
+				});
+			}
+		}
+
+		auto builder = info::search_index_builder();
+		{
+			auto threads = std::vector<std::jthread>();
+			for (auto const& unit : units) {
+				threads.emplace_back([&] { builder.add(unit); });
+			}
+		}
+
+		auto const index = load(builder);
+		CHECK(index.size() == 100);
+		CHECK(index.find("word3").size() == 10);
+		CHECK(index.find_prefix("word").size() == 100);
+	}
+
+	TEST_CASE("malformed indices are rejected")
+	{
+		auto const parse = [](std::string_view const text) {
+			return info::search_index::parse(llvm::MemoryBuffer::getMemBuffer(text, "", false));
+		};
+
+		CHECK(not parse("").has_value());
+		CHECK(not parse("not an index at all").has_value());
+
+		auto const header = std::string("SCHRSRC1") + std::string(16, '\0');
+		CHECK(parse(header).has_value());
+		CHECK(not parse(header + "x").has_value());
+
+		auto with_document = std::string("SCHRSRC1");
+		with_document += std::string("\1\0\0\0\0\0\0\0\0\0\0\0\1\0\0\0", 16);
+		CHECK(parse(with_document + std::string("\0\0\0\0\1\0\0\0", 8) + "x").has_value());
+		CHECK(not parse(with_document + std::string("\1\0\0\0\1\0\0\0", 8) + "x").has_value());
+	}
+} // namespace
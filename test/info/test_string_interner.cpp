@@ -0,0 +1,90 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_set.h>
+#include <catch2/catch_test_macros.hpp>
+#include <schreiber/info.hpp>
+#include <schreiber/parser.hpp>
+#include <schreiber/string_interner.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	TEST_CASE("interning the same string twice returns the same handle")
+	{
+		auto interner = info::string_interner();
+		auto const vector = interner.intern("<vector>");
+		auto const ranges = interner.intern("<ranges>");
+
+		CHECK(vector.view() == "<vector>");
+		CHECK(ranges.view() == "<ranges>");
+		CHECK(vector != ranges);
+		CHECK(interner.intern(std::string("<vector>")) == vector);
+		CHECK(interner.size() == 2);
+		CHECK(interner.allocated_bytes() > 0);
+
+		auto const set = absl::flat_hash_set<info::interned_string>{vector, ranges, vector};
+		CHECK(set.size() == 2);
+	}
+
+	TEST_CASE("strings can be found without interning them")
+	{
+		auto interner = info::string_interner();
+		auto const vector = interner.intern("<vector>");
+		CHECK(interner.find("<vector>") == vector);
+		CHECK(interner.find("<ranges>").empty());
+		CHECK(interner.find("").empty());
+		CHECK(interner.size() == 1);
+	}
+
+	TEST_CASE("empty strings aren't stored")
+	{
+		auto interner = info::string_interner();
+		CHECK(interner.intern("") == info::interned_string());
+		CHECK(interner.intern("").empty());
+		CHECK(interner.intern("").c_str() == std::string_view());
+		CHECK(interner.size() == 0);
+	}
+
+	TEST_CASE("interning is thread-safe")
+	{
+		auto interner = info::string_interner();
+		constexpr auto thread_count = 8;
+		constexpr auto string_count = 1'000;
+
+		auto results = std::vector<std::vector<info::interned_string>>(thread_count);
+		{
+			auto threads = std::vector<std::jthread>();
+			for (auto i = 0; i < thread_count; ++i) {
+				threads.emplace_back([&interner, &result = results[i]] {
+					for (auto j = 0; j < string_count; ++j) {
+						result.push_back(interner.intern("module." + std::to_string(j)));
+					}
+				});
+			}
+		}
+
+		CHECK(interner.size() == string_count);
+		for (auto const& result : results) {
+			CHECK(result == results[0]);
+		}
+	}
+
+	TEST_CASE("exported-by lists are interned")
+	{
+		auto interner = info::string_interner();
+		auto const headers = parser::parse_header_info("<vector>, <ranges>,<vector>", interner);
+		REQUIRE(headers.size() == 3);
+		CHECK(headers[0].description() == "<vector>");
+		CHECK(headers[1].description() == "<ranges>");
+		CHECK(headers[0].name() == headers[2].name());
+		CHECK(headers[0].name() != headers[1].name());
+
+		auto const modules = parser::parse_module_info("std, std.compat", interner);
+		REQUIRE(modules.size() == 2);
+		CHECK(modules[0].name().view() == "std");
+		CHECK(modules[1].name().view() == "std.compat");
+		CHECK(interner.size() == 4);
+	}
+} // namespace
@@ -13,8 +13,11 @@ import tempfile
 from lit.llvm import llvm_config
 from lit.llvm.subst import ToolSubst, FindTool
 
+sys.path.insert(0, os.path.dirname(__file__))
+from batched_verify import BatchedVerifyTest
+
 config.name = 'schreiber'
-config.test_format = lit.formats.ShTest(not llvm_config.use_lit_shell)
+config.test_format = BatchedVerifyTest(not llvm_config.use_lit_shell)
 config.suffixes = ['.cc']
 config.excludes = []
 config.test_source_root = os.path.dirname(__file__)
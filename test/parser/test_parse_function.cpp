@@ -31,7 +31,7 @@ namespace {
 		{
 			diags.getDiagnosticOptions().ShowFixits = true;
 			diags.setClient(new clang::TextDiagnosticPrinter(stream, &diags.getDiagnosticOptions(), false));
-			diag::add_diagnostics(diags);
+			REQUIRE(diag::add_diagnostics(diags));
 			auto client = diags.getClient();
 			client->BeginSourceFile(ast->getLangOpts());
 		}
@@ -53,6 +53,8 @@ namespace {
 	TEST_CASE("a function documented with the lyrics of 'We Are!' by Shoko Fujibayashi")
 	{
 		auto const function = function_decl(R"(
+			namespace std { class out_of_range; }
+
 			/// Come aboard, and bring along
 			/// All your hopes and dreams
 			/// Together we'll find everything
@@ -68,8 +70,8 @@ namespace {
 			/// \post 'Till someone proves it real
 			/// \post Through all the troubled times
 			/// \post Through the heartache, and through the pain
-			/// \throws Know that I'll be there to stand by you
-			/// \throws Just like I know you'll stand by me!
+			/// \throws std::out_of_range Know that I'll be there to stand by you
+			/// \throws int Just like I know you'll stand by me!
 			/// \returns So come aboard, and bring along
 			///          All your hopes and dreams
 			///          Together we'll find everything
@@ -125,7 +127,12 @@ namespace {
 		CHECK(f->postconditions()[2].description() == "Through the heartache, and through the pain");
 
 		REQUIRE(f->throws().size() == 2);
+		CHECK(f->throws()[0].type() == "std::out_of_range");
+		REQUIRE(f->throws()[0].type_decl() != nullptr);
+		CHECK(f->throws()[0].type_decl()->getQualifiedNameAsString() == "std::out_of_range");
 		CHECK(f->throws()[0].description() == "Know that I'll be there to stand by you");
+		CHECK(f->throws()[1].type() == "int");
+		CHECK(f->throws()[1].type_decl() == nullptr);
 		CHECK(f->throws()[1].description() == "Just like I know you'll stand by me!");
 
 		CHECK(
@@ -147,4 +154,111 @@ namespace {
 		REQUIRE(f->exits_via().size() == 1);
 		CHECK(f->exits_via()[0].description() == "We are!");
 	}
+
+	TEST_CASE("exception types are looked up from the function's scope")
+	{
+		auto const function = function_decl(R"(
+			namespace app {
+				struct error {};
+
+				namespace detail {
+					/// \throws error If the file can't be opened.
+					/// \throws ::app::error If the file is empty.
+					void load(char const* path);
+				}
+			})");
+		auto p = parser::parser(function.context);
+
+		auto const info = p.parse(function.decl);
+		auto const f = llvm::dyn_cast<info::function_info>(info.get());
+		REQUIRE(function.decl != nullptr);
+		REQUIRE(function.diags.getNumErrors() == 0);
+		REQUIRE(function.diags.getNumWarnings() == 0);
+
+		REQUIRE(f->throws().size() == 2);
+		REQUIRE(f->throws()[0].type_decl() != nullptr);
+		CHECK(f->throws()[0].type_decl()->getQualifiedNameAsString() == "app::error");
+		CHECK(f->throws()[0].description() == "If the file can't be opened.");
+		CHECK(f->throws()[1].type_decl() == f->throws()[0].type_decl());
+
+		auto const scope = function.decl->getDeclContext();
+		CHECK(p.find_type(scope, "error") == f->throws()[0].type_decl());
+		CHECK(p.find_type(scope, "app::error<int>") == f->throws()[0].type_decl());
+		CHECK(p.find_type(scope, "detail") == nullptr);
+		CHECK(p.find_type(scope, "missing") == nullptr);
+		CHECK(p.find_type(scope, "app::missing") == nullptr);
+	}
+
+	TEST_CASE("each header and module in a list is recorded separately")
+	{
+		auto const function = function_decl(R"(
+			/// Sorts a range.
+			/// \headers <algorithm>, <ranges>
+			/// \headers <execution>
+			/// \modules std,std.compat
+			void sort(int* first, int* last);)");
+		auto p = parser::parser(function.context);
+
+		auto const info = p.parse(function.decl);
+		auto const f = llvm::dyn_cast<info::function_info>(info.get());
+		REQUIRE(function.decl != nullptr);
+		REQUIRE(function.diags.getNumErrors() == 0);
+
+		REQUIRE(f->headers().size() == 3);
+		CHECK(f->headers()[0].name().view() == "<algorithm>");
+		CHECK(f->headers()[1].name().view() == "<ranges>");
+		CHECK(f->headers()[2].name().view() == "<execution>");
+
+		REQUIRE(f->modules().size() == 2);
+		CHECK(f->modules()[0].name().view() == "std");
+		CHECK(f->modules()[1].name().view() == "std.compat");
+	}
+
+	TEST_CASE("identical comments are only stored once")
+	{
+		auto const function = function_decl(R"(
+			/// Returns the larger of two values.
+			/// \param x The first value.
+			/// \param y The second value.
+			/// \pre Neither value is NaN.
+			float max(float x, float y);
+
+			/// Returns the larger of two values.
+			/// \param x The first value.
+			/// \param y The second value.
+			/// \pre Neither value is NaN.
+			double max(double x, double y);)");
+		auto const matches = match(functionDecl().bind("decl"), function.context);
+		REQUIRE(matches.size() == 2);
+		auto const first = matches[0].getNodeAs<clang::FunctionDecl>("decl");
+		auto const second = matches[1].getNodeAs<clang::FunctionDecl>("decl");
+		auto p = parser::parser(function.context);
+
+		auto const first_info = p.parse(first);
+		auto const second_info = p.parse(second);
+		auto const f = llvm::dyn_cast<info::function_info>(first_info.get());
+		auto const g = llvm::dyn_cast<info::function_info>(second_info.get());
+		REQUIRE(function.diags.getNumErrors() == 0);
+		REQUIRE(function.diags.getNumWarnings() == 0);
+
+		CHECK(f->description() == "Returns the larger of two values.");
+		CHECK(f->description().data() == g->description().data());
+
+		// Parameters are bound to each declaration separately.
+		REQUIRE(f->parameters().size() == 2);
+		REQUIRE(g->parameters().size() == 2);
+		CHECK(f->parameters()[1].decl() == first->getParamDecl(1));
+		CHECK(g->parameters()[1].decl() == second->getParamDecl(1));
+		CHECK(g->parameters()[1].description() == "The second value.");
+
+		// Locations are relative to each declaration's comment.
+		CHECK(f->parameters()[0].location() != g->parameters()[0].location());
+		CHECK(
+		  function.context.getSourceManager().getPresumedLineNumber(g->parameters()[0].location())
+		  == 9);
+
+		REQUIRE(g->preconditions().size() == 1);
+		CHECK(g->preconditions()[0].description() == "Neither value is NaN.");
+		CHECK(g->preconditions()[0].description().data() == f->preconditions()[0].description().data());
+	}
 } // namespace
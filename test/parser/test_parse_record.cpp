@@ -0,0 +1,214 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include "schreiber/info.hpp"
+#include "schreiber/parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/DeclTemplate.h>
+#include <clang/ASTMatchers/ASTMatchFinder.h>
+#include <clang/ASTMatchers/ASTMatchers.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Tooling/Tooling.h>
+#include <memory>
+#include <schreiber/diagnostic_ids.hpp>
+#include <string>
+#include <string_view>
+
+namespace {
+	namespace ast_matchers = clang::ast_matchers;
+	namespace tooling = clang::tooling;
+
+	using ast_matchers::classTemplateDecl;
+	using ast_matchers::cxxMethodDecl;
+	using ast_matchers::cxxRecordDecl;
+	using ast_matchers::hasName;
+	using ast_matchers::isImplicit;
+	using ast_matchers::match;
+	using ast_matchers::ofClass;
+	using ast_matchers::selectFirst;
+	using ast_matchers::unless;
+
+	struct translation_unit {
+		explicit translation_unit(std::string_view const code)
+		: ast(tooling::buildASTFromCode(code))
+		{
+			diags.setClient(new clang::TextDiagnosticPrinter(stream, &diags.getDiagnosticOptions(), false));
+			REQUIRE(diag::add_diagnostics(diags));
+			diags.getClient()->BeginSourceFile(ast->getLangOpts());
+		}
+
+		~translation_unit()
+		{
+			context.getDiagnostics().getClient()->EndSourceFile();
+		}
+
+		template<class T, class Matcher>
+		[[nodiscard]] auto find(Matcher const& matcher) -> T const*
+		{
+			return selectFirst<T>("decl", match(matcher.bind("decl"), context));
+		}
+
+		[[nodiscard]] auto method(std::string const& record, std::string const& name)
+		  -> clang::CXXMethodDecl const*
+		{
+			return find<clang::CXXMethodDecl>(cxxMethodDecl(hasName(name), ofClass(hasName(record))));
+		}
+
+		std::unique_ptr<clang::ASTUnit> ast;
+		clang::ASTContext& context = ast->getASTContext();
+		clang::DiagnosticsEngine& diags = context.getDiagnostics();
+		std::string text;
+		llvm::raw_string_ostream stream{text};
+	};
+
+	TEST_CASE("records are documented like other entities")
+	{
+		auto tu = translation_unit(R"(
+			/// A ship that sails under the Jolly Roger.
+			/// \headers <fleet/ship.hpp>
+			/// \modules fleet
+			struct ship {
+				/// Launches a ship with a crew of ``crew``.
+				/// \param crew How many pirates are aboard.
+				explicit ship(int crew);
+
+				/// Returns how many pirates are aboard.
+				explicit operator int() const;
+			};
+
+			/// A ship that carries ``Cargo``.
+			template<class Cargo>
+			class galleon {};)");
+		auto p = parser::parser(tu.context);
+
+		auto const decl =
+		  tu.find<clang::CXXRecordDecl>(cxxRecordDecl(hasName("ship"), unless(isImplicit())));
+		REQUIRE(decl != nullptr);
+		auto const info = p.parse(decl);
+		auto const record = llvm::dyn_cast_if_present<info::record_info>(info.get());
+		REQUIRE(record != nullptr);
+		CHECK(tu.diags.getNumErrors() == 0);
+		CHECK_FALSE(llvm::isa<info::class_template_info>(record));
+		CHECK(record->record() == decl);
+		CHECK(record->description() == "A ship that sails under the Jolly Roger.");
+		REQUIRE(record->headers().size() == 1);
+		CHECK(record->headers()[0].name().view() == "<fleet/ship.hpp>");
+		REQUIRE(record->modules().size() == 1);
+		CHECK(record->modules()[0].name().view() == "fleet");
+
+		auto const constructor = p.parse(*decl->ctor_begin());
+		auto const c = llvm::dyn_cast_if_present<info::function_info>(constructor.get());
+		REQUIRE(c != nullptr);
+		REQUIRE(c->parameters().size() == 1);
+		CHECK(c->parameters()[0].description() == "How many pirates are aboard.");
+
+		auto const conversion = p.parse(tu.method("ship", "operator int"));
+		auto const to_int = llvm::dyn_cast_if_present<info::function_info>(conversion.get());
+		REQUIRE(to_int != nullptr);
+		CHECK(to_int->description() == "Returns how many pirates are aboard.");
+
+		auto const galleon = tu.find<clang::ClassTemplateDecl>(classTemplateDecl(hasName("galleon")));
+		REQUIRE(galleon != nullptr);
+		auto const template_info = p.parse(galleon);
+		auto const t = llvm::dyn_cast_if_present<info::class_template_info>(template_info.get());
+		REQUIRE(t != nullptr);
+		CHECK(llvm::isa<info::record_info>(t));
+		CHECK(t->record() == galleon->getTemplatedDecl());
+		CHECK(t->description() == "A ship that carries ``Cargo``.");
+		REQUIRE(t->template_parameters().size() == 1);
+		CHECK(t->template_parameters()[0].decl() == galleon->getTemplateParameters()->getParam(0));
+	}
+
+	TEST_CASE("each header and module in a list is recorded separately")
+	{
+		auto tu = translation_unit(R"(
+			/// A ship.
+			/// \headers <fleet/ship.hpp>, <fleet.hpp>
+			/// \modules fleet, fleet.ship
+			struct ship {};)");
+		auto p = parser::parser(tu.context);
+
+		auto const info = p.parse(tu.find<clang::CXXRecordDecl>(cxxRecordDecl(hasName("ship"))));
+		auto const record = llvm::dyn_cast_if_present<info::record_info>(info.get());
+		REQUIRE(record != nullptr);
+		CHECK(tu.diags.getNumErrors() == 0);
+
+		REQUIRE(record->headers().size() == 2);
+		CHECK(record->headers()[0].name().view() == "<fleet/ship.hpp>");
+		CHECK(record->headers()[1].name().view() == "<fleet.hpp>");
+		REQUIRE(record->modules().size() == 2);
+		CHECK(record->modules()[0].name().view() == "fleet");
+		CHECK(record->modules()[1].name().view() == "fleet.ship");
+	}
+
+	TEST_CASE("function directives can't document records")
+	{
+		auto tu = translation_unit(R"(
+			/// A ship.
+			/// \param crew How many pirates are aboard.
+			/// \headers <ship.hpp>
+			struct ship {};)");
+		auto p = parser::parser(tu.context);
+
+		auto const info = p.parse(tu.find<clang::CXXRecordDecl>(cxxRecordDecl(hasName("ship"))));
+		auto const record = llvm::dyn_cast_if_present<info::record_info>(info.get());
+		REQUIRE(record != nullptr);
+		CHECK(tu.diags.getNumErrors() == 1);
+		CHECK(
+		  tu.text.find("'\\param' directive for 'ship', which is not a function") != std::string::npos);
+		CHECK(record->headers().size() == 1);
+	}
+
+	TEST_CASE("overriding members without a comment refer to the base member's documentation")
+	{
+		auto tu = translation_unit(R"(
+			struct ship {
+				/// Sails to ``port``.
+				/// \param port Where to go.
+				virtual void sail(int port);
+
+				/// Sinks the ship.
+				virtual ~ship();
+			};
+
+			struct brig : ship {
+				void sail(int port) override;
+				~brig() override;
+			};
+
+			struct sloop : brig {
+				void sail(int port) override;
+			};
+
+			struct frigate : ship {
+				/// Sails to ``port``, with cannons at the ready.
+				void sail(int port) override;
+			};)");
+		auto p = parser::parser(tu.context);
+		auto const base = tu.method("ship", "sail");
+		REQUIRE(base != nullptr);
+
+		// Every level refers to the member that's documented, rather than to the level above it.
+		for (auto const* const record : {"brig", "sloop"}) {
+			auto const info = p.parse(tu.method(record, "sail"));
+			auto const f = llvm::dyn_cast_if_present<info::function_info>(info.get());
+			REQUIRE(f != nullptr);
+			CHECK(f->inherits_from() == base);
+			CHECK(f->description().empty());
+			CHECK(f->parameters().empty());
+		}
+
+		auto const documented = p.parse(tu.method("frigate", "sail"));
+		auto const f = llvm::dyn_cast_if_present<info::function_info>(documented.get());
+		REQUIRE(f != nullptr);
+		CHECK(f->inherits_from() == nullptr);
+		CHECK(f->description() == "Sails to ``port``, with cannons at the ready.");
+
+		auto const brig = tu.find<clang::CXXRecordDecl>(cxxRecordDecl(hasName("brig")));
+		REQUIRE(brig != nullptr);
+		CHECK(p.parse(brig->getDestructor()) == nullptr);
+	}
+} // namespace
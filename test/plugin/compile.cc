@@ -0,0 +1,21 @@
+// clang-format off
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang -fplugin=%{plugin} -c %s -o %t/input.o 2> %t/compile.log
+// RUN: test -f %t/input.o
+// RUN: test ! -s %t/compile.log
+// RUN: FileCheck %s --check-prefix=JSON --input-file=%t/input.o.schreiber.json
+// RUN: FileCheck %s --check-prefix=DIAGNOSTICS --input-file=%t/input.o.schreiber.diagnostics \
+// RUN:   --match-full-lines --implicit-check-not=error --implicit-check-not=warning
+
+/// Adds two numbers.
+/// \param x The first number.
+/// \param y The second number.
+int add(int x, int y) { return x + y; }
+// JSON-DAG: "qualified_name":"add"
+
+/// \param num Top
+/// \param denominator Bottom
+int div(int num, int denom) { return num / denom; }
+// JSON-DAG: "qualified_name":"div"
+// DIAGNOSTICS: {{.*}}compile.cc:17:12: error: documented parameter 'denominator' does not map to a parameter in this declaration of 'div'
+// DIAGNOSTICS: {{.*}}compile.cc:17:12: note: the word immediately after '\param' must name one of the parameters in the function declaration
@@ -0,0 +1,531 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <chrono>
+#include <clang/Tooling/CommonOptionsParser.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <cstddef>
+#include <cstdint>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <ranges>
+#include <schreiber/changed_lines.hpp>
+#include <schreiber/cross_references.hpp>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/file_cache.hpp>
+#include <schreiber/file_watcher.hpp>
+#include <schreiber/include_graph.hpp>
+#include <schreiber/memory_stats.hpp>
+#include <schreiber/render_rst.hpp>
+#include <schreiber/scheduler.hpp>
+#include <schreiber/search_index.hpp>
+#include <schreiber/serialise.hpp>
+#include <schreiber/string_interner.hpp>
+#include <schreiber/worker_pool.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+	namespace cl = llvm::cl;
+	namespace tooling = clang::tooling;
+
+	auto category = cl::OptionCategory("schreiber options");
+
+	auto output = cl::opt<std::string>(
+	  "o",
+	  cl::desc("Writes the extracted documentation to <file>"),
+	  cl::value_desc("file"),
+	  cl::init("-"),
+	  cl::cat(category));
+
+	auto jobs = cl::opt<unsigned>(
+	  "j",
+	  cl::desc("The number of translation units to process concurrently"),
+	  cl::init(1),
+	  cl::cat(category));
+
+	auto history_file = cl::opt<std::string>(
+	  "history",
+	  cl::desc(
+	    "Reads how long each translation unit took from <file> to schedule the slowest first, and "
+	    "records this run's timings there"),
+	  cl::value_desc("file"),
+	  cl::cat(category));
+
+	auto memory_budget = cl::opt<unsigned>(
+	  "memory-budget",
+	  cl::desc(
+	    "Holds back new translation units while the run's resident memory is close to <MiB>. At "
+	    "least one translation unit is always in flight"),
+	  cl::value_desc("MiB"),
+	  cl::init(0),
+	  cl::cat(category));
+
+	auto timeout = cl::opt<unsigned>(
+	  "timeout",
+	  cl::desc(
+	    "Stops extracting a translation unit after <seconds>, keeping what was extracted so far. "
+	    "With --isolate, a worker that doesn't stop within twice this is killed"),
+	  cl::value_desc("seconds"),
+	  cl::init(0),
+	  cl::cat(category));
+
+	auto diff_file = cl::opt<std::string>(
+	  "diff",
+	  cl::desc(
+	    "Only extracts declarations whose declaration or comment overlaps a line changed by the "
+	    "unified diff in <file>, such as the output of 'git diff -U0', and only parses enough "
+	    "translation units to reach each changed file. Paths in the diff are relative to the "
+	    "current directory"),
+	  cl::value_desc("file"),
+	  cl::cat(category));
+
+	auto cover_directory = cl::opt<std::string>(
+	  "cover",
+	  cl::desc(
+	    "Only parses enough translation units to reach every header under <directory> once, "
+	    "preferring the cheapest. With --diff, only the changed headers need to be reached"),
+	  cl::value_desc("directory"),
+	  cl::cat(category));
+
+	auto manifest = cl::opt<std::string>(
+	  "manifest",
+	  cl::desc(
+	    "Writes the content hash of each entity's documentation to <file>, so that only the pages "
+	    "for entities whose hash has changed since the last run need to be regenerated"),
+	  cl::value_desc("file"),
+	  cl::cat(category));
+
+	auto imports = cl::opt<std::string>(
+	  "imports",
+	  cl::desc(
+	    "Writes the entities that each header and module exports to <file>, identifying each entity "
+	    "by the line of the output that it's on"),
+	  cl::value_desc("file"),
+	  cl::cat(category));
+
+	auto search_index = cl::opt<std::string>(
+	  "search-index",
+	  cl::desc(
+	    "Writes a full-text index of the documentation to <file>. The index is built while "
+	    "translation units are still being extracted"),
+	  cl::value_desc("file"),
+	  cl::cat(category));
+
+	auto rst_directory = cl::opt<std::string>(
+	  "rst",
+	  cl::desc(
+	    "Writes a reStructuredText page for each namespace to <directory>, for Sphinx. Pages whose "
+	    "entities haven't changed since the last run are left alone"),
+	  cl::value_desc("directory"),
+	  cl::cat(category));
+
+	auto rst_pages = cl::opt<driver::page_grouping>(
+	  "rst-pages",
+	  cl::desc("Chooses what each page written by --rst documents"),
+	  cl::values(
+	    clEnumValN(driver::page_grouping::by_namespace, "namespace", "One page per namespace"),
+	    clEnumValN(driver::page_grouping::by_header, "header", "One page per header")),
+	  cl::init(driver::page_grouping::by_namespace),
+	  cl::cat(category));
+
+	auto isolate = cl::opt<bool>(
+	  "isolate",
+	  cl::desc(
+	    "Processes translation units in worker processes, so that a crash only loses the translation "
+	    "unit that caused it"),
+	  cl::cat(category));
+
+	auto stats = cl::opt<bool>(
+	  "stats",
+	  cl::desc(
+	    "Reports where each translation unit's memory went, and the totals for the run, to stderr"),
+	  cl::cat(category));
+
+	auto watch = cl::opt<bool>(
+	  "watch",
+	  cl::desc(
+	    "Keeps running after the first extraction, and whenever files under the current directory "
+	    "change, re-extracts only enough translation units to reach them and rewrites the outputs"),
+	  cl::cat(category));
+
+	auto watch_debounce = cl::opt<unsigned>(
+	  "watch-debounce",
+	  cl::desc("With --watch, waits until no file has changed for <ms> before rebuilding"),
+	  cl::value_desc("ms"),
+	  cl::init(200),
+	  cl::cat(category));
+
+	/// Resolves the references between every translation unit's entities, and writes each output
+	/// that was asked for.
+	///
+	/// \returns false if an output couldn't be written.
+	[[nodiscard]] auto write_outputs(
+	  std::span<driver::translation_unit_result> const results,
+	  info::search_index_builder const& search) -> bool
+	{
+		// Documentation can mention entities from any translation unit, so mentions can only be
+		// resolved once they've all been extracted.
+		auto symbols = info::symbol_table();
+		for (auto const* const entity : driver::unique_entities(results)) {
+			symbols.add(*entity);
+		}
+
+		for (auto& result : results) {
+			for (auto& entity : result.unit.entities()) {
+				entity.references = info::resolve_references(entity, symbols);
+			}
+		}
+
+		auto error = std::error_code();
+		auto os = llvm::raw_fd_ostream(output, error);
+		if (error) {
+			llvm::errs() << "error: unable to open '" << output << "': " << error.message() << '\n';
+			return false;
+		}
+
+		driver::write_entities(os, results);
+
+		if (not manifest.empty()) {
+			auto manifest_os = llvm::raw_fd_ostream(manifest, error);
+			if (error) {
+				llvm::errs() << "error: unable to open '" << manifest << "': " << error.message() << '\n';
+				return false;
+			}
+
+			driver::write_manifest(manifest_os, results);
+		}
+
+		if (not imports.empty()) {
+			auto imports_os = llvm::raw_fd_ostream(imports, error);
+			if (error) {
+				llvm::errs() << "error: unable to open '" << imports << "': " << error.message() << '\n';
+				return false;
+			}
+
+			driver::write_imports(imports_os, driver::unique_entities(results));
+		}
+
+		if (not search_index.empty()) {
+			auto search_os = llvm::raw_fd_ostream(search_index, error);
+			if (error) {
+				llvm::errs() << "error: unable to open '" << search_index << "': " << error.message()
+				             << '\n';
+				return false;
+			}
+
+			search.write(search_os);
+		}
+
+		if (not rst_directory.empty()) {
+			auto const rendered = driver::render_pages(
+			  driver::unique_entities(results),
+			  rst_directory,
+			  {.grouping = rst_pages, .jobs = jobs});
+			if (not rendered) {
+				llvm::errs() << "error: " << rendered.error() << '\n';
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// Returns the directory of every file under ``root`` that a translation unit reaches.
+	[[nodiscard]] auto
+	directories_to_watch(driver::include_graph const& graph, std::string_view const root)
+	  -> std::vector<std::string>
+	{
+		auto result = std::vector<std::string>();
+		for (auto const file : graph.files_under(root)) {
+			result.emplace_back(llvm::sys::path::parent_path(file));
+		}
+
+		std::ranges::sort(result);
+		auto const duplicates = std::ranges::unique(result);
+		result.erase(duplicates.begin(), duplicates.end());
+		return result;
+	}
+
+	/// Returns the content hash of every entity in ``results``, keyed by USR.
+	[[nodiscard]] auto content_hashes(std::span<driver::translation_unit_result const> const results)
+	  -> absl::flat_hash_map<std::string_view, std::uint64_t>
+	{
+		auto result = absl::flat_hash_map<std::string_view, std::uint64_t>();
+		for (auto const* const entity : driver::unique_entities(results)) {
+			result.try_emplace(entity->usr, entity->content_hash);
+		}
+
+		return result;
+	}
+
+	/// Re-extracts the translation units that reach each batch of changed files under ``root``, and
+	/// rewrites the outputs, until watching fails.
+	///
+	/// Only enough translation units to reach every changed file are rebuilt. The others that reach
+	/// a changed file forget the entities declared in it, so that the rebuilt translation units'
+	/// copies replace them.
+	[[nodiscard]] auto watch_for_changes(
+	  std::span<tooling::CompileCommand const> const commands,
+	  std::span<driver::translation_unit_result> const results,
+	  driver::run_options const& options,
+	  std::string_view const root) -> int
+	{
+		auto graph = driver::include_graph::scan(commands, jobs);
+		auto watcher = driver::file_watcher::create();
+		if (not watcher) {
+			llvm::errs() << "error: " << watcher.error() << '\n';
+			return 1;
+		}
+
+		// Rebuilding a translation unit can make it reach new directories.
+		auto const watch_reached = [&] {
+			for (auto const& directory : directories_to_watch(graph, root)) {
+				if (auto const watched = watcher->watch(directory); not watched) {
+					llvm::errs() << "warning: " << watched.error() << '\n';
+				}
+			}
+		};
+
+		watch_reached();
+		llvm::errs() << "watching " << watcher->directories() << " directories for changes\n";
+		while (true) {
+			auto const changed = watcher->wait(std::chrono::milliseconds(watch_debounce));
+			if (not changed) {
+				llvm::errs() << "error: " << changed.error() << '\n';
+				return 1;
+			}
+
+			auto const files = std::vector<std::string_view>(changed->begin(), changed->end());
+			auto const affected = graph.including_any(files);
+			if (affected.empty()) {
+				continue;
+			}
+
+			auto const rebuilt = graph.cover(files, driver::estimate_costs(commands, options.history));
+			auto selected = std::vector<tooling::CompileCommand>();
+			for (auto const i : rebuilt) {
+				selected.push_back(commands[i]);
+			}
+
+			auto const before = content_hashes(results);
+			auto fresh = isolate ? driver::run_isolated(selected, options)
+			                     : driver::run_in_process(selected, options);
+
+			// The files have changed, so the cache from the last scan can't be reused.
+			auto cache = driver::file_cache();
+			for (auto i = std::size_t{0}; i < rebuilt.size(); ++i) {
+				llvm::errs() << fresh[i].diagnostics;
+				results[rebuilt[i]] = std::move(fresh[i]);
+				graph.replace(rebuilt[i], driver::scan_includes(commands[rebuilt[i]], cache));
+			}
+
+			for (auto const i : affected) {
+				if (std::ranges::binary_search(rebuilt, i)) {
+					continue;
+				}
+
+				results[i].unit.erase_if([&](info::detached_entity const& entity) {
+					auto path = llvm::SmallString<256>(entity.location.file);
+					llvm::sys::fs::make_absolute(commands[i].Directory, path);
+					llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/true);
+					return std::ranges::binary_search(*changed, std::string_view(path.str()));
+				});
+			}
+
+			auto search = info::search_index_builder();
+			if (not search_index.empty()) {
+				for (auto const& result : results) {
+					search.add(result.unit);
+				}
+			}
+
+			if (not write_outputs(results, search)) {
+				return 1;
+			}
+
+			auto const after = content_hashes(results);
+			auto updated = std::ranges::count_if(after, [&before](auto const& entry) {
+				auto const i = before.find(entry.first);
+				return i == before.end() or i->second != entry.second;
+			});
+			updated += std::ranges::count_if(before, [&after](auto const& entry) {
+				return not after.contains(entry.first);
+			});
+
+			llvm::errs() << "rebuilt " << rebuilt.size() << " of " << commands.size()
+			             << " translation units for " << changed->size() << " changed files; "
+			             << updated << " entities changed\n";
+			watch_reached();
+		}
+	}
+} // namespace
+
+int main(int argc, char const* argv[])
+{
+	auto const init = llvm::InitLLVM(argc, argv);
+	auto options = tooling::CommonOptionsParser::create(argc, argv, category);
+	if (not options) {
+		llvm::errs() << llvm::toString(options.takeError()) << '\n';
+		return 1;
+	}
+
+	auto failed = false;
+	auto commands = std::vector<tooling::CompileCommand>();
+	for (auto const& path : options->getSourcePathList()) {
+		auto matches = options->getCompilations().getCompileCommands(path);
+		if (matches.empty()) {
+			llvm::errs() << "error: no compile command found for '" << path << "'\n";
+			failed = true;
+			continue;
+		}
+
+		commands.push_back(std::move(matches.front()));
+	}
+
+	auto history = driver::timing_history();
+	if (not history_file.empty()) {
+		if (auto loaded = driver::timing_history::load(history_file)) {
+			history = *std::move(loaded);
+		}
+		else {
+			llvm::errs() << "warning: " << loaded.error() << "; scheduling without a history\n";
+		}
+	}
+
+	auto root = llvm::SmallString<256>();
+	if (auto const error = llvm::sys::fs::current_path(root)) {
+		llvm::errs() << "error: unable to get the current directory: " << error.message() << '\n';
+		return 1;
+	}
+
+	auto changed = std::optional<driver::changed_lines>();
+	if (not diff_file.empty()) {
+		auto const buffer = llvm::MemoryBuffer::getFileOrSTDIN(diff_file, /*IsText=*/true);
+		if (not buffer) {
+			llvm::errs() << "error: unable to read '" << diff_file
+			             << "': " << buffer.getError().message() << '\n';
+			return 1;
+		}
+
+		auto parsed = driver::changed_lines::parse((*buffer)->getBuffer(), root.str());
+		if (not parsed) {
+			llvm::errs() << "error: '" << diff_file << "': " << parsed.error() << '\n';
+			return 1;
+		}
+
+		changed = *std::move(parsed);
+	}
+
+	if (watch and changed.has_value()) {
+		llvm::errs() << "error: --watch can't be combined with --diff\n";
+		return 1;
+	}
+
+	if (changed.has_value() or not cover_directory.empty()) {
+		// A preprocessor-only pass is much cheaper than building an AST, so it's worth scanning every
+		// translation unit to find the few that need to be built.
+		auto const graph = driver::include_graph::scan(commands, jobs);
+		auto wanted = std::vector<std::string_view>();
+		if (not cover_directory.empty()) {
+			auto directory = llvm::SmallString<256>(cover_directory);
+			llvm::sys::fs::make_absolute(root, directory);
+			llvm::sys::path::remove_dots(directory, /*remove_dot_dot=*/true);
+			wanted = graph.files_under(directory.str());
+		}
+
+		if (changed.has_value()) {
+			auto const files = changed->files();
+			if (cover_directory.empty()) {
+				wanted = files;
+			}
+			else {
+				std::erase_if(wanted, [&files](std::string_view const file) {
+					return not std::ranges::binary_search(files, file);
+				});
+			}
+		}
+
+		auto selected = std::vector<tooling::CompileCommand>();
+		for (auto const i : graph.cover(wanted, driver::estimate_costs(commands, &history))) {
+			selected.push_back(std::move(commands[i]));
+		}
+
+		commands = std::move(selected);
+	}
+
+	// --watch rebuilds intern into their own interner rather than string_interner::global(), which
+	// every other user of the process shares. It's declared before the results that refer to it.
+	auto watch_interner = info::string_interner();
+	auto search = info::search_index_builder();
+	auto cache = driver::file_cache();
+	auto const run_options = driver::run_options{
+	  .jobs = jobs,
+	  .history = &history,
+	  .memory_limit = std::size_t{memory_budget} * 1024 * 1024,
+	  .timeout = std::chrono::seconds(timeout),
+	  .changed = changed.has_value() ? &*changed : nullptr,
+	  .search = search_index.empty() ? nullptr : &search,
+	  .cache = &cache,
+	};
+	auto results = isolate ? driver::run_isolated(commands, run_options)
+	                       : driver::run_in_process(commands, run_options);
+	for (auto const& result : results) {
+		llvm::errs() << result.diagnostics;
+		if (result.status != driver::translation_unit_result::status_t::ok) {
+			failed = true;
+		}
+	}
+
+	if (not history_file.empty()) {
+		for (auto i = std::size_t{0}; i < results.size(); ++i) {
+			if (results[i].status != driver::translation_unit_result::status_t::crashed) {
+				history.record(driver::main_file_path(commands[i]), results[i].elapsed);
+			}
+		}
+
+		if (auto const saved = history.save(history_file); not saved) {
+			llvm::errs() << "warning: " << saved.error() << '\n';
+		}
+	}
+
+	if (not write_outputs(results, search)) {
+		return 1;
+	}
+
+	if (stats) {
+		auto total = driver::memory_stats();
+		for (auto const& result : results) {
+			driver::write_stats(llvm::errs(), "'" + result.file + "'", result.memory);
+			total += result.memory;
+		}
+
+		total.record(info::string_interner::global());
+		total.record(cache);
+		driver::write_stats(llvm::errs(), "total", total);
+	}
+
+	if (watch) {
+		auto watch_options = run_options;
+		watch_options.search = nullptr;
+		watch_options.cache = nullptr;
+		watch_options.interner = &watch_interner;
+		return watch_for_changes(commands, results, watch_options, root.str());
+	}
+
+	return failed ? 1 : 0;
+}
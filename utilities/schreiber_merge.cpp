@@ -0,0 +1,67 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/raw_ostream.h>
+#include <schreiber/merge.hpp>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+	namespace cl = llvm::cl;
+
+	auto category = cl::OptionCategory("schreiber-merge options");
+
+	auto inputs = cl::list<std::string>(
+	  cl::Positional,
+	  cl::desc("<input files>"),
+	  cl::OneOrMore,
+	  cl::cat(category));
+
+	auto output = cl::opt<std::string>(
+	  "o",
+	  cl::desc("Writes the merged documentation to <file>"),
+	  cl::value_desc("file"),
+	  cl::init("-"),
+	  cl::cat(category));
+
+	auto shards = cl::opt<unsigned>(
+	  "shards",
+	  cl::desc("Splits the merge into <n> parts by USR hash, and merges them concurrently"),
+	  cl::value_desc("n"),
+	  cl::init(1),
+	  cl::cat(category));
+} // namespace
+
+int main(int argc, char const* argv[])
+{
+	auto const init = llvm::InitLLVM(argc, argv);
+	cl::HideUnrelatedOptions(category);
+
+	// Inputs can be listed in a response file with ``@file``, since a large build produces more
+	// outputs than fit on a command line.
+	cl::ParseCommandLineOptions(
+	  argc,
+	  argv,
+	  "Merges the documentation written by 'schreiber' or the schreiber plugin for separate "
+	  "translation units, keeping one copy of each entity\n");
+
+	auto error = std::error_code();
+	auto os = llvm::raw_fd_ostream(output, error);
+	if (error) {
+		llvm::errs() << "error: unable to open '" << output << "': " << error.message() << '\n';
+		return 1;
+	}
+
+	auto const paths = std::vector<std::string>(inputs.begin(), inputs.end());
+	auto const result = driver::merge_entities(paths, os, {.shards = shards});
+	if (not result) {
+		llvm::errs() << "error: " << result.error() << '\n';
+		return 1;
+	}
+
+	llvm::errs() << result->diagnostics;
+	return 0;
+}
@@ -0,0 +1,201 @@
+// Copyright (c) Google LLC.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/ASTContext.h>
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Frontend/FrontendPluginRegistry.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <schreiber/detached_info.hpp>
+#include <schreiber/extract.hpp>
+#include <schreiber/serialise.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+	constexpr auto output_suffix = std::string_view(".schreiber.json");
+
+	/// Sends everything reported to ``diagnostics`` to ``consumer`` until it's destroyed, when the
+	/// original client is put back.
+	class diagnostic_redirect {
+	public:
+		diagnostic_redirect(
+		  clang::DiagnosticsEngine& diagnostics,
+		  clang::DiagnosticConsumer& consumer) noexcept
+		: diagnostics_(&diagnostics)
+		, client_(diagnostics.getClient())
+		, owned_(diagnostics.takeClient())
+		{
+			diagnostics.setClient(&consumer, /*ShouldOwnClient=*/false);
+		}
+
+		~diagnostic_redirect()
+		{
+			auto const owns_client = owned_ != nullptr;
+			static_cast<void>(owned_.release());
+			diagnostics_->setClient(client_, owns_client);
+		}
+	private:
+		clang::DiagnosticsEngine* diagnostics_;
+		clang::DiagnosticConsumer* client_;
+		std::unique_ptr<clang::DiagnosticConsumer> owned_;
+	};
+
+	/// Extracts the translation unit's documentation from the AST that the compiler has already
+	/// built, and writes it to ``output`` in the same format as ``schreiber -o``.
+	///
+	/// schreiber's diagnostics are about the documentation rather than the code, so they're kept out
+	/// of the compile: they'd otherwise fail the build over a documentation mistake, and delete the
+	/// object file that's just been generated. They're written alongside ``output`` instead, with a
+	/// ``.diagnostics`` extension.
+	class plugin_consumer : public clang::ASTConsumer {
+	public:
+		plugin_consumer(std::string file, std::string output) noexcept
+		: file_(std::move(file))
+		, output_(std::move(output))
+		{}
+
+		void HandleTranslationUnit(clang::ASTContext& context) override
+		{
+			auto& diagnostics = context.getDiagnostics();
+			if (diagnostics.hasErrorOccurred()) {
+				return;
+			}
+
+			auto result = driver::translation_unit_result{
+			  .file = file_,
+			  .unit = info::detached_translation_unit(file_),
+			};
+
+			{
+				auto buffer = llvm::raw_string_ostream(result.diagnostics);
+				auto printer = clang::TextDiagnosticPrinter(buffer, &diagnostics.getDiagnosticOptions());
+				printer.BeginSourceFile(context.getLangOpts());
+				{
+					auto const redirect = diagnostic_redirect(diagnostics, printer);
+					driver::extract_consumer(result).HandleTranslationUnit(context);
+				}
+				printer.EndSourceFile();
+			}
+
+			// The compile hadn't reported any errors before extracting, so a soft reset only forgets
+			// schreiber's.
+			diagnostics.Reset(/*soft=*/true);
+
+			write(diagnostics, output_, [&result](llvm::raw_ostream& os) {
+				driver::write_entities(os, std::span(&result, 1));
+			});
+
+			auto diagnostics_path = llvm::SmallString<128>(output_);
+			llvm::sys::path::replace_extension(diagnostics_path, "diagnostics");
+			if (result.diagnostics.empty()) {
+				// Removes what an earlier compile left behind, so that it isn't mistaken for this one's.
+				static_cast<void>(llvm::sys::fs::remove(diagnostics_path));
+				return;
+			}
+
+			write(diagnostics, diagnostics_path.str(), [&result](llvm::raw_ostream& os) {
+				os << result.diagnostics;
+			});
+		}
+	private:
+		std::string file_;
+		std::string output_;
+
+		static void write(
+		  clang::DiagnosticsEngine& diagnostics,
+		  llvm::StringRef const path,
+		  llvm::function_ref<void(llvm::raw_ostream&)> const contents)
+		{
+			auto error = std::error_code();
+			auto os = llvm::raw_fd_ostream(path, error, llvm::sys::fs::OF_Text);
+			if (error) {
+				auto const id =
+				  diagnostics.getCustomDiagID(clang::DiagnosticsEngine::Error, "unable to write '%0': %1");
+				diagnostics.Report(id) << path << error.message();
+				return;
+			}
+
+			contents(os);
+		}
+	};
+
+	/// Runs schreiber as part of a normal compile, so that documenting a translation unit only costs
+	/// parsing its comments. Each translation unit's documentation is written next to its object
+	/// file, as ``<object file>.schreiber.json``, to be merged once the build has finished, and any
+	/// documentation diagnostics are written to ``<object file>.schreiber.diagnostics``.
+	///
+	/// The output path can be chosen with ``-fplugin-arg-schreiber-output=<file>``.
+	class schreiber_plugin : public clang::PluginASTAction {
+	protected:
+		auto CreateASTConsumer(clang::CompilerInstance& compiler, llvm::StringRef const file)
+		  -> std::unique_ptr<clang::ASTConsumer> override
+		{
+			return std::make_unique<plugin_consumer>(file.str(), output_path(compiler, file));
+		}
+
+		auto ParseArgs(
+		  clang::CompilerInstance const& compiler,
+		  std::vector<std::string> const& arguments) -> bool override
+		{
+			constexpr auto output_flag = std::string_view("output=");
+			for (auto const& argument : arguments) {
+				if (argument.starts_with(output_flag)) {
+					output_ = argument.substr(output_flag.size());
+					continue;
+				}
+
+				auto& diagnostics = compiler.getDiagnostics();
+				auto const id = diagnostics.getCustomDiagID(
+				  clang::DiagnosticsEngine::Error,
+				  "unknown schreiber plugin argument '%0'");
+				diagnostics.Report(id) << argument;
+				return false;
+			}
+
+			return true;
+		}
+
+		auto getActionType() -> ActionType override
+		{
+			return AddAfterMainAction;
+		}
+	private:
+		std::string output_;
+
+		[[nodiscard]] auto
+		output_path(clang::CompilerInstance const& compiler, llvm::StringRef const file) const
+		  -> std::string
+		{
+			if (not output_.empty()) {
+				return output_;
+			}
+
+			auto const& object = compiler.getFrontendOpts().OutputFile;
+			if (not object.empty() and object != "-") {
+				return object + std::string(output_suffix);
+			}
+
+			// There's no object file when only checking syntax, so the output goes in the working
+			// directory instead.
+			return llvm::sys::path::filename(file).str() + std::string(output_suffix);
+		}
+	};
+} // namespace
+
+static auto const registration = clang::FrontendPluginRegistry::Add<schreiber_plugin>(
+  "schreiber",
+  "Extracts documentation during a normal compile");
@@ -2,104 +2,182 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 #include <algorithm>
-#include <clang/AST/Decl.h>
-#include <clang/AST/DeclTemplate.h>
-#include <clang/ASTMatchers/ASTMatchFinder.h>
-#include <clang/ASTMatchers/ASTMatchers.h>
 #include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Frontend/FrontendOptions.h>
 #include <clang/Frontend/TextDiagnosticPrinter.h>
 #include <clang/Frontend/VerifyDiagnosticConsumer.h>
+#include <clang/Tooling/CompilationDatabase.h>
 #include <clang/Tooling/Tooling.h>
 #include <fstream>
 #include <iterator>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/raw_ostream.h>
+#include <memory>
 #include <schreiber/diagnostic_ids.hpp>
+#include <schreiber/extract.hpp>
 #include <schreiber/parser.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
 
 namespace {
-	namespace ast_matchers = clang::ast_matchers;
 	namespace tooling = clang::tooling;
 
-	using ast_matchers::allOf;
-	using ast_matchers::anyOf;
-	using ast_matchers::decl;
-	using ast_matchers::friendDecl;
-	using ast_matchers::hasParent;
-	using ast_matchers::isImplicit;
-	using ast_matchers::isPrivate;
-	using ast_matchers::match;
-	using ast_matchers::namedDecl;
-	using ast_matchers::namespaceDecl;
-	using ast_matchers::recordDecl;
-	using ast_matchers::translationUnitDecl;
-	using ast_matchers::unless;
-} // namespace
+	auto const compiler_args = std::vector<std::string>{"-std=c++23"};
 
-/// A simple program to check diagnostics while there isn't a proper schreiber binary.
-int main(int argc, char* argv[])
-{
-	if (argc != 2) {
-		llvm::errs() << "usage: ./verify-diagnostics /path/to/file.cpp\n";
-		return 1;
-	}
+	/// Parses the documentation for every declaration in ``ast`` that should be documented.
+	///
+	/// \returns ``false`` if the AST couldn't be built without errors, and ``true`` otherwise.
+	auto verify(clang::ASTUnit& ast) -> bool
+	{
+		auto& diags = ast.getDiagnostics();
+		if (diags.getNumErrors() > 0) {
+			return false;
+		}
 
-	auto file = std::ifstream(argv[1]);
-	if (not file) {
-		llvm::errs() << "unable to open file '" << argv[1] << "'\n";
-		return 1;
+		if (not diag::add_diagnostics(diags)) {
+			llvm::errs() << "unable to register schreiber's diagnostics\n";
+			return false;
+		}
+
+		diags.getClient()->BeginSourceFile(ast.getLangOpts());
+		{
+			auto p = parser::parser(ast.getASTContext());
+			for (auto const decl : driver::documentable_decls(ast.getASTContext())) {
+				(void)p.parse(decl);
+			}
+		}
+		diags.getClient()->EndSourceFile();
+		return true;
 	}
 
-	auto code = std::string();
-	std::ranges::copy(std::istreambuf_iterator<char>(file), std::default_sentinel, std::back_inserter(code));
+	/// Verifies a single file, reporting diagnostics as though the file were named ``input.cc``.
+	auto verify_file(char const* const path) -> int
+	{
+		auto file = std::ifstream(path);
+		if (not file) {
+			llvm::errs() << "unable to open file '" << path << "'\n";
+			return 1;
+		}
 
-	file.peek();
-	if (not file.eof()) {
-		llvm::errs() << "unable to read file '" << argv[1] << "'\n";
-		return 1;
-	}
+		auto code = std::string();
+		std::ranges::copy(std::istreambuf_iterator<char>(file), std::default_sentinel, std::back_inserter(code));
 
-	auto const ast = tooling::buildASTFromCodeWithArgs(code, {"-std=c++23"});
-	if (ast == nullptr) {
-		llvm::errs() << "couldn't acquire an AST\n";
-		return 1;
-	}
+		file.peek();
+		if (not file.eof()) {
+			llvm::errs() << "unable to read file '" << path << "'\n";
+			return 1;
+		}
 
-	auto& diags = ast->getDiagnostics();
-	if (diags.getNumErrors() > 0) {
-		return 1;
+		auto const ast = tooling::buildASTFromCodeWithArgs(code, compiler_args);
+		if (ast == nullptr) {
+			llvm::errs() << "couldn't acquire an AST\n";
+			return 1;
+		}
+
+		return verify(*ast) ? 0 : 1;
 	}
 
-	auto decls = match(
-	  decl(
-	    anyOf(
-	      namedDecl(allOf(
-	        anyOf(hasParent(translationUnitDecl()), hasParent(namespaceDecl()), hasParent(recordDecl())),
-	        unless(anyOf(isImplicit(), isPrivate())))),
-	      friendDecl()))
-	    .bind("root"),
-	  ast->getASTContext());
-
-	diag::add_diagnostics(diags);
-	diags.getClient()->BeginSourceFile(ast->getLangOpts());
+	/// Builds and verifies one AST per file that a ``tooling::ClangTool`` hands it. The tool owns a
+	/// single ``clang::FileManager`` and compiler setup, which are shared by every file in the batch.
+	///
+	/// Each file's diagnostics are preceded by a ``verify-diagnostics: <path>`` line, so that the
+	/// output can be split by file (see test/batched_verify.py).
+	class verify_action final : public tooling::ToolAction {
+	public:
+		auto runInvocation(
+		  std::shared_ptr<clang::CompilerInvocation> invocation,
+		  clang::FileManager* const files,
+		  std::shared_ptr<clang::PCHContainerOperations> pch_container_ops,
+		  clang::DiagnosticConsumer* const diag_consumer) -> bool override
+		{
+			for (auto const& input : invocation->getFrontendOpts().Inputs) {
+				llvm::errs() << "verify-diagnostics: " << input.getFile() << '\n';
+			}
+
+			auto diags = clang::CompilerInstance::createDiagnostics(
+			  &invocation->getDiagnosticOpts(),
+			  diag_consumer,
+			  /*ShouldOwnClient=*/false);
+			auto const ast = clang::ASTUnit::LoadFromCompilerInvocation(
+			  std::move(invocation),
+			  std::move(pch_container_ops),
+			  std::move(diags),
+			  files);
+			return ast != nullptr and verify(*ast);
+		}
+	};
+
+	/// Collects the lit tests in ``path``, which is either a test or a directory of tests.
+	auto collect_tests(std::string_view const path, std::vector<std::string>& tests) -> bool
 	{
-		auto p = parser::parser(ast->getASTContext());
-		for (auto const& i : decls) {
-			if (auto named_decl = i.getNodeAs<clang::NamedDecl>("root")) {
-				(void)p.parse(named_decl);
+		if (not llvm::sys::fs::is_directory(path)) {
+			tests.emplace_back(path);
+			return true;
+		}
+
+		auto error = std::error_code();
+		for (auto i = llvm::sys::fs::recursive_directory_iterator(path, error);
+		     i != llvm::sys::fs::recursive_directory_iterator() and not error;
+		     i.increment(error))
+		{
+			if (llvm::sys::path::extension(i->path()) == ".cc") {
+				tests.push_back(i->path());
 			}
-			else if (auto const friend_decl = i.getNodeAs<clang::FriendDecl>("root")) {
-				if ((named_decl = friend_decl->getFriendDecl())) {
-					if (named_decl->hasBody()) {
-						(void)p.parse(named_decl);
-					}
-					else if (auto const function_template = llvm::dyn_cast<clang::FunctionTemplateDecl>(named_decl);
-					         function_template and function_template->getAsFunction()->hasBody())
-					{
-						(void)p.parse(named_decl);
-					}
-				}
+		}
+
+		if (error) {
+			llvm::errs() << "unable to read directory '" << path << "': " << error.message() << '\n';
+			return false;
+		}
+
+		return true;
+	}
+
+	/// Verifies many files in one process, so that clang only needs to be set up once.
+	auto verify_batch(std::span<char* const> const paths) -> int
+	{
+		auto tests = std::vector<std::string>();
+		for (auto const path : paths) {
+			if (not collect_tests(path, tests)) {
+				return 1;
 			}
 		}
+
+		std::ranges::sort(tests);
+		auto const compilations = tooling::FixedCompilationDatabase(".", compiler_args);
+		auto tool = tooling::ClangTool(compilations, tests);
+		auto action = verify_action();
+		return tool.run(&action);
+	}
+} // namespace
+
+/// A simple program to check diagnostics while there isn't a proper schreiber binary.
+int main(int argc, char* argv[])
+{
+	using namespace std::string_view_literals;
+
+	constexpr auto usage =
+	  "usage: ./verify-diagnostics /path/to/file.cpp\n"
+	  "       ./verify-diagnostics --batch (/path/to/file.cpp | /path/to/tests/)...\n"sv;
+	if (argc >= 2 and argv[1] == "--batch"sv) {
+		if (argc == 2) {
+			llvm::errs() << "error: '--batch' needs at least one file or directory\n" << usage;
+			return 1;
+		}
+
+		return verify_batch(std::span(argv + 2, argv + argc));
+	}
+
+	if (argc != 2) {
+		llvm::errs() << usage;
+		return 1;
 	}
-	diags.getClient()->EndSourceFile();
+
+	return verify_file(argv[1]);
 }